@@ -1,4 +1,6 @@
 #include "autograd.hpp"
+#include "sparse_embedding.hpp"
+#include <map>
 #include <vector>
 #include <cmath>
 
@@ -11,6 +13,15 @@ struct Adam {
     std::vector<matrix> v; // second moment
     int t; // timestep
 
+    // Per-table state for sparse embeddings, which keep their own step count
+    struct LazyMoments {
+        matrix m;
+        matrix v;
+        std::vector<int> last;  // step at which each row was last updated, 0 = never
+        int t = 0;
+    };
+    std::map<const SparseEmbedding*, LazyMoments> sparse;
+
     Adam(float learning_rate = 0.001f, float b1 = 0.9f, float b2 = 0.999f, float eps = 1e-8f)
         : lr(learning_rate), beta1(b1), beta2(b2), epsilon(eps), t(0) {}
 
@@ -60,4 +71,43 @@ struct Adam {
             p->grad.fill_zeroes();
         }
     }
+
+    // Lazy Adam: only rows touched since the last step are updated. A row
+    // last updated at step s has seen t - s - 1 zero gradients since, which
+    // dense Adam would have applied as plain decay, so its moments catch up
+    // with beta^(t - s) before the new gradient goes in. The parameter drift
+    // dense Adam would have applied on those skipped steps is not replayed.
+    void step(SparseEmbedding& table) {
+        LazyMoments& state = sparse[&table];
+        // State is keyed by address, so a table allocated where a destroyed
+        // one lived may find its entry; start over unless the shape matches
+        if (state.last.size() != static_cast<std::size_t>(table.vocab()) || state.m[0].size() != table.dim()) {
+            state = LazyMoments();
+            state.m = matrix(table.vocab(), table.dim());
+            state.v = matrix(table.vocab(), table.dim());
+            state.last.assign(table.vocab(), 0);
+        }
+        state.t += 1;
+
+        const float correction1 = 1 - std::pow(beta1, state.t);
+        const float correction2 = 1 - std::pow(beta2, state.t);
+        const int cols = table.dim();
+        for (std::size_t k = 0; k < table.grad.touched(); k++) {
+            const int r = table.grad.row_at(k);
+            const float* g = table.grad.values_at(k);
+            const int gap = state.t - state.last[r];
+            const float decay1 = gap == 1 ? beta1 : std::pow(beta1, gap);
+            const float decay2 = gap == 1 ? beta2 : std::pow(beta2, gap);
+            float* m_row = &state.m[r][0];
+            float* v_row = &state.v[r][0];
+            float* w = &table.weight[r][0];
+            for (int c = 0; c < cols; c++) {
+                m_row[c] = decay1 * m_row[c] + (1 - beta1) * g[c];
+                v_row[c] = decay2 * v_row[c] + (1 - beta2) * g[c] * g[c];
+                w[c] -= lr * (m_row[c] / correction1) / (std::sqrt(v_row[c] / correction2) + epsilon);
+            }
+            state.last[r] = state.t;
+        }
+        table.grad.clear();
+    }
 };
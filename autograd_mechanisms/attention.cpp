@@ -0,0 +1,154 @@
+#include "attention.hpp"
+#include "../math_primitives/activations.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Rows r0..r0+rows of one head's columns col..col+dh, times scale, as a
+// contiguous rows x dh block
+void pack(const matrix& m, int r0, int rows, int col, int dh, float scale, float* out) {
+    for (int r = 0; r < rows; r++) {
+        const float* src = &m[r0 + r][col];
+        for (int j = 0; j < dh; j++) out[r * dh + j] = src[j] * scale;
+    }
+}
+
+void require_shape(const Node* node, int rows, int cols, const char* what) {
+    if (node->value.size() != rows || node->value[0].size() != cols)
+        throw std::invalid_argument(std::string("causal_attention ") + what + " is " + shape_of(node->value) +
+                                    ", expected " + std::to_string(rows) + "x" + std::to_string(cols));
+}
+
+} // namespace
+
+// ---------------- CAUSAL ATTENTION ----------------
+Node* causal_attention(Node* q, Node* k, Node* v, int heads) {
+    const int seq = q->value.size();
+    const int d = seq ? q->value[0].size() : 0;
+    if (seq == 0 || d == 0) throw std::invalid_argument("causal_attention of an empty matrix");
+    if (heads <= 0 || d % heads != 0)
+        throw std::invalid_argument("Width " + std::to_string(d) + " does not split into " + std::to_string(heads) +
+                                    " heads");
+    require_shape(k, seq, d, "keys");
+    require_shape(v, seq, d, "values");
+
+    const int dh = d / heads;
+    const float scale = 1.0f / std::sqrt(static_cast<float>(dh));
+    constexpr int T = ATTENTION_TILE;
+
+    Node* z = new Node(matrix(seq, d));
+    z->children.push(q);
+    z->children.push(k);
+    z->children.push(v);
+
+    // log(sum_j exp(s_ij)) per query row and head: with it the backward gets
+    // any probability as exp(s_ij - lse_i) without another pass over the row
+    auto lse = std::make_shared<std::vector<float>>(static_cast<std::size_t>(seq) * heads);
+
+    std::vector<float> qt(T * dh), kt(T * dh), vt(T * dh), acc(T * dh), p(T), row_max(T), row_sum(T);
+    for (int h = 0; h < heads; h++) {
+        const int col = h * dh;
+        for (int i0 = 0; i0 < seq; i0 += T) {
+            const int rows = std::min(T, seq - i0);
+            pack(q->value, i0, rows, col, dh, scale, qt.data());
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            std::fill(row_max.begin(), row_max.end(), -std::numeric_limits<float>::infinity());
+            std::fill(row_sum.begin(), row_sum.end(), 0.0f);
+
+            // Key blocks starting past the block's last query are fully masked
+            for (int j0 = 0; j0 < i0 + rows; j0 += T) {
+                const int cols = std::min(T, seq - j0);
+                pack(k->value, j0, cols, col, dh, 1.0f, kt.data());
+                pack(v->value, j0, cols, col, dh, 1.0f, vt.data());
+                for (int r = 0; r < rows; r++) {
+                    // Blocks are square and aligned, so j0 <= i0 and every
+                    // row sees at least one key here
+                    const int valid = std::min(cols, i0 + r - j0 + 1);
+                    const float* qr = &qt[r * dh];
+                    float mx = row_max[r];
+                    for (int c = 0; c < valid; c++) {
+                        p[c] = dot(qr, &kt[c * dh], dh);
+                        mx = std::max(mx, p[c]);
+                    }
+                    // Rescale what was accumulated under the old max
+                    const float alpha = std::exp(row_max[r] - mx);
+                    float sum = 0.0f;
+                    for (int c = 0; c < valid; c++) {
+                        p[c] = std::exp(p[c] - mx);
+                        sum += p[c];
+                    }
+                    float* out = &acc[r * dh];
+                    if (alpha != 1.0f)
+                        for (int j = 0; j < dh; j++) out[j] *= alpha;
+                    for (int c = 0; c < valid; c++) axpy(p[c], &vt[c * dh], out, dh);
+                    row_sum[r] = row_sum[r] * alpha + sum;
+                    row_max[r] = mx;
+                }
+            }
+
+            for (int r = 0; r < rows; r++) {
+                const float inv = 1.0f / row_sum[r];
+                float* out = &z->value[i0 + r][col];
+                for (int j = 0; j < dh; j++) out[j] = acc[r * dh + j] * inv;
+                (*lse)[static_cast<std::size_t>(i0 + r) * heads + h] = row_max[r] + std::log(row_sum[r]);
+            }
+        }
+    }
+
+    // With P = exp(S - lse) recomputed per block and delta_i = dO_i . O_i:
+    //   dV_j += P_ij dO_i
+    //   dS_ij = P_ij (dO_i . V_j - delta_i)
+    //   dQ_i += scale dS_ij K_j,  dK_j += scale dS_ij Q_i
+    // Key blocks are the outer loop so dK and dV accumulate in the tile and
+    // are written once; dQ goes straight into q's gradient rows.
+    z->backward = [=]() {
+        std::vector<float> qt(T * dh), kt(T * dh), vt(T * dh), dout(T * dh), dkt(T * dh), dvt(T * dh);
+        std::vector<float> delta(seq);
+        for (int h = 0; h < heads; h++) {
+            const int col = h * dh;
+            for (int i = 0; i < seq; i++) delta[i] = dot(&z->grad[i][col], &z->value[i][col], dh);
+
+            for (int j0 = 0; j0 < seq; j0 += T) {
+                const int cols = std::min(T, seq - j0);
+                pack(k->value, j0, cols, col, dh, 1.0f, kt.data());
+                pack(v->value, j0, cols, col, dh, 1.0f, vt.data());
+                std::fill(dkt.begin(), dkt.end(), 0.0f);
+                std::fill(dvt.begin(), dvt.end(), 0.0f);
+
+                // Query blocks before j0 only attend to earlier keys
+                for (int i0 = j0; i0 < seq; i0 += T) {
+                    const int rows = std::min(T, seq - i0);
+                    pack(q->value, i0, rows, col, dh, scale, qt.data());
+                    pack(z->grad, i0, rows, col, dh, 1.0f, dout.data());
+                    for (int r = 0; r < rows; r++) {
+                        const int valid = std::min(cols, i0 + r - j0 + 1);
+                        const float* qr = &qt[r * dh];
+                        const float* dor = &dout[r * dh];
+                        const float l = (*lse)[static_cast<std::size_t>(i0 + r) * heads + h];
+                        float* dq = &q->grad[i0 + r][col];
+                        for (int c = 0; c < valid; c++) {
+                            const float pc = std::exp(dot(qr, &kt[c * dh], dh) - l);
+                            axpy(pc, dor, &dvt[c * dh], dh);
+                            const float ds = pc * (dot(dor, &vt[c * dh], dh) - delta[i0 + r]);
+                            axpy(ds * scale, &kt[c * dh], dq, dh);
+                            axpy(ds, qr, &dkt[c * dh], dh);
+                        }
+                    }
+                }
+
+                for (int c = 0; c < cols; c++) {
+                    axpy(1.0f, &dkt[c * dh], &k->grad[j0 + c][col], dh);
+                    axpy(1.0f, &dvt[c * dh], &v->grad[j0 + c][col], dh);
+                }
+            }
+        }
+    };
+    return z;
+}
@@ -0,0 +1,23 @@
+#ifndef ATTENTION_HPP
+#define ATTENTION_HPP
+
+#include "autograd.hpp"
+
+// ---------------- CAUSAL ATTENTION ----------------
+// Multi-head causal self-attention softmax(Q K^T / sqrt(dh) + mask) V as one
+// node. q, k and v are seq x d with d = heads * dh; head h owns columns
+// h*dh .. (h+1)*dh and the output concatenates the heads the same way.
+//
+// Queries and keys are processed in ATTENTION_TILE x ATTENTION_TILE blocks
+// with an online softmax: each query row keeps a running max and sum, and
+// its output accumulator is rescaled when the max grows. Blocks entirely
+// above the diagonal are skipped. No seq x seq matrix is ever allocated;
+// the forward keeps only the per-row log-sum-exp (seq x heads floats), and
+// the backward recomputes each block of scores from it.
+Node* causal_attention(Node* q, Node* k, Node* v, int heads);
+
+// Query and key block edge; a tile of Q, K, V and the scores for dh = 64
+// is about 64 KB, which stays in L2
+constexpr int ATTENTION_TILE = 64;
+
+#endif // ATTENTION_HPP
@@ -0,0 +1,141 @@
+#include "attention.hpp"
+#include "../math_primitives/gemm.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+// Tiled causal_attention against attention with the score matrix
+// materialised: per head S = Q K^T / sqrt(dh) (seq x seq) by GEMM, masked
+// and softmaxed in place and kept for the backward, which runs four more
+// GEMMs over it. Reports forward+backward time, the score memory the
+// materialised version holds, and the largest output and gradient
+// differences between the two.
+//
+// usage: attention_bench [seq] [width] [heads] [repeats]
+
+namespace {
+
+// Row pointers into one head's columns
+std::vector<float*> head_rows(matrix& m, int col) {
+    std::vector<float*> rows(m.size());
+    for (int i = 0; i < m.size(); i++) rows[i] = &m[i][col];
+    return rows;
+}
+
+std::vector<float*> rows_of(std::vector<float>& block, int rows, int cols) {
+    std::vector<float*> out(rows);
+    for (int i = 0; i < rows; i++) out[i] = block.data() + static_cast<std::size_t>(i) * cols;
+    return out;
+}
+
+struct Materialised {
+    matrix out, dq, dk, dv;
+    std::size_t score_bytes = 0;
+};
+
+Materialised materialised_attention(matrix& q, matrix& k, matrix& v, matrix& dout, int heads) {
+    const int seq = q.size(), d = q[0].size(), dh = d / heads;
+    const float scale = 1.0f / std::sqrt(static_cast<float>(dh));
+    Materialised r{matrix(seq, d), matrix(seq, d), matrix(seq, d), matrix(seq, d)};
+
+    // One seq x seq probability matrix per head, as a graph would keep them
+    std::vector<std::vector<float>> probs(heads, std::vector<float>(static_cast<std::size_t>(seq) * seq));
+    r.score_bytes = static_cast<std::size_t>(heads) * seq * seq * sizeof(float);
+
+    for (int h = 0; h < heads; h++) {
+        const int col = h * dh;
+        auto qh = head_rows(q, col), kh = head_rows(k, col), vh = head_rows(v, col), oh = head_rows(r.out, col);
+        auto s = rows_of(probs[h], seq, seq);
+        gemm(seq, seq, dh, qh.data(), false, kh.data(), true, s.data());
+        for (int i = 0; i < seq; i++) {
+            float mx = -std::numeric_limits<float>::infinity(), sum = 0.0f;
+            for (int j = 0; j <= i; j++) mx = std::max(mx, s[i][j] *= scale);
+            for (int j = 0; j <= i; j++) sum += s[i][j] = std::exp(s[i][j] - mx);
+            for (int j = 0; j <= i; j++) s[i][j] /= sum;
+            std::fill(s[i] + i + 1, s[i] + seq, 0.0f);
+        }
+        gemm(seq, dh, seq, s.data(), false, vh.data(), false, oh.data());
+    }
+
+    std::vector<float> dp_block(static_cast<std::size_t>(seq) * seq);
+    auto dp = rows_of(dp_block, seq, seq);
+    for (int h = 0; h < heads; h++) {
+        const int col = h * dh;
+        auto qh = head_rows(q, col), kh = head_rows(k, col), vh = head_rows(v, col), doh = head_rows(dout, col);
+        auto dqh = head_rows(r.dq, col), dkh = head_rows(r.dk, col), dvh = head_rows(r.dv, col);
+        auto p = rows_of(probs[h], seq, seq);
+        gemm(seq, dh, seq, p.data(), true, doh.data(), false, dvh.data());
+        gemm(seq, seq, dh, doh.data(), false, vh.data(), true, dp.data());
+        for (int i = 0; i < seq; i++) {
+            float pdp = 0.0f;
+            for (int j = 0; j <= i; j++) pdp += p[i][j] * dp[i][j];
+            for (int j = 0; j < seq; j++) dp[i][j] = j <= i ? p[i][j] * (dp[i][j] - pdp) * scale : 0.0f;
+        }
+        gemm(seq, dh, seq, dp.data(), false, kh.data(), false, dqh.data());
+        gemm(seq, dh, seq, dp.data(), true, qh.data(), false, dkh.data());
+    }
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int seq = argc > 1 ? std::stoi(argv[1]) : 1024;
+    int d = argc > 2 ? std::stoi(argv[2]) : 256;
+    int heads = argc > 3 ? std::stoi(argv[3]) : 4;
+    int repeats = argc > 4 ? std::stoi(argv[4]) : 3;
+
+    try {
+        Philox gen(41);
+        Node* q = new Node(matrix(seq, d));
+        Node* k = new Node(matrix(seq, d));
+        Node* v = new Node(matrix(seq, d));
+        q->value.fill_uniform(gen, -1.0f, 1.0f);
+        k->value.fill_uniform(gen.split(1), -1.0f, 1.0f);
+        v->value.fill_uniform(gen.split(2), -1.0f, 1.0f);
+        matrix up(seq, d);
+        up.fill_uniform(gen.split(3), -1.0f, 1.0f);
+
+        double tiled_ms = 0.0, full_ms = 0.0;
+        Materialised ref;
+        matrix out;
+        for (int r = 0; r < repeats; r++) {
+            for (Node* n : {q, k, v}) n->grad.fill_zeroes();
+            auto start = Clock::now();
+            Node* z = causal_attention(q, k, v, heads);
+            z->grad = up;
+            z->backward();
+            tiled_ms += elapsed_ms(start);
+            out = z->value;
+            delete z;
+
+            start = Clock::now();
+            ref = materialised_attention(q->value, k->value, v->value, up, heads);
+            full_ms += elapsed_ms(start);
+        }
+
+        float diff = max_diff(out, ref.out);
+        diff = std::max(diff, max_diff(q->grad, ref.dq));
+        diff = std::max(diff, max_diff(k->grad, ref.dk));
+        diff = std::max(diff, max_diff(v->grad, ref.dv));
+
+        const std::size_t tiled_bytes = static_cast<std::size_t>(seq) * heads * sizeof(float);
+        std::cout << "causal attention seq " << seq << ", width " << d << ", " << heads
+                  << " heads, forward+backward: tiled " << tiled_ms / repeats << " ms, materialised "
+                  << full_ms / repeats << " ms, speedup " << full_ms / tiled_ms << "x" << std::endl;
+        std::cout << "saved for backward: tiled " << tiled_bytes / 1024.0 << " KB (log-sum-exp), materialised "
+                  << ref.score_bytes / (1024.0 * 1024.0) << " MB (probabilities), max abs difference " << diff
+                  << std::endl;
+        delete q;
+        delete k;
+        delete v;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <cmath>
 #include <set>
+#include <vector>
 
 // ---------------- NODE ----------------
 struct Node {
@@ -51,6 +52,20 @@ void print_graph(Node* node, std::string prefix = "", std::set<Node*>* visited =
         print_graph(node->children[i], prefix + "  ", visited);
 }
 
+// ---------------- GRAPH FREE ----------------
+void free_nodes(Node* root, const std::vector<Node*>& keep) {
+    std::set<Node*> seen(keep.begin(), keep.end());
+    std::vector<Node*> stack = {root}, doomed;
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+        if (!seen.insert(node).second) continue;
+        doomed.push_back(node);
+        for (int i = 0; i < node->children.size(); i++) stack.push_back(node->children[i]);
+    }
+    for (Node* node : doomed) delete node;
+}
+
 // ---------------- OPERATIONS ----------------
 Node* add(Node* x, Node* y) {
     Node* z = new Node(x->value + y->value);
@@ -4,7 +4,8 @@
 #include <set>
 #include <functional>
 #include <string>
-#include "../phase_1/vector.hpp"
+#include <vector>
+#include "../math_primitives/vector.hpp"
 
 // ---------------- NODE ----------------
 struct Node {
@@ -35,4 +36,9 @@ Node* cross_entropy(Node* predictions, Node* targets);
 // ---------------- GRAPH PRINTER ----------------
 void print_graph(Node* node, std::string prefix="", std::set<Node*>* visited = nullptr);
 
+// ---------------- GRAPH FREE ----------------
+// Deletes every node reachable from root once, except those in keep (the
+// leaves the caller owns)
+void free_nodes(Node* root, const std::vector<Node*>& keep = {});
+
 #endif
@@ -0,0 +1,67 @@
+#include "bmm.hpp"
+#include "../utils/helpers.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename T, typename M>
+std::vector<T*> row_pointers(M& m) {
+    std::vector<T*> rows(m.size());
+    for (int i = 0; i < m.size(); i++) rows[i] = m[i].size() ? &m[i][0] : nullptr;
+    return rows;
+}
+
+} // namespace
+
+Node* bmm(Node* a, Node* b, int batch, bool trans_a, bool trans_b) {
+    const int a_rows = a->value.size(), a_cols = a_rows ? a->value[0].size() : 0;
+    const int b_rows = b->value.size(), b_cols = b_rows ? b->value[0].size() : 0;
+    if (batch <= 0 || a_rows % batch != 0 || b_rows % batch != 0)
+        throw std::invalid_argument("bmm: " + shape_of(a->value) + " and " + shape_of(b->value) +
+                                    " do not split into " + std::to_string(batch) + " blocks");
+    const int a_height = a_rows / batch, b_height = b_rows / batch;
+    const int m = trans_a ? a_cols : a_height;
+    const int k = trans_a ? a_height : a_cols;
+    const int n = trans_b ? b_height : b_cols;
+    if ((trans_b ? b_cols : b_height) != k)
+        throw std::invalid_argument("bmm: blocks of " + shape_of(a->value) + (trans_a ? "^T" : "") + " and " +
+                                    shape_of(b->value) + (trans_b ? "^T" : "") + " have mismatched inner dimensions");
+
+    Node* z = new Node(matrix(batch * m, n));
+    z->children.push(a);
+    z->children.push(b);
+
+    std::vector<const float*> av = row_pointers<const float>(a->value);
+    std::vector<const float*> bv = row_pointers<const float>(b->value);
+    std::vector<float*> zv = row_pointers<float>(z->value);
+    gemm_batched(batch, m, n, k, av.data(), a_height, trans_a, bv.data(), b_height, trans_b, zv.data(), m);
+
+    z->backward = [=]() {
+        std::vector<const float*> av = row_pointers<const float>(a->value);
+        std::vector<const float*> bv = row_pointers<const float>(b->value);
+        std::vector<const float*> dz = row_pointers<const float>(z->grad);
+        std::vector<float*> da = row_pointers<float>(a->grad);
+        std::vector<float*> db = row_pointers<float>(b->grad);
+        GemmEpilogue accumulate;
+        accumulate.accumulate = true;
+
+        // d op(a_i) = dz_i * op(b_i)^T; a transposed block takes its transpose
+        if (!trans_a)
+            gemm_batched(batch, m, k, n, dz.data(), m, false, bv.data(), b_height, !trans_b, da.data(), a_height,
+                         accumulate);
+        else
+            gemm_batched(batch, k, m, n, bv.data(), b_height, trans_b, dz.data(), m, true, da.data(), a_height,
+                         accumulate);
+
+        // d op(b_i) = op(a_i)^T * dz_i, likewise
+        if (!trans_b)
+            gemm_batched(batch, k, n, m, av.data(), a_height, !trans_a, dz.data(), m, false, db.data(), b_height,
+                         accumulate);
+        else
+            gemm_batched(batch, n, k, m, dz.data(), m, true, av.data(), a_height, trans_a, db.data(), b_height,
+                         accumulate);
+    };
+    return z;
+}
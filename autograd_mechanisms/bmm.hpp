@@ -0,0 +1,16 @@
+#ifndef BMM_HPP
+#define BMM_HPP
+
+#include "autograd.hpp"
+#include "../math_primitives/gemm.hpp"
+
+// ---------------- BMM ----------------
+// batch independent products as one node. a and b each hold batch
+// equal-height blocks stacked along the rows, and block i of the output is
+// op(a_i) * op(b_i), where op transposes the block when its flag is set (a
+// block of a is then k x m rather than m x k, and likewise for b). Forward
+// is one batched GEMM over row pointers into the blocks, and backward is two
+// accumulating ones, so there is no per-block transpose copy or allocation.
+Node* bmm(Node* a, Node* b, int batch, bool trans_a = false, bool trans_b = false);
+
+#endif // BMM_HPP
@@ -0,0 +1,111 @@
+#include "bmm.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Attention-score shaped batches, Q_i K_i^T for every (sample, head) pair,
+// computed three ways:
+//   per-block  matrix::operator* on each block with a transpose copy
+//   gemm loop  one gemm() call per block
+//   batched    one gemm_batched() call over the whole stack
+// all into preallocated outputs, then a bmm node's output and backward
+// gradients checked against per-block operator*.
+//
+// usage: bmm_bench [batch] [seq] [head dim] [repeats]
+
+namespace {
+
+matrix block(const matrix& m, int i, int height) {
+    matrix out;
+    for (int r = 0; r < height; r++) out.push(m[i * height + r]);
+    return out;
+}
+
+float max_diff_block(const matrix& stacked, int i, const matrix& ref) {
+    float diff = 0.0f;
+    for (int r = 0; r < ref.size(); r++)
+        for (int c = 0; c < ref[r].size(); c++)
+            diff = std::max(diff, std::fabs(stacked[i * ref.size() + r][c] - ref[r][c]));
+    return diff;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int batch = argc > 1 ? std::stoi(argv[1]) : 64;
+    int seq = argc > 2 ? std::stoi(argv[2]) : 64;
+    int dh = argc > 3 ? std::stoi(argv[3]) : 32;
+    int repeats = argc > 4 ? std::stoi(argv[4]) : 20;
+
+    try {
+        Philox gen(51);
+        Node* q = new Node(matrix(batch * seq, dh));
+        Node* k = new Node(matrix(batch * seq, dh));
+        q->value.fill_uniform(gen, -1.0f, 1.0f);
+        k->value.fill_uniform(gen.split(1), -1.0f, 1.0f);
+        std::vector<matrix> qs, ks;
+        for (int i = 0; i < batch; i++) {
+            qs.push_back(block(q->value, i, seq));
+            ks.push_back(block(k->value, i, seq));
+        }
+
+        std::vector<matrix> per_block(batch);
+        auto start = Clock::now();
+        for (int r = 0; r < repeats; r++)
+            for (int i = 0; i < batch; i++) per_block[i] = qs[i] * ks[i].transpose();
+        const double per_block_ms = elapsed_ms(start) / repeats;
+
+        std::vector<matrix> looped(batch, matrix(seq, seq));
+        start = Clock::now();
+        for (int r = 0; r < repeats; r++)
+            for (int i = 0; i < batch; i++) gemm(qs[i], false, ks[i], true, looped[i]);
+        const double loop_ms = elapsed_ms(start) / repeats;
+
+        matrix stacked(batch * seq, seq);
+        std::vector<const float*> qv(batch * seq), kv(batch * seq);
+        std::vector<float*> sv(batch * seq);
+        for (int r = 0; r < batch * seq; r++) {
+            qv[r] = &q->value[r][0];
+            kv[r] = &k->value[r][0];
+            sv[r] = &stacked[r][0];
+        }
+        start = Clock::now();
+        for (int r = 0; r < repeats; r++)
+            gemm_batched(batch, seq, seq, dh, qv.data(), seq, false, kv.data(), seq, true, sv.data(), seq);
+        const double batched_ms = elapsed_ms(start) / repeats;
+
+        Node* z = bmm(q, k, batch, false, true);
+
+        float diff = 0.0f;
+        for (int i = 0; i < batch; i++) {
+            diff = std::max(diff, max_diff_block(z->value, i, per_block[i]));
+            diff = std::max(diff, max_diff_block(z->value, i, looped[i]));
+            diff = std::max(diff, max_diff_block(stacked, i, looped[i]));
+        }
+
+        // dQ_i = dZ_i K_i, dK_i = dZ_i^T Q_i
+        z->grad.fill_uniform(gen.split(2), -1.0f, 1.0f);
+        z->backward();
+        float grad_diff = 0.0f;
+        for (int i = 0; i < batch; i++) {
+            matrix dz = block(z->grad, i, seq);
+            grad_diff = std::max(grad_diff, max_diff_block(q->grad, i, dz * ks[i]));
+            grad_diff = std::max(grad_diff, max_diff_block(k->grad, i, dz.transpose() * qs[i]));
+        }
+
+        std::cout << batch << " x (" << seq << "x" << dh << " * " << dh << "x" << seq << "): per-block operator* "
+                  << per_block_ms << " ms, gemm loop " << loop_ms << " ms, batched " << batched_ms << " ms ("
+                  << per_block_ms / batched_ms << "x, " << loop_ms / batched_ms << "x), max abs difference " << diff
+                  << ", gradient difference " << grad_diff << std::endl;
+        delete z;
+        delete q;
+        delete k;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,476 @@
+#include "fusion.hpp"
+#include "../math_primitives/gemm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+// Columns per strip: registers of a fused kernel live in a scratch of
+// registers x STRIP floats, small enough to stay in L1
+constexpr int STRIP = 256;
+
+std::string shape_of(int rows, int cols) { return std::to_string(rows) + "x" + std::to_string(cols); }
+
+// ---------------- COMPILED ELEMENTWISE KERNEL ----------------
+// Registers 0 .. operands.size() - 1 hold values read from outside the
+// kernel; code[k] writes register operands.size() + k
+struct Instr {
+    OpKind kind;
+    int a;
+    int b;
+    float scalar;
+};
+
+struct Program {
+    std::vector<int> operands;
+    std::vector<Instr> code;
+    int rows = 0;
+    int cols = 0;
+
+    int registers() const { return static_cast<int>(operands.size() + code.size()); }
+};
+
+Program compile(const Trace& trace, const Kernel& kernel) {
+    Program prog;
+    prog.rows = trace.op(kernel.output()).rows;
+    prog.cols = trace.op(kernel.output()).cols;
+    std::set<int> inside(kernel.ops.begin(), kernel.ops.end());
+    std::map<int, int> reg;
+    for (int id : kernel.ops) {
+        for (int operand : {trace.op(id).a, trace.op(id).b}) {
+            if (operand < 0 || inside.count(operand) || reg.count(operand)) continue;
+            reg[operand] = static_cast<int>(prog.operands.size());
+            prog.operands.push_back(operand);
+        }
+    }
+    for (int id : kernel.ops) {
+        const TraceOp& op = trace.op(id);
+        reg[id] = static_cast<int>(prog.operands.size() + prog.code.size());
+        prog.code.push_back({op.kind, op.a >= 0 ? reg.at(op.a) : -1, op.b >= 0 ? reg.at(op.b) : -1, op.scalar});
+    }
+    return prog;
+}
+
+// Points every operand register at row i, columns j0 .. j0 + len; per-row
+// (rows x 1) operands are broadcast into their scratch slot
+void load_operands(const Program& prog, const std::vector<Node*>& nodes, int i, int j0, int len,
+                   float* scratch, std::vector<const float*>& ptr) {
+    for (std::size_t r = 0; r < prog.operands.size(); r++) {
+        const matrix& m = nodes[r]->value;
+        const int row = m.size() == 1 ? 0 : i;
+        if (m[0].size() == 1) {
+            float* slot = scratch + r * STRIP;
+            std::fill(slot, slot + len, m[row][0]);
+            ptr[r] = slot;
+        } else {
+            ptr[r] = &m[row][j0];
+        }
+    }
+}
+
+// Runs the code over one strip; the last op writes to out when given
+void run_strip(const Program& prog, int len, float* scratch, std::vector<const float*>& ptr, float* out) {
+    const int base = static_cast<int>(prog.operands.size());
+    for (std::size_t k = 0; k < prog.code.size(); k++) {
+        const Instr& in = prog.code[k];
+        const int self = base + static_cast<int>(k);
+        float* dst = (out && k + 1 == prog.code.size()) ? out : scratch + static_cast<std::size_t>(self) * STRIP;
+        const float* x = ptr[in.a];
+        const float* y = in.b >= 0 ? ptr[in.b] : nullptr;
+        const float s = in.scalar;
+        switch (in.kind) {
+        case OpKind::Add: for (int t = 0; t < len; t++) dst[t] = x[t] + y[t]; break;
+        case OpKind::Sub: for (int t = 0; t < len; t++) dst[t] = x[t] - y[t]; break;
+        case OpKind::Mul: for (int t = 0; t < len; t++) dst[t] = x[t] * y[t]; break;
+        case OpKind::Neg: for (int t = 0; t < len; t++) dst[t] = -x[t]; break;
+        case OpKind::Scale: for (int t = 0; t < len; t++) dst[t] = x[t] * s; break;
+        case OpKind::AddScalar: for (int t = 0; t < len; t++) dst[t] = x[t] + s; break;
+        case OpKind::Square: for (int t = 0; t < len; t++) dst[t] = x[t] * x[t]; break;
+        case OpKind::Rsqrt: for (int t = 0; t < len; t++) dst[t] = 1.0f / std::sqrt(x[t]); break;
+        case OpKind::Relu: for (int t = 0; t < len; t++) dst[t] = x[t] > 0.0f ? x[t] : 0.0f; break;
+        case OpKind::Gelu: gelu(x, dst, len); break;
+        default: throw std::logic_error("Non-elementwise op in a fused kernel");
+        }
+        ptr[self] = dst;
+    }
+}
+
+// Reverse sweep over one recomputed strip; adj[out register] holds the
+// output gradient on entry
+void adjoint_strip(const Program& prog, int len, const std::vector<const float*>& ptr, float* adj) {
+    const int base = static_cast<int>(prog.operands.size());
+    for (std::size_t k = prog.code.size(); k-- > 0; ) {
+        const Instr& in = prog.code[k];
+        const int self = base + static_cast<int>(k);
+        const float* g = adj + static_cast<std::size_t>(self) * STRIP;
+        float* da = adj + static_cast<std::size_t>(in.a) * STRIP;
+        float* db = in.b >= 0 ? adj + static_cast<std::size_t>(in.b) * STRIP : nullptr;
+        const float* x = ptr[in.a];
+        const float* y = in.b >= 0 ? ptr[in.b] : nullptr;
+        const float* v = ptr[self];
+        switch (in.kind) {
+        case OpKind::Add:
+            for (int t = 0; t < len; t++) { da[t] += g[t]; db[t] += g[t]; }
+            break;
+        case OpKind::Sub:
+            for (int t = 0; t < len; t++) { da[t] += g[t]; db[t] -= g[t]; }
+            break;
+        case OpKind::Mul:
+            // Sequential so that x * x (a == b) collects both terms
+            for (int t = 0; t < len; t++) da[t] += g[t] * y[t];
+            for (int t = 0; t < len; t++) db[t] += g[t] * x[t];
+            break;
+        case OpKind::Neg: for (int t = 0; t < len; t++) da[t] -= g[t]; break;
+        case OpKind::Scale: for (int t = 0; t < len; t++) da[t] += g[t] * in.scalar; break;
+        case OpKind::AddScalar: for (int t = 0; t < len; t++) da[t] += g[t]; break;
+        case OpKind::Square: for (int t = 0; t < len; t++) da[t] += 2.0f * x[t] * g[t]; break;
+        case OpKind::Rsqrt: for (int t = 0; t < len; t++) da[t] -= 0.5f * v[t] * v[t] * v[t] * g[t]; break;
+        case OpKind::Relu: for (int t = 0; t < len; t++) da[t] += x[t] > 0.0f ? g[t] : 0.0f; break;
+        case OpKind::Gelu: gelu_backward(x, g, da, len); break;
+        default: throw std::logic_error("Non-elementwise op in a fused kernel");
+        }
+    }
+}
+
+Node* run_elementwise(const Trace& trace, const Kernel& kernel, const std::vector<Node*>& node_of) {
+    auto prog = std::make_shared<Program>(compile(trace, kernel));
+    std::vector<Node*> operands;
+    for (int id : prog->operands) operands.push_back(node_of[id]);
+
+    Node* z = new Node(matrix(prog->rows, prog->cols));
+    for (Node* operand : operands)
+        if (!z->children.search(operand)) z->children.push(operand);
+
+    std::vector<float> scratch(static_cast<std::size_t>(prog->registers()) * STRIP);
+    std::vector<const float*> ptr(prog->registers());
+    for (int i = 0; i < prog->rows; i++) {
+        for (int j0 = 0; j0 < prog->cols; j0 += STRIP) {
+            const int len = std::min(STRIP, prog->cols - j0);
+            load_operands(*prog, operands, i, j0, len, scratch.data(), ptr);
+            run_strip(*prog, len, scratch.data(), ptr, &z->value[i][j0]);
+        }
+    }
+
+    z->backward = [=]() {
+        const int regs = prog->registers();
+        const int out = regs - 1;
+        std::vector<float> values(static_cast<std::size_t>(regs) * STRIP);
+        std::vector<float> adj(static_cast<std::size_t>(regs) * STRIP);
+        std::vector<const float*> p(regs);
+        for (int i = 0; i < prog->rows; i++) {
+            for (int j0 = 0; j0 < prog->cols; j0 += STRIP) {
+                const int len = std::min(STRIP, prog->cols - j0);
+                load_operands(*prog, operands, i, j0, len, values.data(), p);
+                run_strip(*prog, len, values.data(), p, nullptr);
+                std::fill(adj.begin(), adj.end(), 0.0f);
+                std::copy(&z->grad[i][j0], &z->grad[i][j0] + len, adj.data() + static_cast<std::size_t>(out) * STRIP);
+                adjoint_strip(*prog, len, p, adj.data());
+
+                // Broadcast operands sum their gradient over the broadcast axis
+                for (std::size_t r = 0; r < operands.size(); r++) {
+                    matrix& grad = operands[r]->grad;
+                    const float* g = adj.data() + r * STRIP;
+                    mathVector& row = grad[grad.size() == 1 ? 0 : i];
+                    if (row.size() == 1) {
+                        float sum = 0.0f;
+                        for (int t = 0; t < len; t++) sum += g[t];
+                        row[0] += sum;
+                    } else {
+                        float* dst = &row[j0];
+                        for (int t = 0; t < len; t++) dst[t] += g[t];
+                    }
+                }
+            }
+        }
+    };
+    return z;
+}
+
+// ---------------- OTHER KERNELS ----------------
+Node* run_matmul(const TraceOp& op, Node* a, Node* b) {
+    Node* z = new Node(matrix(op.rows, op.cols));
+    z->children.push(a);
+    z->children.push(b);
+    gemm(a->value, false, b->value, op.trans_b, z->value);
+    const bool trans_b = op.trans_b;
+    z->backward = [=]() {
+        GemmEpilogue acc;
+        acc.accumulate = true;
+        // z = a * op(b): da += dz * op(b)^T; db += a^T dz, or dz^T a when transposed
+        gemm(z->grad, false, b->value, !trans_b, a->grad, acc);
+        if (trans_b) gemm(z->grad, true, a->value, false, b->grad, acc);
+        else gemm(a->value, true, z->grad, false, b->grad, acc);
+    };
+    return z;
+}
+
+Node* run_softmax(const TraceOp& op, Node* a) {
+    Node* z = new Node(matrix(op.rows, op.cols));
+    z->children.push(a);
+    for (int i = 0; i < op.rows; i++) {
+        const float* x = &a->value[i][0];
+        float* y = &z->value[i][0];
+        const float max_val = *std::max_element(x, x + op.cols);
+        float sum = 0.0f;
+        for (int j = 0; j < op.cols; j++) sum += (y[j] = std::exp(x[j] - max_val));
+        for (int j = 0; j < op.cols; j++) y[j] /= sum;
+    }
+    z->backward = [=]() {
+        // dx = y * (g - <g, y>) per row
+        for (int i = 0; i < op.rows; i++) {
+            const float* y = &z->value[i][0];
+            const float* g = &z->grad[i][0];
+            float* dx = &a->grad[i][0];
+            float dot = 0.0f;
+            for (int j = 0; j < op.cols; j++) dot += g[j] * y[j];
+            for (int j = 0; j < op.cols; j++) dx[j] += y[j] * (g[j] - dot);
+        }
+    };
+    return z;
+}
+
+Node* run_row_mean(const TraceOp& op, Node* a) {
+    const int cols = a->value[0].size();
+    Node* z = new Node(matrix(op.rows, 1));
+    z->children.push(a);
+    for (int i = 0; i < op.rows; i++) {
+        const float* x = &a->value[i][0];
+        float sum = 0.0f;
+        for (int j = 0; j < cols; j++) sum += x[j];
+        z->value[i][0] = sum / cols;
+    }
+    z->backward = [=]() {
+        for (int i = 0; i < op.rows; i++) {
+            const float g = z->grad[i][0] / cols;
+            float* dx = &a->grad[i][0];
+            for (int j = 0; j < cols; j++) dx[j] += g;
+        }
+    };
+    return z;
+}
+
+} // namespace
+
+bool is_elementwise(OpKind kind) {
+    switch (kind) {
+    case OpKind::Add: case OpKind::Sub: case OpKind::Mul: case OpKind::Neg: case OpKind::Scale:
+    case OpKind::AddScalar: case OpKind::Square: case OpKind::Rsqrt: case OpKind::Relu: case OpKind::Gelu:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::string op_name(OpKind kind) {
+    switch (kind) {
+    case OpKind::Input: return "input";
+    case OpKind::Add: return "add";
+    case OpKind::Sub: return "sub";
+    case OpKind::Mul: return "mul";
+    case OpKind::Neg: return "neg";
+    case OpKind::Scale: return "scale";
+    case OpKind::AddScalar: return "add_scalar";
+    case OpKind::Square: return "square";
+    case OpKind::Rsqrt: return "rsqrt";
+    case OpKind::Relu: return "relu";
+    case OpKind::Gelu: return "gelu";
+    case OpKind::MatMul: return "matmul";
+    case OpKind::Softmax: return "softmax";
+    case OpKind::RowMean: return "row_mean";
+    }
+    return "?";
+}
+
+// ---------------- TRACE ----------------
+const TraceOp& Trace::op(int id) const {
+    if (id < 0 || id >= static_cast<int>(list.size())) throw std::out_of_range("No op " + std::to_string(id) + " in trace");
+    return list[id];
+}
+
+int Trace::push(TraceOp op) {
+    list.push_back(op);
+    return static_cast<int>(list.size()) - 1;
+}
+
+int Trace::input(int rows, int cols) {
+    if (rows <= 0 || cols <= 0) throw std::invalid_argument("Trace input must be non-empty, got " + shape_of(rows, cols));
+    TraceOp op{OpKind::Input};
+    op.rows = rows;
+    op.cols = cols;
+    input_count++;
+    return push(op);
+}
+
+int Trace::unary(OpKind kind, int a, float scalar) {
+    TraceOp op{kind};
+    op.a = a;
+    op.rows = this->op(a).rows;
+    op.cols = this->op(a).cols;
+    op.scalar = scalar;
+    return push(op);
+}
+
+int Trace::binary(OpKind kind, int a, int b) {
+    const TraceOp& x = op(a);
+    const TraceOp& y = op(b);
+    TraceOp out{kind};
+    out.a = a;
+    out.b = b;
+    out.rows = std::max(x.rows, y.rows);
+    out.cols = std::max(x.cols, y.cols);
+    for (const TraceOp* t : {&x, &y}) {
+        if ((t->rows != out.rows && t->rows != 1) || (t->cols != out.cols && t->cols != 1)) {
+            throw std::invalid_argument("Cannot broadcast " + shape_of(x.rows, x.cols) + " with " +
+                                        shape_of(y.rows, y.cols) + " in " + op_name(kind));
+        }
+    }
+    return push(out);
+}
+
+int Trace::add(int a, int b) { return binary(OpKind::Add, a, b); }
+int Trace::sub(int a, int b) { return binary(OpKind::Sub, a, b); }
+int Trace::mul(int a, int b) { return binary(OpKind::Mul, a, b); }
+int Trace::neg(int a) { return unary(OpKind::Neg, a); }
+int Trace::scale(int a, float s) { return unary(OpKind::Scale, a, s); }
+int Trace::add_scalar(int a, float s) { return unary(OpKind::AddScalar, a, s); }
+int Trace::square(int a) { return unary(OpKind::Square, a); }
+int Trace::rsqrt(int a) { return unary(OpKind::Rsqrt, a); }
+int Trace::relu(int a) { return unary(OpKind::Relu, a); }
+int Trace::gelu(int a) { return unary(OpKind::Gelu, a); }
+int Trace::softmax(int a) { return unary(OpKind::Softmax, a); }
+
+int Trace::row_mean(int a) {
+    int id = unary(OpKind::RowMean, a);
+    list[id].cols = 1;
+    return id;
+}
+
+int Trace::matmul(int a, int b, bool trans_b) {
+    const TraceOp& x = op(a);
+    const TraceOp& y = op(b);
+    const int k = trans_b ? y.cols : y.rows;
+    if (x.cols != k) {
+        throw std::invalid_argument("Incompatible shapes for matmul: " + shape_of(x.rows, x.cols) + " * " +
+                                    shape_of(y.rows, y.cols) + (trans_b ? "^T" : ""));
+    }
+    TraceOp out{OpKind::MatMul};
+    out.a = a;
+    out.b = b;
+    out.rows = x.rows;
+    out.cols = trans_b ? y.rows : y.cols;
+    out.trans_b = trans_b;
+    return push(out);
+}
+
+// ---------------- FUSION PASS ----------------
+FusionPlan plan_kernels(const Trace& trace, int output, bool fuse) {
+    const std::vector<TraceOp>& ops = trace.ops();
+    trace.op(output);  // range check
+    const int n = static_cast<int>(ops.size());
+
+    std::vector<bool> live(n, false);
+    std::vector<int> stack = {output};
+    while (!stack.empty()) {
+        int id = stack.back();
+        stack.pop_back();
+        if (id < 0 || live[id]) continue;
+        live[id] = true;
+        stack.push_back(ops[id].a);
+        stack.push_back(ops[id].b);
+    }
+
+    std::vector<std::set<int>> consumers(n);
+    for (int id = 0; id < n; id++) {
+        if (!live[id]) continue;
+        if (ops[id].a >= 0) consumers[ops[id].a].insert(id);
+        if (ops[id].b >= 0) consumers[ops[id].b].insert(id);
+    }
+
+    // Consumers come later in the trace, so walking backwards settles a
+    // consumer's kernel before its producers ask to join it
+    std::vector<int> owner(n);
+    for (int id = n - 1; id >= 0; id--) {
+        owner[id] = id;
+        if (!fuse || !live[id] || id == output || !is_elementwise(ops[id].kind)) continue;
+        if (consumers[id].size() != 1) continue;
+        const TraceOp& c = ops[*consumers[id].begin()];
+        if (is_elementwise(c.kind) && c.rows == ops[id].rows && c.cols == ops[id].cols)
+            owner[id] = owner[*consumers[id].begin()];
+    }
+
+    std::map<int, Kernel> by_root;
+    for (int id = 0; id < n; id++)
+        if (live[id] && ops[id].kind != OpKind::Input) by_root[owner[id]].ops.push_back(id);
+
+    FusionPlan plan;
+    plan.output = output;
+    for (auto& entry : by_root) {
+        const Kernel& kernel = entry.second;
+        std::set<int> inside(kernel.ops.begin(), kernel.ops.end());
+        std::set<int> read;
+        for (int id : kernel.ops)
+            for (int operand : {ops[id].a, ops[id].b})
+                if (operand >= 0 && !inside.count(operand)) read.insert(operand);
+        std::size_t elements = static_cast<std::size_t>(ops[kernel.output()].rows) * ops[kernel.output()].cols;
+        for (int id : read) elements += static_cast<std::size_t>(ops[id].rows) * ops[id].cols;
+        plan.bytes_moved += elements * sizeof(float);
+        plan.kernels.push_back(kernel);
+    }
+    return plan;
+}
+
+Node* execute(const Trace& trace, const FusionPlan& plan, const std::vector<Node*>& inputs) {
+    const std::vector<TraceOp>& ops = trace.ops();
+    if (static_cast<int>(inputs.size()) != trace.inputs())
+        throw std::invalid_argument("Trace takes " + std::to_string(trace.inputs()) + " inputs, got " +
+                                    std::to_string(inputs.size()));
+
+    std::vector<Node*> node_of(ops.size(), nullptr);
+    std::size_t next = 0;
+    for (std::size_t id = 0; id < ops.size(); id++) {
+        if (ops[id].kind != OpKind::Input) continue;
+        Node* in = inputs[next++];
+        const int rows = in->value.size(), cols = rows ? in->value[0].size() : 0;
+        if (rows != ops[id].rows || cols != ops[id].cols)
+            throw std::invalid_argument("Trace input " + std::to_string(next - 1) + " is " + shape_of(rows, cols) +
+                                        ", expected " + shape_of(ops[id].rows, ops[id].cols));
+        node_of[id] = in;
+    }
+
+    for (const Kernel& kernel : plan.kernels) {
+        const TraceOp& op = ops[kernel.output()];
+        Node* z;
+        if (is_elementwise(op.kind)) z = run_elementwise(trace, kernel, node_of);
+        else if (op.kind == OpKind::MatMul) z = run_matmul(op, node_of[op.a], node_of[op.b]);
+        else if (op.kind == OpKind::Softmax) z = run_softmax(op, node_of[op.a]);
+        else if (op.kind == OpKind::RowMean) z = run_row_mean(op, node_of[op.a]);
+        else throw std::logic_error("No kernel for " + op_name(op.kind));
+        node_of[kernel.output()] = z;
+    }
+    if (!node_of[plan.output]) throw std::logic_error("Plan did not produce its output");
+    return node_of[plan.output];
+}
+
+void backward_topological(Node* root) {
+    // Iterative post-order DFS; reversed, it lists every node after all of
+    // its consumers
+    std::vector<Node*> order;
+    std::set<Node*> seen = {root};
+    std::vector<std::pair<Node*, int>> stack = {{root, 0}};
+    while (!stack.empty()) {
+        auto& [node, child] = stack.back();
+        if (child < node->children.size()) {
+            Node* next = node->children[child++];
+            if (seen.insert(next).second) stack.push_back({next, 0});
+        } else {
+            order.push_back(node);
+            stack.pop_back();
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+        if ((*it)->backward) (*it)->backward();
+}
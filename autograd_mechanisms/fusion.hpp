@@ -0,0 +1,104 @@
+#ifndef FUSION_HPP
+#define FUSION_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "autograd.hpp"
+
+// ---------------- TRACED GRAPH ----------------
+// A graph recorded symbolically before any data exists, so it can be
+// optimised before it runs. Ops are numbered in the order they are added,
+// which is a topological order. Binary elementwise ops broadcast an operand
+// that is 1 x cols (a bias or gain row) or rows x 1 (a per-row statistic).
+
+enum class OpKind {
+    Input,
+    // elementwise
+    Add, Sub, Mul, Neg, Scale, AddScalar, Square, Rsqrt, Relu, Gelu,
+    // everything else is its own kernel
+    MatMul, Softmax, RowMean
+};
+
+struct TraceOp {
+    OpKind kind;
+    int a = -1;
+    int b = -1;
+    int rows = 0;
+    int cols = 0;
+    float scalar = 0.0f;     // Scale, AddScalar
+    bool trans_b = false;    // MatMul: a * b^T
+};
+
+bool is_elementwise(OpKind kind);
+std::string op_name(OpKind kind);
+
+class Trace {
+public:
+    int input(int rows, int cols);
+
+    int add(int a, int b);
+    int sub(int a, int b);
+    int mul(int a, int b);
+    int neg(int a);
+    int scale(int a, float s);
+    int add_scalar(int a, float s);
+    int square(int a);
+    int rsqrt(int a);
+    int relu(int a);
+    int gelu(int a);
+
+    int matmul(int a, int b, bool trans_b = false);
+    int softmax(int a);    // over each row
+    int row_mean(int a);   // rows x 1
+
+    const std::vector<TraceOp>& ops() const { return list; }
+    const TraceOp& op(int id) const;
+    int inputs() const { return input_count; }
+
+private:
+    int push(TraceOp op);
+    int unary(OpKind kind, int a, float scalar = 0.0f);
+    int binary(OpKind kind, int a, int b);
+
+    std::vector<TraceOp> list;
+    int input_count = 0;
+};
+
+// ---------------- FUSION PASS ----------------
+// A kernel is a set of ops run as one loop producing one output buffer;
+// ops lists them in trace order with the output op last.
+struct Kernel {
+    std::vector<int> ops;
+    int output() const { return ops.back(); }
+};
+
+struct FusionPlan {
+    int output = -1;
+    std::vector<Kernel> kernels;   // in execution order
+    std::size_t bytes_moved = 0;   // forward: operands read plus outputs written
+};
+
+// Only ops that output depends on are planned. With fuse = false every
+// non-input op is a kernel of its own. With fuse = true, an elementwise op
+// joins its consumer's kernel when that consumer is its only one, is
+// elementwise too and has the same shape, which grows maximal chains (and
+// trees, e.g. a * b + c) ending in the one op whose result is needed
+// outside. Ops whose value is used twice stay kernel outputs, so nothing is
+// computed twice.
+FusionPlan plan_kernels(const Trace& trace, int output, bool fuse);
+
+// Runs the plan as autograd nodes, one per kernel, and returns the node of
+// the plan's output. inputs are bound to the trace's Input ops in order. An
+// elementwise kernel is interpreted strip by strip: every op runs over a
+// short run of columns held in an L1-sized scratch, so intermediates never
+// reach memory. Its backward recomputes the strip and sweeps the ops in
+// reverse, adding into each operand's grad (summed over broadcast axes).
+Node* execute(const Trace& trace, const FusionPlan& plan, const std::vector<Node*>& inputs);
+
+// Backward in reverse topological order, each node once. Trace graphs share
+// intermediates (LayerNorm's centred input feeds two ops); backward()
+// recurses per path and would apply a shared node once per path.
+void backward_topological(Node* root);
+
+#endif // FUSION_HPP
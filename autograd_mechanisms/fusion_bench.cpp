@@ -0,0 +1,225 @@
+#include "fusion.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// Kernel count, forward bytes moved and time of two traced graphs run one
+// op per kernel and after the fusion pass: the train_digits MLP with a
+// squared-error loss, and a single-head pre-LayerNorm transformer block.
+// Also checks that both plans give the same output and input gradients,
+// and checks both against central differences on a small graph that uses
+// every op.
+//
+// usage: fusion_bench [batch / sequence length] [repeats]
+
+namespace {
+
+struct Model {
+    std::string name;
+    Trace trace;
+    int output = -1;
+};
+
+int layer_norm(Trace& t, int x, int gain, int bias) {
+    int mu = t.row_mean(x);
+    int centred = t.sub(x, mu);
+    int var = t.row_mean(t.square(centred));
+    int inv_std = t.rsqrt(t.add_scalar(var, 1e-5f));
+    return t.add(t.mul(t.mul(centred, inv_std), gain), bias);
+}
+
+Model mlp(int batch) {
+    Model m;
+    m.name = "MLP 784-128-10 + squared error";
+    Trace& t = m.trace;
+    int x = t.input(batch, 784);
+    int w1 = t.input(784, 128), b1 = t.input(1, 128);
+    int w2 = t.input(128, 10), b2 = t.input(1, 10);
+    int target = t.input(batch, 10);
+    int h = t.relu(t.add(t.matmul(x, w1), b1));
+    int probs = t.softmax(t.add(t.matmul(h, w2), b2));
+    m.output = t.row_mean(t.square(t.sub(probs, target)));
+    return m;
+}
+
+Model transformer_block(int seq) {
+    const int d = 128, ff = 512;
+    Model m;
+    m.name = "transformer block d=128 ff=512, one head";
+    Trace& t = m.trace;
+    int x = t.input(seq, d);
+    int mask = t.input(seq, seq);
+    int g1 = t.input(1, d), be1 = t.input(1, d);
+    int wq = t.input(d, d), wk = t.input(d, d), wv = t.input(d, d), wo = t.input(d, d);
+    int g2 = t.input(1, d), be2 = t.input(1, d);
+    int w1 = t.input(d, ff), b1 = t.input(1, ff), w2 = t.input(ff, d), b2 = t.input(1, d);
+
+    int h = layer_norm(t, x, g1, be1);
+    int q = t.matmul(h, wq), k = t.matmul(h, wk), v = t.matmul(h, wv);
+    int scores = t.add(t.scale(t.matmul(q, k, true), 1.0f / std::sqrt(static_cast<float>(d))), mask);
+    int attn = t.matmul(t.matmul(t.softmax(scores), v), wo);
+    int x2 = t.add(x, attn);
+    int h2 = layer_norm(t, x2, g2, be2);
+    int f = t.gelu(t.add(t.matmul(h2, w1), b1));
+    m.output = t.add(x2, t.add(t.matmul(f, w2), b2));
+    return m;
+}
+
+// Every op kind, a 1 x cols row and a rows x 1 column broadcast on either
+// side, a Mul of a value with itself and a MatMul against a transpose
+Model every_op() {
+    const int rows = 3, cols = 5;
+    Model m;
+    m.name = "every op";
+    Trace& t = m.trace;
+    int x = t.input(rows, cols), y = t.input(rows, cols), w = t.input(cols, cols);
+    int row = t.input(1, cols), col = t.input(rows, 1);
+    int a = t.mul(t.add(row, x), col);
+    int c = t.sub(a, t.mul(col, y));
+    int e = t.rsqrt(t.add_scalar(t.square(t.neg(c)), 0.1f));
+    int f = t.add(t.scale(t.mul(t.mul(c, c), e), 0.5f), t.mul(t.relu(t.add(x, y)), t.gelu(c)));
+    int h = t.matmul(t.sub(f, t.row_mean(f)), w);
+    m.output = t.add(t.matmul(t.softmax(t.matmul(h, x, true)), h), row);
+    return m;
+}
+
+std::vector<Node*> make_inputs(const Trace& trace) {
+    std::vector<Node*> inputs;
+    Philox gen(11);
+    for (const TraceOp& op : trace.ops()) {
+        if (op.kind != OpKind::Input) continue;
+        Node* node = new Node(matrix(op.rows, op.cols));
+        node->value.fill_uniform(gen.split(inputs.size()), -0.5f, 0.5f);
+        inputs.push_back(node);
+    }
+    return inputs;
+}
+
+// Largest |numeric - analytic| / max(1, |numeric| + |analytic|) over every
+// input element, where analytic is what backward gives for the loss
+// sum(weights * output) and numeric its central difference
+double gradient_error(const Model& m, const FusionPlan& plan, const std::vector<Node*>& inputs) {
+    const TraceOp& out_op = m.trace.op(m.output);
+    matrix weights(out_op.rows, out_op.cols);
+    weights.fill_uniform(Philox(23), -1.0f, 1.0f);
+    auto loss = [&] {
+        Node* out = execute(m.trace, plan, inputs);
+        double sum = 0.0;
+        for (int i = 0; i < out->value.size(); i++)
+            for (int j = 0; j < out->value[i].size(); j++) sum += static_cast<double>(weights[i][j]) * out->value[i][j];
+        free_nodes(out, inputs);
+        return sum;
+    };
+
+    for (Node* in : inputs) in->grad.fill_zeroes();
+    Node* out = execute(m.trace, plan, inputs);
+    out->grad = weights;
+    backward_topological(out);
+    free_nodes(out, inputs);
+
+    const float eps = 4e-3f;
+    double worst = 0.0;
+    for (Node* in : inputs) {
+        for (int i = 0; i < in->value.size(); i++) {
+            for (int j = 0; j < in->value[i].size(); j++) {
+                const float saved = in->value[i][j];
+                in->value[i][j] = saved + eps;
+                const double up = loss();
+                in->value[i][j] = saved - eps;
+                const double down = loss();
+                in->value[i][j] = saved;
+                const double numeric = (up - down) / (2.0 * eps);
+                const double analytic = in->grad[i][j];
+                worst = std::max(worst, std::fabs(numeric - analytic) / std::max(1.0, std::fabs(numeric) + std::fabs(analytic)));
+            }
+        }
+    }
+    return worst;
+}
+
+struct RunResult {
+    double forward_ms = 0.0;
+    double total_ms = 0.0;
+    std::vector<float> values;  // output, then every input gradient
+};
+
+RunResult run(const Model& m, const FusionPlan& plan, const std::vector<Node*>& inputs, int repeats) {
+    RunResult result;
+    for (int r = 0; r < repeats; r++) {
+        for (Node* in : inputs) in->grad.fill_zeroes();
+        auto start = Clock::now();
+        Node* out = execute(m.trace, plan, inputs);
+        result.forward_ms += elapsed_ms(start);
+        for (int i = 0; i < out->grad.size(); i++)
+            for (int j = 0; j < out->grad[i].size(); j++) out->grad[i][j] = 1.0f;
+        backward_topological(out);
+        result.total_ms += elapsed_ms(start);
+
+        if (r + 1 == repeats) {
+            for (int i = 0; i < out->value.size(); i++)
+                for (int j = 0; j < out->value[i].size(); j++) result.values.push_back(out->value[i][j]);
+            for (Node* in : inputs)
+                for (int i = 0; i < in->grad.size(); i++)
+                    for (int j = 0; j < in->grad[i].size(); j++) result.values.push_back(in->grad[i][j]);
+        }
+        free_nodes(out, inputs);
+    }
+    result.forward_ms /= repeats;
+    result.total_ms /= repeats;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? std::stoi(argv[1]) : 64;
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    try {
+        const Model check = every_op();
+        std::vector<Node*> check_inputs = make_inputs(check.trace);
+        const double unfused_error = gradient_error(check, plan_kernels(check.trace, check.output, false), check_inputs);
+        const double fused_error = gradient_error(check, plan_kernels(check.trace, check.output, true), check_inputs);
+        for (Node* in : check_inputs) delete in;
+        std::cout << "gradient check, every op, largest relative error against central differences: one op per kernel "
+                  << unfused_error << ", fused " << fused_error << std::endl << std::endl;
+        // Float differences land near 1e-5; a wrong adjoint is well above
+        if (std::max(unfused_error, fused_error) > 1e-3) throw std::runtime_error("Gradient check failed");
+
+        for (const Model& m : {mlp(rows), transformer_block(rows)}) {
+            std::vector<Node*> inputs = make_inputs(m.trace);
+            FusionPlan before = plan_kernels(m.trace, m.output, false);
+            FusionPlan after = plan_kernels(m.trace, m.output, true);
+            RunResult a = run(m, before, inputs, repeats);
+            RunResult b = run(m, after, inputs, repeats);
+
+            double max_diff = 0.0;
+            for (std::size_t i = 0; i < a.values.size(); i++)
+                max_diff = std::max(max_diff, static_cast<double>(std::fabs(a.values[i] - b.values[i])));
+
+            std::cout << m.name << ", " << rows << " rows" << std::endl;
+            std::cout << "plan | kernels | forward MB moved | forward ms | forward+backward ms" << std::endl;
+            std::cout << "one op per kernel | " << before.kernels.size() << " | " << before.bytes_moved / 1e6 << " | "
+                      << a.forward_ms << " | " << a.total_ms << std::endl;
+            std::cout << "fused | " << after.kernels.size() << " | " << after.bytes_moved / 1e6 << " | "
+                      << b.forward_ms << " | " << b.total_ms << std::endl;
+            std::cout << "fused kernels:";
+            for (const Kernel& k : after.kernels) {
+                if (k.ops.size() < 2) continue;
+                std::cout << " [";
+                for (std::size_t i = 0; i < k.ops.size(); i++)
+                    std::cout << (i ? " " : "") << op_name(m.trace.op(k.ops[i]).kind);
+                std::cout << "]";
+            }
+            std::cout << std::endl << "max abs difference in output and gradients: " << max_diff << std::endl << std::endl;
+
+            for (Node* in : inputs) delete in;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
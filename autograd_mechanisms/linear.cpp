@@ -0,0 +1,67 @@
+#include "linear.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+Node* linear(Node* x, Node* w, Node* b, Activation activation) {
+    const int rows = x->value.size();
+    const int in = rows ? x->value[0].size() : 0;
+    if (w->value.size() != in)
+        throw std::invalid_argument("linear: input has " + std::to_string(in) + " features, weight has " +
+                                    std::to_string(w->value.size()) + " rows");
+    const int out = w->value.size() ? w->value[0].size() : 0;
+    if (b && (b->value.size() != 1 || b->value[0].size() != out))
+        throw std::invalid_argument("linear: bias must be 1x" + std::to_string(out));
+
+    Node* z = new Node(matrix(rows, out));
+    z->children.push(x);
+    z->children.push(w);
+    if (b) z->children.push(b);
+
+    // GELU's derivative needs the pre-activation; ReLU's can be read off z
+    std::shared_ptr<matrix> preact;
+    std::vector<float*> preact_rows;
+    GemmEpilogue epilogue;
+    epilogue.bias = b ? &b->value[0][0] : nullptr;
+    epilogue.activation = activation;
+    if (activation == Activation::GELU) {
+        preact = std::make_shared<matrix>(rows, out);
+        for (int i = 0; i < rows; i++) preact_rows.push_back(&(*preact)[i][0]);
+        epilogue.preact = preact_rows.data();
+    }
+    gemm(x->value, false, w->value, false, z->value, epilogue);
+
+    z->backward = [=]() {
+        // dz = grad * activation'(pre-activation), summed into the bias
+        // gradient in the same pass
+        matrix masked;
+        const matrix* dz = &z->grad;
+        if (activation != Activation::None) {
+            masked = matrix(rows, out);
+            dz = &masked;
+        }
+        float* bias_grad = b ? &b->grad[0][0] : nullptr;
+        for (int i = 0; i < rows; i++) {
+            const float* g = &z->grad[i][0];
+            float* d = activation != Activation::None ? &masked[i][0] : nullptr;
+            if (activation == Activation::ReLU) {
+                const float* y = &z->value[i][0];
+                for (int j = 0; j < out; j++) d[j] = y[j] > 0.0f ? g[j] : 0.0f;
+            } else if (activation == Activation::GELU) {
+                const float* p = &(*preact)[i][0];
+                gelu_backward(p, g, d, out);  // d starts zeroed
+            }
+            if (bias_grad) {
+                const float* src = d ? d : g;
+                for (int j = 0; j < out; j++) bias_grad[j] += src[j];
+            }
+        }
+
+        GemmEpilogue accumulate;
+        accumulate.accumulate = true;
+        gemm(*dz, false, w->value, true, x->grad, accumulate);
+        gemm(x->value, true, *dz, false, w->grad, accumulate);
+    };
+    return z;
+}
@@ -0,0 +1,19 @@
+#ifndef LINEAR_HPP
+#define LINEAR_HPP
+
+#include "autograd.hpp"
+#include "../math_primitives/gemm.hpp"
+
+// ---------------- LINEAR ----------------
+// activation(x * w + b) as one node: x is rows x in, w is in x out and b a
+// 1 x out bias broadcast over the rows (nullptr for none). The bias and
+// activation run in the GEMM epilogue, so the layer writes its output once
+// instead of materialising the product, the sum and the activation.
+//
+// Backward makes one pass over the output gradient to apply the activation
+// derivative and sum the bias gradient, then two accumulating GEMMs:
+// x.grad += dz * w^T and w.grad += x^T * dz. ReLU's derivative comes from
+// the output itself; GELU keeps the pre-activation from the forward pass.
+Node* linear(Node* x, Node* w, Node* b = nullptr, Activation activation = Activation::None);
+
+#endif // LINEAR_HPP
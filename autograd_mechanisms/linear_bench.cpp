@@ -0,0 +1,121 @@
+#include "linear.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// Fused linear() against the unfused relu(add(matmul(x, w), b)) graph on an
+// MLP-sized layer: forward and forward+backward time, plus a check of the
+// fused output and gradients against a naive triple loop for every
+// activation.
+//
+// usage: linear_bench [rows] [in] [out] [repeats]
+
+namespace {
+
+float act(float v, Activation a) {
+    if (a == Activation::ReLU) return v > 0.0f ? v : 0.0f;
+    if (a == Activation::GELU) return gelu(v);
+    return v;
+}
+
+float act_grad(float v, Activation a) {
+    if (a == Activation::ReLU) return v > 0.0f ? 1.0f : 0.0f;
+    if (a == Activation::GELU) return gelu_grad(v);
+    return 1.0f;
+}
+
+// Naive forward/backward with upstream gradient `up`; returns the worst
+// absolute error over y, dx, dw and db
+float check(Node* x, Node* w, Node* b, const matrix& up, Activation a) {
+    const int rows = x->value.size(), in = w->value.size(), out = w->value[0].size();
+    matrix pre(rows, out), y(rows, out), dz(rows, out), dx(rows, in), dw(in, out), db(1, out);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < out; j++) {
+            double s = b->value[0][j];
+            for (int p = 0; p < in; p++) s += static_cast<double>(x->value[i][p]) * w->value[p][j];
+            pre[i][j] = static_cast<float>(s);
+            y[i][j] = act(pre[i][j], a);
+            dz[i][j] = up[i][j] * act_grad(pre[i][j], a);
+            db[0][j] += dz[i][j];
+        }
+    for (int i = 0; i < rows; i++)
+        for (int p = 0; p < in; p++)
+            for (int j = 0; j < out; j++) {
+                dx[i][p] += dz[i][j] * w->value[p][j];
+                dw[p][j] += x->value[i][p] * dz[i][j];
+            }
+
+    x->grad.fill_zeroes();
+    w->grad.fill_zeroes();
+    b->grad.fill_zeroes();
+    Node* z = linear(x, w, b, a);
+    z->grad = up;
+    z->backward();
+    float err = std::max({max_diff(z->value, y), max_diff(x->grad, dx), max_diff(w->grad, dw), max_diff(b->grad, db)});
+    delete z;
+    return err;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? std::stoi(argv[1]) : 64;
+    int in = argc > 2 ? std::stoi(argv[2]) : 784;
+    int out = argc > 3 ? std::stoi(argv[3]) : 128;
+    int repeats = argc > 4 ? std::stoi(argv[4]) : 10;
+
+    try {
+        Philox gen(3);
+        Node* x = new Node(matrix(rows, in));
+        Node* w = new Node(matrix(in, out));
+        Node* b = new Node(matrix(1, out));
+        x->value.fill_uniform(gen, 0.0f, 1.0f);
+        w->value.fill_xavier(gen.split(1), in, out);
+        b->value.fill_uniform(gen.split(2), -0.1f, 0.1f);
+        matrix up(rows, out);
+        up.fill_uniform(gen.split(3), -1.0f, 1.0f);
+
+        const char* names[] = {"none", "relu", "gelu"};
+        for (Activation a : {Activation::None, Activation::ReLU, Activation::GELU})
+            std::cout << "max abs error vs naive (" << names[static_cast<int>(a)] << "): " << check(x, w, b, up, a)
+                      << std::endl;
+
+        // add() does not broadcast, so the unfused graph gets the bias tiled
+        Node* b_rows = new Node(matrix(rows, out));
+        for (int i = 0; i < rows; i++) b_rows->value[i] = b->value[0];
+        const std::vector<Node*> leaves = {x, w, b, b_rows};
+
+        double unfused_fwd = 0.0, unfused_all = 0.0, fused_fwd = 0.0, fused_all = 0.0;
+        for (int r = 0; r < repeats; r++) {
+            auto start = Clock::now();
+            Node* y = relu(add(matmul(x, w), b_rows));
+            unfused_fwd += elapsed_ms(start);
+            y->grad = up;
+            backward(y);
+            unfused_all += elapsed_ms(start);
+            free_nodes(y, leaves);
+
+            start = Clock::now();
+            Node* z = linear(x, w, b, Activation::ReLU);
+            fused_fwd += elapsed_ms(start);
+            z->grad = up;
+            backward(z);
+            fused_all += elapsed_ms(start);
+            free_nodes(z, leaves);
+        }
+
+        std::cout << rows << "x" << in << " * " << in << "x" << out << ", ReLU, mean of " << repeats << std::endl;
+        std::cout << "graph | forward ms | forward+backward ms" << std::endl;
+        std::cout << "relu(add(matmul)) | " << unfused_fwd / repeats << " | " << unfused_all / repeats << std::endl;
+        std::cout << "linear | " << fused_fwd / repeats << " | " << fused_all / repeats << std::endl;
+        std::cout << "speedup | " << unfused_fwd / fused_fwd << "x | " << unfused_all / fused_all << "x" << std::endl;
+
+        for (Node* n : leaves) delete n;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
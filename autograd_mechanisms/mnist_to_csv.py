@@ -1,9 +1,32 @@
 # convert_parquet_to_csv.py
-import pandas as pd
+# Writes mnist.csv (label,pixel0,...,pixel783 per row) and the IDX pair
+# train-images-idx3-ubyte / train-labels-idx1-ubyte read by train_digits.
+import io
+import struct
+
 import numpy as np
+import pandas as pd
+from PIL import Image
 
 # Read parquet
 df = pd.read_parquet('mnist.parquet')
 
+# Images are stored as {'bytes': <png>, 'path': ...}
+pixels = np.stack([np.array(Image.open(io.BytesIO(img['bytes'])).convert('L'), dtype=np.uint8)
+                   for img in df['image']])
+labels = df['label'].to_numpy(dtype=np.uint8)
+count, rows, cols = pixels.shape
+
 # Save as CSV
-df.to_csv('mnist.csv', index=False)
+flat = pixels.reshape(count, rows * cols)
+table = pd.DataFrame(flat, columns=[f'pixel{i}' for i in range(rows * cols)])
+table.insert(0, 'label', labels)
+table.to_csv('mnist.csv', index=False)
+
+# Save as IDX (big-endian header, raw uint8 data)
+with open('train-images-idx3-ubyte', 'wb') as f:
+    f.write(struct.pack('>IIII', 0x00000803, count, rows, cols))
+    f.write(pixels.tobytes())
+with open('train-labels-idx1-ubyte', 'wb') as f:
+    f.write(struct.pack('>II', 0x00000801, count))
+    f.write(labels.tobytes())
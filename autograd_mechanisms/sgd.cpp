@@ -1,12 +1,34 @@
 #include "sgd.hpp"
-#include "../phase_1/vector.hpp"
+#include "sparse_embedding.hpp"
+#include "../math_primitives/vector.hpp"
+#include <stdexcept>
+
+namespace {
+
+// w -= lr * g over one row. Both steps go through here so the dense and
+// sparse paths round the same way, with or without FMA contraction.
+void update_row(float* w, const float* g, int n, float lr) {
+    for (int c = 0; c < n; c++) w[c] -= lr * g[c];
+}
+
+} // namespace
 
 void SGD::step(MyList<Node*> params) {
     for (int i = 0; i < params.size(); i++) {
         // Gradient descent update: params[i] = params[i] - lr * grad
-        params[i]->value = params[i]->value + params[i]->grad.scalarMultiply(-lr);
+        matrix& value = params[i]->value;
+        const matrix& grad = params[i]->grad;
+        if (!(value.shape() == grad.shape())) throw std::invalid_argument("SGD: gradient shape does not match its parameter");
+        for (int r = 0; r < value.size(); r++) update_row(&value[r][0], &grad[r][0], value[r].size(), lr);
 
         // Optional: reset gradient to zero after update
         params[i]->grad.fill_zeroes();
     }
 }
+
+void SGD::step(SparseEmbedding& table) {
+    const int cols = table.dim();
+    for (std::size_t k = 0; k < table.grad.touched(); k++)
+        update_row(&table.weight[table.grad.row_at(k)][0], table.grad.values_at(k), cols, lr);
+    table.grad.clear();
+}
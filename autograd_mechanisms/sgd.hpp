@@ -4,6 +4,8 @@
 #include "autograd.hpp"  // Include Node, add, mul, etc.
 #include <vector>
 
+class SparseEmbedding;
+
 class SGD {
 public:
     float lr; // learning rate
@@ -12,6 +14,10 @@ public:
 
     // Update parameters in-place
     void step(MyList<Node*> params);
+
+    // Updates only the rows touched since the last step, then clears the
+    // table's gradient; cost is proportional to the touched rows
+    void step(SparseEmbedding& table);
 };
 
 #endif
@@ -0,0 +1,62 @@
+#include "sparse_embedding.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// ---------------- SPARSE ROW GRADIENT ----------------
+SparseRowGrad::SparseRowGrad(int rows, int cols) : n_rows(rows), n_cols(cols), slot_of(rows, -1) {
+    if (rows <= 0 || cols <= 0) throw std::invalid_argument("SparseRowGrad needs a non-empty shape");
+}
+
+float* SparseRowGrad::slot(int row) {
+    if (row < 0 || row >= n_rows)
+        throw std::out_of_range("Row " + std::to_string(row) + " outside gradient of " + std::to_string(n_rows));
+    int& s = slot_of[row];
+    if (s < 0) {
+        s = static_cast<int>(touched_rows.size());
+        touched_rows.push_back(row);
+        values.resize(values.size() + n_cols, 0.0f);
+    }
+    return values.data() + static_cast<std::size_t>(s) * n_cols;
+}
+
+void SparseRowGrad::add(int row, const float* g) {
+    float* dst = slot(row);
+    for (int j = 0; j < n_cols; j++) dst[j] += g[j];
+}
+
+const float* SparseRowGrad::find(int row) const {
+    if (row < 0 || row >= n_rows || slot_of[row] < 0) return nullptr;
+    return values.data() + static_cast<std::size_t>(slot_of[row]) * n_cols;
+}
+
+void SparseRowGrad::clear() {
+    for (int row : touched_rows) slot_of[row] = -1;
+    touched_rows.clear();
+    values.clear();   // keeps capacity for the next step
+}
+
+// ---------------- SPARSE EMBEDDING ----------------
+SparseEmbedding::SparseEmbedding(int vocab, int dim) : weight(vocab, dim), grad(vocab, dim) {}
+
+Node* SparseEmbedding::forward(const std::vector<int>& ids) {
+    if (ids.empty()) throw std::invalid_argument("embedding of an empty id list");
+    for (int id : ids)
+        if (id < 0 || id >= vocab())
+            throw std::out_of_range("Token id " + std::to_string(id) + " outside embedding table of " +
+                                    std::to_string(vocab()));
+
+    const int rows = static_cast<int>(ids.size());
+    const int d = dim();
+    Node* z = new Node(matrix(rows, d));
+    for (int t = 0; t < rows; t++) {
+        const float* src = &weight[ids[t]][0];
+        std::copy(src, src + d, &z->value[t][0]);
+    }
+
+    // The table is not a child node: its gradient lives in this->grad
+    z->backward = [this, z, ids]() {
+        for (std::size_t t = 0; t < ids.size(); t++) grad.add(ids[t], &z->grad[static_cast<int>(t)][0]);
+    };
+    return z;
+}
@@ -0,0 +1,66 @@
+#ifndef SPARSE_EMBEDDING_HPP
+#define SPARSE_EMBEDDING_HPP
+
+#include <cstddef>
+#include <vector>
+#include "autograd.hpp"
+
+// ---------------- SPARSE ROW GRADIENT ----------------
+// Gradient of a rows x cols parameter when each step touches only a few
+// rows. A touched row gets a dense slot, found through a row -> slot array,
+// so repeated ids in a batch coalesce into one slot as they are added.
+// clear() costs O(touched rows), never O(rows).
+class SparseRowGrad {
+public:
+    SparseRowGrad(int rows, int cols);
+
+    int rows() const { return n_rows; }
+    int cols() const { return n_cols; }
+
+    // grad[row] += g (cols floats)
+    void add(int row, const float* g);
+    // Accumulator for row, zeroed on first touch this step
+    float* slot(int row);
+    // nullptr when row has not been touched
+    const float* find(int row) const;
+
+    // Touched rows in first-touch order
+    std::size_t touched() const { return touched_rows.size(); }
+    int row_at(std::size_t k) const { return touched_rows[k]; }
+    const float* values_at(std::size_t k) const { return values.data() + k * n_cols; }
+
+    void clear();
+
+private:
+    int n_rows;
+    int n_cols;
+    std::vector<int> slot_of;        // -1 when untouched
+    std::vector<int> touched_rows;
+    std::vector<float> values;       // touched() x cols
+};
+
+// ---------------- SPARSE EMBEDDING ----------------
+// Embedding table held as its own parameter type instead of a Node, whose
+// dense vocab x dim grad would be zeroed and swept by the optimizer every
+// step. forward() returns an ordinary node for the gathered rows; its
+// backward adds into the sparse grad, and SGD / Adam have overloads that
+// update only the touched rows.
+class SparseEmbedding {
+public:
+    SparseEmbedding(int vocab, int dim);
+
+    // Nodes from forward() point back at this table
+    SparseEmbedding(const SparseEmbedding&) = delete;
+    SparseEmbedding& operator=(const SparseEmbedding&) = delete;
+
+    int vocab() const { return weight.size(); }
+    int dim() const { return grad.cols(); }
+
+    // ids.size() x dim rows of weight
+    Node* forward(const std::vector<int>& ids);
+
+    matrix weight;
+    SparseRowGrad grad;
+};
+
+#endif // SPARSE_EMBEDDING_HPP
@@ -0,0 +1,130 @@
+#include "sparse_embedding.hpp"
+#include "transformer_ops.hpp"
+#include "sgd.hpp"
+#include "adam.cpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// Embedding training steps with a dense Node table against SparseEmbedding:
+// time for backward plus optimizer step with SGD and with Adam, and checks
+// that sparse SGD gives the same weights as dense SGD and that lazy Adam's
+// caught-up moments match dense Adam's for the touched rows.
+//
+// Ids are skewed (vocab * u^3) so batches repeat tokens, as text does. The
+// first step allocates optimizer state and is left out of the timings.
+//
+// usage: sparse_embedding_bench [vocab] [dim] [tokens per step] [steps]
+
+namespace {
+
+std::vector<int> batch_ids(int step, int tokens, int vocab) {
+    Philox gen(31, static_cast<std::uint64_t>(step));
+    std::vector<int> ids(tokens);
+    for (int t = 0; t < tokens; t++) {
+        float u = gen.uniform(t);
+        ids[t] = std::min(vocab - 1, static_cast<int>(vocab * u * u * u));
+    }
+    return ids;
+}
+
+matrix upstream(int step, int tokens, int dim) {
+    matrix g(tokens, dim);
+    g.fill_uniform(Philox(32, static_cast<std::uint64_t>(step)), -1.0f, 1.0f);
+    return g;
+}
+
+struct Timing {
+    double dense_ms = 0.0;
+    double sparse_ms = 0.0;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int vocab = argc > 1 ? std::stoi(argv[1]) : 50000;
+    int dim = argc > 2 ? std::stoi(argv[2]) : 768;
+    int tokens = argc > 3 ? std::stoi(argv[3]) : 4096;
+    int steps = argc > 4 ? std::stoi(argv[4]) : 3;
+
+    try {
+        matrix init(vocab, dim);
+        init.fill_uniform(Philox(30), -0.1f, 0.1f);
+
+        std::size_t distinct = 0;
+        for (int s = 0; s < steps; s++) {
+            std::vector<int> ids = batch_ids(s, tokens, vocab);
+            std::sort(ids.begin(), ids.end());
+            distinct += std::unique(ids.begin(), ids.end()) - ids.begin();
+        }
+        std::cout << vocab << "x" << dim << " table, " << tokens << " tokens per step, "
+                  << static_cast<double>(distinct) / steps << " distinct rows per step on average" << std::endl;
+
+        for (int use_adam = 0; use_adam < 2; use_adam++) {
+            Timing timing;
+            Node* dense = new Node(init);
+            SparseEmbedding sparse(vocab, dim);
+            sparse.weight = init;
+            SGD sgd(0.1f);
+            Adam dense_adam(0.01f), sparse_adam(0.01f);
+            std::vector<Node*> dense_params = {dense};
+            MyList<Node*> dense_list;
+            dense_list.push(dense);
+
+            for (int s = 0; s < steps; s++) {
+                std::vector<int> ids = batch_ids(s, tokens, vocab);
+                matrix up = upstream(s, tokens, dim);
+
+                Node* y = embedding(dense, ids);
+                y->grad = up;
+                auto start = Clock::now();
+                backward(y);
+                if (use_adam) dense_adam.step(dense_params);
+                else sgd.step(dense_list);
+                if (s > 0 || steps == 1) timing.dense_ms += elapsed_ms(start);
+                delete y;
+
+                y = sparse.forward(ids);
+                y->grad = up;
+                start = Clock::now();
+                backward(y);
+                if (use_adam) sparse_adam.step(sparse);
+                else sgd.step(sparse);
+                if (s > 0 || steps == 1) timing.sparse_ms += elapsed_ms(start);
+                delete y;
+            }
+
+            double diff = 0.0;
+            if (!use_adam) {
+                for (int r = 0; r < vocab; r++)
+                    for (int c = 0; c < dim; c++)
+                        diff = std::max(diff, static_cast<double>(std::fabs(dense->value[r][c] - sparse.weight[r][c])));
+            } else {
+                // Bring each row's lazy moments forward to the last step
+                const Adam::LazyMoments& lazy = sparse_adam.sparse.at(&sparse);
+                for (int r = 0; r < vocab; r++) {
+                    if (lazy.last[r] == 0) continue;
+                    const int gap = lazy.t - lazy.last[r];
+                    const float d1 = std::pow(sparse_adam.beta1, gap), d2 = std::pow(sparse_adam.beta2, gap);
+                    for (int c = 0; c < dim; c++) {
+                        diff = std::max(diff, static_cast<double>(std::fabs(d1 * lazy.m[r][c] - dense_adam.m[0][r][c])));
+                        diff = std::max(diff, static_cast<double>(std::fabs(d2 * lazy.v[r][c] - dense_adam.v[0][r][c])));
+                    }
+                }
+            }
+
+            const int timed = std::max(1, steps - 1);
+            std::cout << (use_adam ? "Adam" : "SGD ") << " backward+step: dense " << timing.dense_ms / timed
+                      << " ms, sparse " << timing.sparse_ms / timed << " ms, speedup "
+                      << timing.dense_ms / timing.sparse_ms << "x, "
+                      << (use_adam ? "max moment difference " : "max weight difference ") << diff << std::endl;
+            delete dense;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "transformer_ops.hpp"
+#include "../utils/helpers.hpp"
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void require_row(const Node* node, int cols, const char* what) {
+    if (node->value.size() != 1 || node->value[0].size() != cols)
+        throw std::invalid_argument(std::string(what) + " must be 1x" + std::to_string(cols) + ", got " +
+                                    shape_of(node->value));
+}
+
+} // namespace
+
+// ---------------- LAYER NORM ----------------
+Node* layer_norm(Node* x, Node* gain, Node* bias, float eps) {
+    const int rows = x->value.size();
+    const int d = rows ? x->value[0].size() : 0;
+    if (rows == 0 || d == 0) throw std::invalid_argument("layer_norm of an empty matrix");
+    require_row(gain, d, "layer_norm gain");
+    require_row(bias, d, "layer_norm bias");
+
+    Node* z = new Node(matrix(rows, d));
+    z->children.push(x);
+    z->children.push(gain);
+    z->children.push(bias);
+
+    // Per-row mean and 1 / std, all the backward needs besides x
+    auto stats = std::make_shared<std::vector<float>>(2 * static_cast<std::size_t>(rows));
+    const float* g = &gain->value[0][0];
+    const float* b = &bias->value[0][0];
+    for (int i = 0; i < rows; i++) {
+        const RowNorm norm = layer_norm_row(&x->value[i][0], g, b, &z->value[i][0], d, eps);
+        (*stats)[2 * i] = norm.mean;
+        (*stats)[2 * i + 1] = norm.rstd;
+    }
+
+    z->backward = [=]() {
+        const float* g = &gain->value[0][0];
+        float* dgain = &gain->grad[0][0];
+        float* dbias = &bias->grad[0][0];
+        for (int i = 0; i < rows; i++) {
+            const float mean = (*stats)[2 * i];
+            const float rstd = (*stats)[2 * i + 1];
+            const float* in = &x->value[i][0];
+            const float* dy = &z->grad[i][0];
+            float sum_dyg = 0.0f, sum_dyg_xhat = 0.0f;
+            for (int j = 0; j < d; j++) {
+                const float xhat = (in[j] - mean) * rstd;
+                const float dyg = dy[j] * g[j];
+                sum_dyg += dyg;
+                sum_dyg_xhat += dyg * xhat;
+                dgain[j] += dy[j] * xhat;
+                dbias[j] += dy[j];
+            }
+            // dx = rstd * (dy*g - mean(dy*g) - x_hat * mean(dy*g*x_hat))
+            const float mean_dyg = sum_dyg / d;
+            const float mean_dyg_xhat = sum_dyg_xhat / d;
+            float* dx = &x->grad[i][0];
+            for (int j = 0; j < d; j++) {
+                const float xhat = (in[j] - mean) * rstd;
+                dx[j] += rstd * (dy[j] * g[j] - mean_dyg - xhat * mean_dyg_xhat);
+            }
+        }
+    };
+    return z;
+}
+
+// ---------------- GELU ----------------
+Node* gelu(Node* x) {
+    const int rows = x->value.size();
+    const int cols = rows ? x->value[0].size() : 0;
+    Node* z = new Node(matrix(rows, cols));
+    z->children.push(x);
+    for (int i = 0; i < rows && cols; i++) gelu(&x->value[i][0], &z->value[i][0], cols);
+
+    z->backward = [=]() {
+        for (int i = 0; i < rows && cols; i++) gelu_backward(&x->value[i][0], &z->grad[i][0], &x->grad[i][0], cols);
+    };
+    return z;
+}
+
+// ---------------- EMBEDDING ----------------
+Node* embedding(Node* table, const std::vector<int>& ids) {
+    const int vocab = table->value.size();
+    const int d = vocab ? table->value[0].size() : 0;
+    if (ids.empty()) throw std::invalid_argument("embedding of an empty id list");
+    for (int id : ids)
+        if (id < 0 || id >= vocab)
+            throw std::out_of_range("Token id " + std::to_string(id) + " outside embedding table of " +
+                                    std::to_string(vocab));
+
+    const int rows = static_cast<int>(ids.size());
+    Node* z = new Node(matrix(rows, d));
+    z->children.push(table);
+    for (int t = 0; t < rows; t++) {
+        const float* src = &table->value[ids[t]][0];
+        std::copy(src, src + d, &z->value[t][0]);
+    }
+
+    z->backward = [=]() {
+        for (int t = 0; t < rows; t++) {
+            const float* g = &z->grad[t][0];
+            float* dst = &table->grad[ids[t]][0];
+            for (int j = 0; j < d; j++) dst[j] += g[j];
+        }
+    };
+    return z;
+}
+
+Node* embedding(Node* tokens, Node* positions, const std::vector<int>& ids) {
+    const int vocab = tokens->value.size();
+    const int d = vocab ? tokens->value[0].size() : 0;
+    if (ids.empty()) throw std::invalid_argument("embedding of an empty id list");
+    const int rows = static_cast<int>(ids.size());
+    if (positions->value.size() < rows || positions->value[0].size() != d)
+        throw std::invalid_argument("Positional table " + shape_of(positions->value) + " cannot cover " +
+                                    std::to_string(rows) + " positions of width " + std::to_string(d));
+    for (int id : ids)
+        if (id < 0 || id >= vocab)
+            throw std::out_of_range("Token id " + std::to_string(id) + " outside embedding table of " +
+                                    std::to_string(vocab));
+
+    Node* z = new Node(matrix(rows, d));
+    z->children.push(tokens);
+    z->children.push(positions);
+    for (int t = 0; t < rows; t++) {
+        const float* tok = &tokens->value[ids[t]][0];
+        const float* pos = &positions->value[t][0];
+        float* out = &z->value[t][0];
+        for (int j = 0; j < d; j++) out[j] = tok[j] + pos[j];
+    }
+
+    z->backward = [=]() {
+        for (int t = 0; t < rows; t++) {
+            const float* g = &z->grad[t][0];
+            float* dtok = &tokens->grad[ids[t]][0];
+            float* dpos = &positions->grad[t][0];
+            for (int j = 0; j < d; j++) {
+                dtok[j] += g[j];
+                dpos[j] += g[j];
+            }
+        }
+    };
+    return z;
+}
+
+// ---------------- RESIDUAL ----------------
+Node* residual(Node* x, Node* fx) {
+    const int rows = x->value.size();
+    const int cols = rows ? x->value[0].size() : 0;
+    if (fx->value.size() != rows || (rows && fx->value[0].size() != cols))
+        throw std::invalid_argument("residual shape mismatch: " + shape_of(x->value) + " + " + shape_of(fx->value));
+
+    Node* z = new Node(matrix(rows, cols));
+    z->children.push(x);
+    z->children.push(fx);
+    for (int i = 0; i < rows; i++) {
+        const float* a = &x->value[i][0];
+        const float* b = &fx->value[i][0];
+        float* out = &z->value[i][0];
+        for (int j = 0; j < cols; j++) out[j] = a[j] + b[j];
+    }
+
+    z->backward = [=]() {
+        for (int i = 0; i < rows; i++) {
+            const float* g = &z->grad[i][0];
+            float* dx = &x->grad[i][0];
+            float* dfx = &fx->grad[i][0];
+            for (int j = 0; j < cols; j++) dx[j] += g[j];
+            for (int j = 0; j < cols; j++) dfx[j] += g[j];
+        }
+    };
+    return z;
+}
@@ -0,0 +1,37 @@
+#ifndef TRANSFORMER_OPS_HPP
+#define TRANSFORMER_OPS_HPP
+
+#include <vector>
+#include "autograd.hpp"
+#include "../math_primitives/activations.hpp"
+
+// ---------------- LAYER NORM ----------------
+// Normalises each row of x (rows x d) to zero mean and unit variance, then
+// scales by gain and shifts by bias (both 1 x d). Mean and variance come
+// from one Welford pass over the row; a second pass normalises, scales and
+// shifts into the output. Only the per-row mean and 1/std are kept. The
+// backward recomputes x_hat from them in two passes per row: the first sums
+// dy * gain and dy * gain * x_hat (and accumulates the gain and bias
+// gradients), the second writes dx.
+Node* layer_norm(Node* x, Node* gain, Node* bias, float eps = 1e-5f);
+
+// ---------------- GELU ----------------
+// Elementwise tanh-approximation GELU using the vectorised kernels
+Node* gelu(Node* x);
+
+// ---------------- EMBEDDING ----------------
+// Row t of the output is row ids[t] of table (vocab x d). This is a gather
+// with no one-hot matrix; backward adds each output row's gradient into its
+// table row.
+Node* embedding(Node* table, const std::vector<int>& ids);
+
+// Token plus positional embedding: row t is tokens[ids[t]] + positions[t],
+// gathered and added in one pass
+Node* embedding(Node* tokens, Node* positions, const std::vector<int>& ids);
+
+// ---------------- RESIDUAL ----------------
+// x + fx for skip connections. Gradients flow to both operands in place,
+// without the temporaries that add() allocates.
+Node* residual(Node* x, Node* fx);
+
+#endif // TRANSFORMER_OPS_HPP
@@ -0,0 +1,138 @@
+#include "transformer_ops.hpp"
+#include "fusion.hpp"
+#include "../math_primitives/gemm.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// The per-token transformer ops against the obvious alternatives:
+//   layer_norm  vs the same LayerNorm as a traced graph of elementwise and
+//               row-mean ops (one kernel per op), outputs and gradients
+//               compared
+//   gelu        vectorised bulk kernel vs the scalar std::tanh loop, with
+//               max error against a double-precision reference
+//   embedding   gather vs one-hot matrix times table
+//
+// usage: transformer_ops_bench [tokens] [width] [vocab] [repeats]
+
+namespace {
+
+void bench_layer_norm(int tokens, int d, int repeats) {
+    Philox gen(21);
+    Node* x = new Node(matrix(tokens, d));
+    Node* gain = new Node(matrix(1, d));
+    Node* bias = new Node(matrix(1, d));
+    x->value.fill_uniform(gen, -2.0f, 3.0f);
+    gain->value.fill_uniform(gen.split(1), 0.5f, 1.5f);
+    bias->value.fill_uniform(gen.split(2), -0.5f, 0.5f);
+    matrix up(tokens, d);
+    up.fill_uniform(gen.split(3), -1.0f, 1.0f);
+    const std::vector<Node*> leaves = {x, gain, bias};
+
+    Trace trace;
+    int tx = trace.input(tokens, d), tg = trace.input(1, d), tb = trace.input(1, d);
+    int centred = trace.sub(tx, trace.row_mean(tx));
+    int inv_std = trace.rsqrt(trace.add_scalar(trace.row_mean(trace.square(centred)), 1e-5f));
+    int out = trace.add(trace.mul(trace.mul(centred, inv_std), tg), tb);
+    FusionPlan plan = plan_kernels(trace, out, false);
+
+    double fused_ms = 0.0, graph_ms = 0.0;
+    matrix grads[2][3], values[2];
+    for (int r = 0; r < repeats; r++) {
+        for (int pass = 0; pass < 2; pass++) {
+            for (Node* n : leaves) n->grad.fill_zeroes();
+            auto start = Clock::now();
+            Node* y = pass == 0 ? layer_norm(x, gain, bias) : execute(trace, plan, leaves);
+            y->grad = up;
+            backward_topological(y);
+            (pass == 0 ? fused_ms : graph_ms) += elapsed_ms(start);
+            values[pass] = y->value;
+            for (int k = 0; k < 3; k++) grads[pass][k] = leaves[k]->grad;
+            free_nodes(y, leaves);
+        }
+    }
+    float diff = max_diff(values[0], values[1]);
+    for (int k = 0; k < 3; k++) diff = std::max(diff, max_diff(grads[0][k], grads[1][k]));
+
+    std::cout << "layer_norm " << tokens << "x" << d << " forward+backward: fused " << fused_ms / repeats
+              << " ms, op-by-op graph (" << plan.kernels.size() << " kernels) " << graph_ms / repeats
+              << " ms, speedup " << graph_ms / fused_ms << "x, max abs difference " << diff << std::endl;
+    for (Node* n : leaves) delete n;
+}
+
+void bench_gelu(std::size_t n, int repeats) {
+    std::vector<float> x(n), fast(n), slow(n), dfast(n, 0.0f), dslow(n, 0.0f), grad(n, 1.0f);
+    Philox(22).fill(x.data(), n, UniformDist{-6.0f, 6.0f});
+
+    auto start = Clock::now();
+    for (int r = 0; r < repeats; r++) gelu(x.data(), fast.data(), n);
+    double fast_ms = elapsed_ms(start) / repeats;
+    start = Clock::now();
+    for (int r = 0; r < repeats; r++)
+        for (std::size_t i = 0; i < n; i++) slow[i] = gelu(x[i]);
+    double slow_ms = elapsed_ms(start) / repeats;
+    gelu_backward(x.data(), grad.data(), dfast.data(), n);
+    for (std::size_t i = 0; i < n; i++) dslow[i] += gelu_grad(x[i]);
+
+    double err = 0.0, grad_err = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        const double v = x[i];
+        const double t = std::tanh(0.7978845608028654 * (v + 0.044715 * v * v * v));
+        const double exact = 0.5 * v * (1.0 + t);
+        err = std::max(err, std::fabs(fast[i] - exact));
+        grad_err = std::max(grad_err, static_cast<double>(std::fabs(dfast[i] - dslow[i])));
+    }
+    std::cout << "gelu " << n << " values: vectorised " << fast_ms << " ms, scalar " << slow_ms << " ms, speedup "
+              << slow_ms / fast_ms << "x, max abs error " << err << ", gradient vs scalar " << grad_err << std::endl;
+}
+
+void bench_embedding(int tokens, int d, int vocab, int repeats) {
+    Philox gen(23);
+    Node* table = new Node(matrix(vocab, d));
+    table->value.fill_uniform(gen, -1.0f, 1.0f);
+    std::vector<int> ids(tokens);
+    for (int t = 0; t < tokens; t++) ids[t] = static_cast<int>(gen.uniform(t, 0.0f, 1.0f) * vocab) % vocab;
+
+    double gather_ms = 0.0, onehot_ms = 0.0;
+    float diff = 0.0f;
+    for (int r = 0; r < repeats; r++) {
+        auto start = Clock::now();
+        Node* z = embedding(table, ids);
+        gather_ms += elapsed_ms(start);
+
+        start = Clock::now();
+        matrix onehot(tokens, vocab);
+        for (int t = 0; t < tokens; t++) onehot[t][ids[t]] = 1.0f;
+        matrix out(tokens, d);
+        gemm(onehot, false, table->value, false, out);
+        onehot_ms += elapsed_ms(start);
+
+        diff = std::max(diff, max_diff(z->value, out));
+        delete z;
+    }
+    std::cout << "embedding " << tokens << " ids from " << vocab << "x" << d << ": gather " << gather_ms / repeats
+              << " ms, one-hot GEMM " << onehot_ms / repeats << " ms, speedup " << onehot_ms / gather_ms
+              << "x, max abs difference " << diff << std::endl;
+    delete table;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int tokens = argc > 1 ? std::stoi(argv[1]) : 256;
+    int d = argc > 2 ? std::stoi(argv[2]) : 512;
+    int vocab = argc > 3 ? std::stoi(argv[3]) : 4096;
+    int repeats = argc > 4 ? std::stoi(argv[4]) : 10;
+
+    try {
+        bench_layer_norm(tokens, d, repeats);
+        bench_gelu(static_cast<std::size_t>(tokens) * d * 4, repeats);
+        bench_embedding(tokens, d, vocab, repeats);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "scheduler.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+// Throughput of continuous batching against static batching on a synthetic
+// workload: prompts of 8..40 tokens, four in five asking for 8..48 new
+// tokens and the rest for max_new/2..max_new, all queued at once and
+// decoded greedily.
+//   static      requests taken max_batch at a time; a batch prefills
+//               together and the next starts only when its longest is done.
+//               Padded, finished sequences keep decoding to the end;
+//               otherwise they drop out of the decode steps. Every slot
+//               keeps a ring for the longest possible sequence.
+//   continuous  the Scheduler over a paged pool, by default half the static
+//               cache's size, so it has to preempt when the pool runs short.
+// Both must produce the same tokens. Each is run several times and the
+// median throughput reported; single runs vary by more than the gaps.
+//
+// usage: batching_bench [requests] [max batch] [max new] [blocks, 0 for half] [width] [runs]
+
+namespace {
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+struct Workload {
+    std::vector<int> prompt;
+    int max_new;
+};
+
+// With pad, finished sequences keep decoding (and their tokens are thrown
+// away) until the batch's longest is done, as Generator::generate does
+std::vector<std::vector<int>> run_static(const GptWeights& weights, const std::vector<Workload>& work,
+                                         int max_batch, int capacity, bool pad, long& steps) {
+    Generator gen(weights, max_batch, capacity);
+    std::vector<std::vector<int>> out(work.size());
+    for (std::size_t start = 0; start < work.size(); start += max_batch) {
+        const int count = static_cast<int>(std::min<std::size_t>(max_batch, work.size() - start));
+        std::vector<TokenInput> inputs;
+        int longest = 0;
+        for (int s = 0; s < count; s++) {
+            gen.reset(s);
+            const std::vector<int>& prompt = work[start + s].prompt;
+            for (std::size_t t = 0; t < prompt.size(); t++) inputs.push_back({s, prompt[t], t + 1 == prompt.size()});
+            longest = std::max(longest, work[start + s].max_new);
+        }
+        std::vector<int> active(count);
+        for (int s = 0; s < count; s++) active[s] = s;
+        for (int produced = 1; !active.empty(); produced++) {
+            const matrix logits = gen.forward(inputs);
+            steps++;
+            std::vector<int> still;
+            for (std::size_t r = 0; r < active.size(); r++) {
+                const int s = active[r];
+                out[start + s].push_back(argmax(&logits[r][0], logits[r].size()));
+                if (produced < (pad ? longest : work[start + s].max_new)) still.push_back(s);
+            }
+            active.swap(still);
+            inputs.clear();
+            for (int s : active) inputs.push_back({s, out[start + s].back(), true});
+        }
+        for (int s = 0; s < count; s++) out[start + s].resize(work[start + s].max_new);
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int requests = argc > 1 ? std::stoi(argv[1]) : 48;
+    const int max_batch = argc > 2 ? std::stoi(argv[2]) : 8;
+    const int max_new = argc > 3 ? std::stoi(argv[3]) : 192;
+    GptConfig config;
+    config.vocab = 1024;
+    config.width = argc > 5 ? std::stoi(argv[5]) : 256;
+    config.layers = 2;
+    config.heads = 4;
+    const int runs = argc > 6 ? std::stoi(argv[6]) : 5;
+
+    try {
+        if (runs < 1) throw std::invalid_argument("runs must be positive");
+        const GptWeights weights = init_gpt(config, Philox(71));
+        Random rng(5);
+        std::vector<Workload> work(requests);
+        long total_new = 0, prompt_tokens = 0;
+        for (Workload& w : work) {
+            const int length = 8 + static_cast<int>(rng.uniform(0.0f, 33.0f));
+            for (int t = 0; t < length; t++)
+                w.prompt.push_back(std::min(config.vocab - 1, static_cast<int>(rng.uniform(0.0f, 1.0f) * config.vocab)));
+            // Mostly short answers with a long tail, as in chat traffic
+            const float u = rng.uniform(0.0f, 1.0f);
+            w.max_new = u < 0.8f ? 8 + static_cast<int>(u / 0.8f * 40.0f)
+                                 : max_new / 2 + static_cast<int>((u - 0.8f) / 0.2f * (max_new / 2));
+            w.max_new = std::min(w.max_new, max_new);
+            total_new += w.max_new;
+            prompt_tokens += length;
+        }
+        const int capacity = 40 + max_new;
+
+        SchedulerConfig sched;
+        sched.max_batch = max_batch;
+        sched.block_size = 16;
+        sched.blocks = argc > 4 && std::stoi(argv[4]) > 0 ? std::stoi(argv[4])
+                                                         : max_batch * capacity / (2 * sched.block_size);
+
+        std::cout << requests << " requests, " << total_new << " new tokens, batch " << max_batch << ", median of "
+                  << runs << " runs" << std::endl;
+        std::cout << "batching | tok/s | steps | cache MB | preemptions | same tokens" << std::endl;
+        const std::size_t ring_bytes = Generator(weights, max_batch, capacity).cache().bytes();
+        std::vector<std::vector<int>> fixed;
+        for (bool pad : {true, false}) {
+            std::vector<double> tok_s;
+            long steps = 0;
+            for (int run = 0; run < runs; run++) {
+                steps = 0;
+                const auto start = Clock::now();
+                fixed = run_static(weights, work, max_batch, capacity, pad, steps);
+                tok_s.push_back(total_new * 1000.0 / elapsed_ms(start));
+            }
+            std::cout << (pad ? "static, padded" : "static, finished dropped") << " | " << median(tok_s) << " | "
+                      << steps << " | " << ring_bytes / (1024.0 * 1024.0) << " | - | -" << std::endl;
+        }
+
+        // A fresh scheduler per run; the last one's counters are reported
+        std::unique_ptr<Scheduler> scheduler;
+        std::vector<std::vector<int>> continuous;
+        std::vector<double> tok_s;
+        for (int run = 0; run < runs; run++) {
+            scheduler = std::make_unique<Scheduler>(weights, sched);
+            continuous.assign(requests, {});
+            for (int i = 0; i < requests; i++)
+                scheduler->submit(work[i].prompt, work[i].max_new, [&continuous, i](const float* logits, int vocab) {
+                    continuous[i].push_back(argmax(logits, vocab));
+                    return continuous[i].back();
+                });
+            const auto start = Clock::now();
+            scheduler->run();
+            tok_s.push_back(total_new * 1000.0 / elapsed_ms(start));
+        }
+
+        int same = 0;
+        for (int i = 0; i < requests; i++) same += fixed[i] == continuous[i];
+        const SchedulerStats& s = scheduler->stats();
+        const KVCache& kv = scheduler->cache();
+        const double block_mb = kv.bytes() / (1024.0 * 1024.0) / kv.blocks();
+        std::cout << "continuous | " << median(tok_s) << " | " << s.steps << " | "
+                  << kv.bytes() / (1024.0 * 1024.0) << " (peak " << s.peak_blocks * block_mb << ") | "
+                  << s.preemptions << " | " << same << "/" << requests << std::endl;
+        std::cout << "continuous ran " << static_cast<double>(s.step_rows) / s.steps << " sequences per step, "
+                  << s.prefilled - prompt_tokens << " prompt tokens recomputed after preemption" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
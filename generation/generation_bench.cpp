@@ -0,0 +1,82 @@
+#include "generator.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// Greedy generation with the KV cache against recomputing the whole prefix
+// for every new token (reset the slot and run the full sequence, taking the
+// last row's logits), at growing sequence lengths. Both must produce the
+// same tokens. Then a batch of prompts with different lengths generated
+// together against the same prompts one at a time.
+//
+// usage: generation_bench [max length] [width] [layers] [batch]
+
+namespace {
+
+std::vector<int> recompute(Generator& gen, std::vector<int> tokens, int length) {
+    while (static_cast<int>(tokens.size()) < length) {
+        gen.reset(0);
+        std::vector<TokenInput> batch;
+        for (std::size_t t = 0; t < tokens.size(); t++) batch.push_back({0, tokens[t], t + 1 == tokens.size()});
+        matrix logits = gen.forward(batch);
+        tokens.push_back(argmax(&logits[0][0], logits[0].size()));
+    }
+    return tokens;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int max_length = argc > 1 ? std::stoi(argv[1]) : 256;
+    GptConfig config;
+    config.vocab = 1024;
+    config.width = argc > 2 ? std::stoi(argv[2]) : 128;
+    config.layers = argc > 3 ? std::stoi(argv[3]) : 2;
+    config.heads = 4;
+    int batch = argc > 4 ? std::stoi(argv[4]) : 8;
+
+    try {
+        GptWeights weights = init_gpt(config, Philox(71));
+        Generator gen(weights, batch, max_length);
+        std::cout << "width " << config.width << ", " << config.layers << " layers, cache "
+                  << gen.cache().bytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+        std::cout << "length | cached tok/s | recompute tok/s | speedup | same tokens" << std::endl;
+
+        const std::vector<int> prompt = {1, 2, 3, 4};
+        for (int length = 32; length <= max_length; length *= 2) {
+            const int produced = length - static_cast<int>(prompt.size());
+            auto start = Clock::now();
+            std::vector<int> cached = gen.generate({prompt}, produced)[0];
+            const double cached_ms = elapsed_ms(start);
+            start = Clock::now();
+            std::vector<int> naive = recompute(gen, prompt, length);
+            const double naive_ms = elapsed_ms(start);
+            std::cout << length << " | " << produced * 1000.0 / cached_ms << " | " << produced * 1000.0 / naive_ms
+                      << " | " << naive_ms / cached_ms << "x | " << (cached == naive ? "yes" : "NO") << std::endl;
+        }
+
+        // Prompts of 4, 8, 12, ... tokens, all continued to the same count
+        std::vector<std::vector<int>> prompts(batch);
+        for (int s = 0; s < batch; s++)
+            for (int t = 0; t < 4 * (s + 1); t++) prompts[s].push_back((7 * s + 13 * t) % config.vocab);
+        const int new_tokens = std::max(1, max_length - 4 * batch);
+
+        auto start = Clock::now();
+        std::vector<std::vector<int>> together = gen.generate(prompts, new_tokens);
+        const double together_ms = elapsed_ms(start);
+        start = Clock::now();
+        bool same = true;
+        for (int s = 0; s < batch; s++) same = same && gen.generate({prompts[s]}, new_tokens)[0] == together[s];
+        const double apart_ms = elapsed_ms(start);
+        const double tokens = static_cast<double>(batch) * new_tokens;
+        std::cout << batch << " prompts of 4.." << 4 * batch << " tokens, " << new_tokens
+                  << " new each: batched " << tokens * 1000.0 / together_ms << " tok/s, one at a time "
+                  << tokens * 1000.0 / apart_ms << " tok/s, speedup " << apart_ms / together_ms << "x, same tokens "
+                  << (same ? "yes" : "NO") << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
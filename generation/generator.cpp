@@ -0,0 +1,203 @@
+#include "generator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::vector<const float*> row_pointers(const matrix& m) {
+    std::vector<const float*> rows(m.size());
+    for (int i = 0; i < m.size(); i++) rows[i] = &m[i][0];
+    return rows;
+}
+
+int next_token(const mathVector& logits, Sampler* sampler) {
+    return sampler ? sampler->sample(&logits[0], logits.size()) : argmax(&logits[0], logits.size());
+}
+
+} // namespace
+
+// ---------------- GENERATOR ----------------
+void Generator::Buffer::resize(int n, int c) {
+    cols = c;
+    if (data.size() < static_cast<std::size_t>(n) * c) data.resize(static_cast<std::size_t>(n) * c);
+    rows.resize(n);
+    for (int i = 0; i < n; i++) rows[i] = data.data() + static_cast<std::size_t>(i) * c;
+}
+
+Generator::Generator(const GptWeights& weights, int slots, int capacity)
+    : Generator(weights,
+                KVCache(weights.config.layers, slots, weights.config.heads, weights.config.head_dim(), capacity)) {}
+
+Generator::Generator(const GptWeights& weights, KVCache cache)
+    : weights(weights), kv(std::move(cache)), scores(kv.capacity()) {
+    if (kv.layers() != weights.config.layers || kv.heads() != weights.config.heads ||
+        kv.head_dim() != weights.config.head_dim())
+        throw std::invalid_argument("KVCache shape does not match the model");
+    token_rows = row_pointers(weights.tokens);
+    for (const LayerWeights& layer : weights.layers)
+        layer_rows.push_back({row_pointers(layer.wqkv), row_pointers(layer.wo), row_pointers(layer.w1),
+                              row_pointers(layer.w2)});
+}
+
+// Writes the token's key and value at position, then softmax(q K^T / sqrt(dh)) V
+// over the slot's window for every head. Tokens of a slot are handled in
+// position order, so a ring row is only overwritten once no later token in
+// the batch can still see it. Keys and values are read a contiguous run
+// (the rest of a block or ring) at a time.
+void Generator::attend(int layer, int slot, int position, const float* row, float* out) {
+    const int w = weights.config.width, heads = weights.config.heads, dh = weights.config.head_dim();
+    const float scale = 1.0f / std::sqrt(static_cast<float>(dh));
+    const int first = std::max(0, position - kv.capacity() + 1);
+    const int span = position - first + 1;
+    for (int hd = 0; hd < heads; hd++) {
+        const float* q = row + hd * dh;
+        std::copy(row + w + hd * dh, row + w + (hd + 1) * dh, kv.key(layer, slot, hd, position));
+        std::copy(row + 2 * w + hd * dh, row + 2 * w + (hd + 1) * dh, kv.value(layer, slot, hd, position));
+
+        float mx = -std::numeric_limits<float>::infinity();
+        for (int t = 0; t < span;) {
+            const int run = std::min(span - t, kv.contiguous(first + t));
+            const float* k = kv.key(layer, slot, hd, first + t);
+            for (int r = 0; r < run; r++, t++) {
+                scores[t] = dot(q, k + r * dh, dh) * scale;
+                mx = std::max(mx, scores[t]);
+            }
+        }
+        float sum = 0.0f;
+        for (int t = 0; t < span; t++) sum += scores[t] = std::exp(scores[t] - mx);
+
+        float* o = out + hd * dh;
+        std::fill(o, o + dh, 0.0f);
+        for (int t = 0; t < span;) {
+            const int run = std::min(span - t, kv.contiguous(first + t));
+            const float* v = kv.value(layer, slot, hd, first + t);
+            for (int r = 0; r < run; r++, t++) {
+                axpy(scores[t] / sum, v + r * dh, o, dh);
+            }
+        }
+    }
+}
+
+matrix Generator::forward(const std::vector<TokenInput>& inputs) {
+    const GptConfig& cfg = weights.config;
+    const int n = static_cast<int>(inputs.size());
+    const int w = cfg.width;
+    if (n == 0) throw std::invalid_argument("Generator::forward of an empty batch");
+
+    std::vector<int> fed(kv.slots(), 0), positions(n);
+    int wanted = 0;
+    for (int i = 0; i < n; i++) {
+        const TokenInput& in = inputs[i];
+        if (in.slot < 0 || in.slot >= kv.slots())
+            throw std::out_of_range("Cache slot " + std::to_string(in.slot) + " outside " +
+                                    std::to_string(kv.slots()));
+        if (in.token < 0 || in.token >= cfg.vocab)
+            throw std::out_of_range("Token id " + std::to_string(in.token) + " outside vocabulary of " +
+                                    std::to_string(cfg.vocab));
+        if (fed[in.slot] == kv.capacity())
+            throw std::invalid_argument("More than " + std::to_string(kv.capacity()) + " tokens for slot " +
+                                        std::to_string(in.slot) + " in one step");
+        positions[i] = kv.length(in.slot) + fed[in.slot]++;
+        wanted += in.logits;
+    }
+    for (int s = 0; s < kv.slots(); s++)
+        if (fed[s] && !kv.reserve(s, kv.length(s) + fed[s]))
+            throw std::runtime_error("KV block pool exhausted: slot " + std::to_string(s) + " needs room for " +
+                                     std::to_string(kv.length(s) + fed[s]) + " positions");
+
+    x.resize(n, w);
+    h.resize(n, w);
+    qkv.resize(n, 3 * w);
+    attn.resize(n, w);
+    hidden.resize(n, 4 * w);
+    for (int i = 0; i < n; i++) {
+        std::copy(token_rows[inputs[i].token], token_rows[inputs[i].token] + w, x.row(i));
+        add_position(positions[i], w, x.row(i));
+    }
+
+    for (int l = 0; l < cfg.layers; l++) {
+        const LayerWeights& lw = weights.layers[l];
+        const LayerRows& lr = layer_rows[l];
+
+        GemmEpilogue proj;
+        proj.bias = &lw.bqkv[0][0];
+        for (int i = 0; i < n; i++) layer_norm_row(x.row(i), &lw.ln1_gain[0][0], &lw.ln1_bias[0][0], h.row(i), w);
+        gemm(n, 3 * w, w, h.rows.data(), false, lr.wqkv.data(), false, qkv.rows.data(), proj);
+        for (int i = 0; i < n; i++) attend(l, inputs[i].slot, positions[i], qkv.row(i), attn.row(i));
+
+        GemmEpilogue residual;
+        residual.accumulate = true;
+        residual.bias = &lw.bo[0][0];
+        gemm(n, w, w, attn.rows.data(), false, lr.wo.data(), false, x.rows.data(), residual);
+
+        GemmEpilogue up;
+        up.bias = &lw.b1[0][0];
+        up.activation = Activation::GELU;
+        for (int i = 0; i < n; i++) layer_norm_row(x.row(i), &lw.ln2_gain[0][0], &lw.ln2_bias[0][0], h.row(i), w);
+        gemm(n, 4 * w, w, h.rows.data(), false, lr.w1.data(), false, hidden.rows.data(), up);
+        residual.bias = &lw.b2[0][0];
+        gemm(n, w, 4 * w, hidden.rows.data(), false, lr.w2.data(), false, x.rows.data(), residual);
+    }
+    for (int s = 0; s < kv.slots(); s++)
+        if (fed[s]) kv.advance(s, fed[s]);
+
+    // Final LayerNorm and the tied unembedding, for the flagged rows only
+    matrix logits(wanted, cfg.vocab);
+    if (wanted == 0) return logits;
+    std::vector<float*> out_rows(wanted);
+    for (int i = 0, r = 0; i < n; i++) {
+        if (!inputs[i].logits) continue;
+        layer_norm_row(x.row(i), &weights.lnf_gain[0][0], &weights.lnf_bias[0][0], h.row(r), w);
+        out_rows[r] = &logits[r][0];
+        r++;
+    }
+    gemm(wanted, cfg.vocab, w, h.rows.data(), false, token_rows.data(), true, out_rows.data());
+    return logits;
+}
+
+std::vector<std::vector<int>> Generator::generate(const std::vector<std::vector<int>>& prompts, int new_tokens,
+                                                  Sampler* sampler) {
+    const int count = static_cast<int>(prompts.size());
+    if (count > kv.slots())
+        throw std::invalid_argument(std::to_string(count) + " prompts for " + std::to_string(kv.slots()) +
+                                    " cache slots");
+    std::size_t longest = 0;
+    for (int s = 0; s < count; s++) {
+        if (prompts[s].empty()) throw std::invalid_argument("Empty prompt " + std::to_string(s));
+        longest = std::max(longest, prompts[s].size());
+        kv.reset(s);
+    }
+
+    std::vector<std::vector<int>> out = prompts;
+    if (new_tokens <= 0 || count == 0) return out;
+
+    // Prefill in chunks of at most capacity tokens per prompt; the last
+    // prompt token's logits give the first generated token
+    const std::size_t chunk = kv.capacity();
+    for (std::size_t start = 0; start < longest; start += chunk) {
+        std::vector<TokenInput> batch;
+        std::vector<int> owners;
+        for (int s = 0; s < count; s++) {
+            const std::size_t end = std::min(prompts[s].size(), start + chunk);
+            for (std::size_t t = start; t < end; t++) {
+                const bool last = t + 1 == prompts[s].size();
+                batch.push_back({s, prompts[s][t], last});
+                if (last) owners.push_back(s);
+            }
+        }
+        matrix logits = forward(batch);
+        for (int r = 0; r < logits.size(); r++) out[owners[r]].push_back(next_token(logits[r], sampler));
+    }
+
+    std::vector<TokenInput> step(count);
+    for (int t = 1; t < new_tokens; t++) {
+        for (int s = 0; s < count; s++) step[s] = {s, out[s].back(), true};
+        matrix logits = forward(step);
+        for (int s = 0; s < count; s++) out[s].push_back(next_token(logits[s], sampler));
+    }
+    return out;
+}
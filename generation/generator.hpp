@@ -0,0 +1,77 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <vector>
+#include "model.hpp"
+#include "kv_cache.hpp"
+#include "sampling.hpp"
+
+// One new token for a cache slot. logits asks for its next-token logits;
+// prompt tokens other than the last don't need them.
+struct TokenInput {
+    int slot;
+    int token;
+    bool logits;
+};
+
+// ---------------- GENERATOR ----------------
+// Inference-only forward pass over a KVCache. A step runs only the new
+// tokens: their embeddings, LayerNorms, projections and MLPs are GEMMs over
+// just those rows, and each new token's keys and values are appended to its
+// slot's ring before it attends over the slot's window. Prefill and decode
+// are the same call. A batch can mix slots at different lengths, and any
+// number of tokens per slot up to the cache capacity.
+//
+// Activations live in scratch buffers owned by the generator and reused
+// across steps; the cache is the only per-sequence state.
+class Generator {
+public:
+    // weights must outlive the generator. The first form gives every slot a
+    // ring of capacity positions; the second runs over any cache shaped for
+    // the model, such as a KVCache::paged pool.
+    Generator(const GptWeights& weights, int slots, int capacity);
+    Generator(const GptWeights& weights, KVCache cache);
+
+    // Feeds inputs in order; tokens of one slot take consecutive positions.
+    // Returns one vocab-wide row of logits per input flagged logits, in
+    // input order.
+    matrix forward(const std::vector<TokenInput>& inputs);
+
+    void reset(int slot) { kv.reset(slot); }
+    // Room for positions [0, positions) of slot; see KVCache::reserve.
+    // forward() reserves what it writes and throws if the pool runs dry.
+    bool reserve(int slot, int positions) { return kv.reserve(slot, positions); }
+    const KVCache& cache() const { return kv; }
+
+    // Continues each prompt by new_tokens tokens, drawn by sampler or greedily
+    // when it is null. Prompt i uses slot i; all prompts are prefilled
+    // together and then decoded one token per sequence per step.
+    std::vector<std::vector<int>> generate(const std::vector<std::vector<int>>& prompts, int new_tokens,
+                                           Sampler* sampler = nullptr);
+
+private:
+    // rows x cols floats with a pointer per row for gemm
+    struct Buffer {
+        std::vector<float> data;
+        std::vector<float*> rows;
+        int cols = 0;
+
+        void resize(int n, int c);
+        float* row(int i) { return rows[i]; }
+    };
+
+    struct LayerRows {
+        std::vector<const float*> wqkv, wo, w1, w2;
+    };
+
+    void attend(int layer, int slot, int position, const float* row, float* out);
+
+    const GptWeights& weights;
+    KVCache kv;
+    std::vector<LayerRows> layer_rows;
+    std::vector<const float*> token_rows;
+    Buffer x, h, qkv, attn, hidden;
+    std::vector<float> scores;
+};
+
+#endif // GENERATOR_HPP
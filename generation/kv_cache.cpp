@@ -0,0 +1,57 @@
+#include "kv_cache.hpp"
+#include <stdexcept>
+#include <string>
+
+// ---------------- KV CACHE ----------------
+KVCache::KVCache(int layers, int slots, int heads, int head_dim, int capacity)
+    : KVCache(layers, slots, heads, head_dim, capacity, slots, false) {}
+
+KVCache KVCache::paged(int layers, int slots, int heads, int head_dim, int block_size, int blocks) {
+    return KVCache(layers, slots, heads, head_dim, block_size, blocks, true);
+}
+
+KVCache::KVCache(int layers, int slots, int heads, int head_dim, int block_size, int blocks, bool paged)
+    : depth(layers), head_count(heads), dh(head_dim), block_rows(block_size), block_count(blocks), is_paged(paged) {
+    if (layers <= 0 || slots <= 0 || heads <= 0 || head_dim <= 0 || block_size <= 0 || blocks <= 0)
+        throw std::invalid_argument("KVCache needs positive dimensions");
+    lengths.assign(slots, 0);
+    if (paged) {
+        tables.resize(slots);
+        // Handed out from the back, so low blocks go first
+        for (int b = blocks - 1; b >= 0; b--) free_list.push_back(b);
+    }
+    const std::size_t floats = static_cast<std::size_t>(layers) * blocks * heads * block_size * head_dim;
+    keys.assign(floats, 0.0f);
+    values.assign(floats, 0.0f);
+}
+
+bool KVCache::reserve(int slot, int positions) {
+    if (slot < 0 || slot >= slots())
+        throw std::out_of_range("Cache slot " + std::to_string(slot) + " outside " + std::to_string(slots()));
+    if (!is_paged) return true;
+    std::vector<int>& table = tables[slot];
+    const std::size_t needed = (static_cast<std::size_t>(positions) + block_rows - 1) / block_rows;
+    if (needed <= table.size()) return true;
+    if (needed - table.size() > free_list.size()) return false;
+    while (table.size() < needed) {
+        table.push_back(free_list.back());
+        free_list.pop_back();
+    }
+    return true;
+}
+
+void KVCache::advance(int slot, int positions) {
+    if (slot < 0 || slot >= slots())
+        throw std::out_of_range("Cache slot " + std::to_string(slot) + " outside " + std::to_string(slots()));
+    lengths[slot] += positions;
+}
+
+void KVCache::reset(int slot) {
+    if (slot < 0 || slot >= slots())
+        throw std::out_of_range("Cache slot " + std::to_string(slot) + " outside " + std::to_string(slots()));
+    lengths[slot] = 0;   // stale rows are never read: attention stops at the window
+    if (is_paged) {
+        free_list.insert(free_list.end(), tables[slot].rbegin(), tables[slot].rend());
+        tables[slot].clear();
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef KV_CACHE_HPP
+#define KV_CACHE_HPP
+
+#include <cstddef>
+#include <vector>
+
+// ---------------- KV CACHE ----------------
+// Attention keys and values of every layer for up to `slots` sequences, in
+// two allocations made up front and cut into blocks. A block holds
+// block_size positions of every layer and head; within it a head's keys
+// are contiguous, which is the order attention reads them in.
+//
+// The constructor gives each slot one block of `capacity` rows for good and
+// treats it as a ring: position p lives in row p % capacity, so a sequence
+// that outgrows the ring keeps attending to its most recent `capacity`
+// positions (a sliding window) without moving data.
+//
+// paged() instead makes a shared pool of small blocks. A slot takes blocks
+// from the pool only as reserve() asks for them and gives them all back on
+// reset(), so short sequences hold little memory and a finished sequence's
+// blocks serve any other, wherever they lie. Positions never wrap: a paged
+// slot holds its whole sequence or reserve() fails.
+class KVCache {
+public:
+    KVCache(int layers, int slots, int heads, int head_dim, int capacity);
+    static KVCache paged(int layers, int slots, int heads, int head_dim, int block_size, int blocks);
+
+    int layers() const { return depth; }
+    int heads() const { return head_count; }
+    int head_dim() const { return dh; }
+    int slots() const { return static_cast<int>(lengths.size()); }
+    // Most positions one slot can hold: the ring, or the whole pool
+    int capacity() const { return is_paged ? block_rows * block_count : block_rows; }
+
+    // Positions fed to slot so far, and how many of them are still held
+    int length(int slot) const { return lengths.at(slot); }
+    int window(int slot) const { return lengths.at(slot) < capacity() ? lengths.at(slot) : capacity(); }
+
+    // Row for position in the slot's storage; the position must be in the
+    // window or the next one about to be written (reserved, when paged)
+    float* key(int layer, int slot, int head, int position) { return keys.data() + offset(layer, slot, head, position); }
+    float* value(int layer, int slot, int head, int position) {
+        return values.data() + offset(layer, slot, head, position);
+    }
+    const float* key(int layer, int slot, int head, int position) const {
+        return keys.data() + offset(layer, slot, head, position);
+    }
+    const float* value(int layer, int slot, int head, int position) const {
+        return values.data() + offset(layer, slot, head, position);
+    }
+    // Rows from position up to the end of its block (or ring) lie adjacent
+    // in memory, so readers can step through them with a pointer
+    int contiguous(int position) const { return block_rows - position % block_rows; }
+
+    // Makes room for positions [0, positions) of slot. A ring always has
+    // room; a paged slot takes the blocks it lacks from the pool, or takes
+    // none and returns false when the pool can't cover them all.
+    bool reserve(int slot, int positions);
+    void advance(int slot, int positions);
+    // Forgets the slot's positions; a paged slot returns its blocks
+    void reset(int slot);
+
+    bool paged() const { return is_paged; }
+    int block_size() const { return block_rows; }
+    int blocks() const { return block_count; }
+    int free_blocks() const { return static_cast<int>(free_list.size()); }
+    std::size_t bytes() const { return (keys.size() + values.size()) * sizeof(float); }
+
+private:
+    KVCache(int layers, int slots, int heads, int head_dim, int block_size, int blocks, bool paged);
+
+    std::size_t offset(int layer, int slot, int head, int position) const {
+        const int block = is_paged ? tables[slot][position / block_rows] : slot;
+        const std::size_t ring_index = (static_cast<std::size_t>(block) * depth + layer) * head_count + head;
+        return (ring_index * block_rows + position % block_rows) * dh;
+    }
+
+    int depth;
+    int head_count;
+    int dh;
+    int block_rows;
+    int block_count;
+    bool is_paged;
+    std::vector<int> lengths;
+    std::vector<std::vector<int>> tables;   // paged: each slot's blocks in position order
+    std::vector<int> free_list;
+    std::vector<float> keys;     // blocks x layers x heads x block_size x head_dim
+    std::vector<float> values;
+};
+
+#endif // KV_CACHE_HPP
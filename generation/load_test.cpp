@@ -0,0 +1,172 @@
+#include "server.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Closed-loop load test: each client thread holds one connection and sends
+// GEN requests with random prompts back to back, timing the first TOK and
+// the END of each. Reports client-side latency percentiles and throughput,
+// then the server's own STATS line.
+//
+// Given a socket path it drives a running server (see serve.cpp). Without
+// one it starts servers in this process on a small model, first with
+// max_batch 1 (every request alone) and then with batching, to show what
+// coalescing buys.
+//
+// usage: load_test [socket path|-] [clients] [requests per client] [new tokens]
+
+namespace {
+
+// Retries while an in-process server is still binding
+int connect_to(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) throw std::invalid_argument("Socket path too long: " + path);
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    for (int attempt = 0; attempt < 200; attempt++) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) throw std::runtime_error("socket failed");
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) return fd;
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    throw std::runtime_error("Cannot connect to " + path);
+}
+
+struct ClientResult {
+    std::vector<double> latency, first_token;
+    long tokens = 0;
+    std::string error;
+};
+
+void client(const std::string& path, int id, int requests, int new_tokens, int vocab, ClientResult& result) {
+    try {
+        const int fd = connect_to(path);
+        LineReader reader(fd);
+        Random rng(1000 + id);
+        std::string line;
+        for (int r = 0; r < requests; r++) {
+            std::ostringstream request;
+            request << "GEN " << new_tokens << " 0.8 40 0.95 " << id * requests + r;
+            const int length = 8 + static_cast<int>(rng.uniform(0.0f, 24.0f));
+            for (int t = 0; t < length; t++)
+                request << ' ' << std::min(vocab - 1, static_cast<int>(rng.uniform(0.0f, 1.0f) * vocab));
+            request << '\n';
+
+            const auto start = Clock::now();
+            if (!send_all(fd, request.str())) throw std::runtime_error("Server closed the connection");
+            bool first = true;
+            while (reader.next(line)) {
+                if (line.compare(0, 4, "TOK ") == 0) {
+                    if (first) result.first_token.push_back(elapsed_ms(start));
+                    first = false;
+                    result.tokens++;
+                } else if (line.compare(0, 4, "END ") == 0) {
+                    break;
+                } else {
+                    throw std::runtime_error("Unexpected reply: " + line);
+                }
+            }
+            result.latency.push_back(elapsed_ms(start));
+        }
+        ::close(fd);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<std::size_t>(std::ceil(p * values.size())) - 1)];
+}
+
+std::string server_stats(const std::string& path) {
+    const int fd = connect_to(path);
+    LineReader reader(fd);
+    std::string line;
+    send_all(fd, "STATS\n");
+    reader.next(line);
+    ::close(fd);
+    return line;
+}
+
+void load(const std::string& path, int clients, int requests, int new_tokens, int vocab) {
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for (int c = 0; c < clients; c++)
+        threads.emplace_back(client, path, c, requests, new_tokens, vocab, std::ref(results[c]));
+    for (std::thread& t : threads) t.join();
+    const double total_ms = elapsed_ms(start);
+
+    std::vector<double> latency, first_token;
+    long tokens = 0;
+    for (const ClientResult& r : results) {
+        if (!r.error.empty()) throw std::runtime_error(r.error);
+        latency.insert(latency.end(), r.latency.begin(), r.latency.end());
+        first_token.insert(first_token.end(), r.first_token.begin(), r.first_token.end());
+        tokens += r.tokens;
+    }
+    std::cout << clients << " clients x " << requests << " requests: latency p50 " << percentile(latency, 0.5)
+              << " ms p99 " << percentile(latency, 0.99) << " ms, first token p50 " << percentile(first_token, 0.5)
+              << " ms p99 " << percentile(first_token, 0.99) << " ms, " << latency.size() * 1000.0 / total_ms
+              << " req/s, " << tokens * 1000.0 / total_ms << " tok/s" << std::endl;
+    std::cout << "  server " << server_stats(path) << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string path = argc > 1 ? argv[1] : "-";
+    const int clients = argc > 2 ? std::stoi(argv[2]) : 8;
+    const int requests = argc > 3 ? std::stoi(argv[3]) : 8;
+    const int new_tokens = argc > 4 ? std::stoi(argv[4]) : 32;
+
+    try {
+        if (path != "-") {
+            // The vocabulary isn't known from outside; stay inside the default
+            load(path, clients, requests, new_tokens, GptConfig().vocab);
+            return 0;
+        }
+
+        GptConfig model;
+        model.vocab = 1024;
+        model.width = 128;
+        model.layers = 2;
+        const GptWeights weights = init_gpt(model, Philox(71));
+        for (int max_batch : {1, clients}) {
+            ServerConfig config;
+            config.socket_path = "/tmp/llm-from-scratch-load-test-" + std::to_string(::getpid()) + ".sock";
+            config.max_batch = max_batch;
+            InferenceServer server(weights, config);
+            std::thread serving([&] {
+                try {
+                    server.run();
+                } catch (const std::exception& e) {
+                    std::cerr << "Server error: " << e.what() << std::endl;
+                }
+            });
+            std::cout << "max_batch " << max_batch << ", wait " << config.max_wait_us << " us" << std::endl;
+            try {
+                load(config.socket_path, clients, requests, new_tokens, model.vocab);
+            } catch (...) {
+                server.stop();
+                serving.join();
+                throw;
+            }
+            server.stop();
+            serving.join();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
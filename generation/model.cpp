@@ -0,0 +1,121 @@
+#include "model.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+matrix gains(int cols) {
+    matrix m(1, cols);
+    for (int j = 0; j < cols; j++) m[0][j] = 1.0f;
+    return m;
+}
+
+matrix xavier(const Philox& gen, int rows, int cols) {
+    matrix m(rows, cols);
+    m.fill_xavier(gen, rows, cols);
+    return m;
+}
+
+// Every matrix of the model in checkpoint order
+template <typename Weights, typename F>
+void for_each_matrix(Weights& g, F f) {
+    f(g.tokens);
+    for (auto& layer : g.layers) {
+        for (auto* m : {&layer.ln1_gain, &layer.ln1_bias, &layer.wqkv, &layer.bqkv, &layer.wo, &layer.bo,
+                        &layer.ln2_gain, &layer.ln2_bias, &layer.w1, &layer.b1, &layer.w2, &layer.b2})
+            f(*m);
+    }
+    f(g.lnf_gain);
+    f(g.lnf_bias);
+}
+
+} // namespace
+
+GptWeights init_gpt(const GptConfig& config, const Philox& gen) {
+    if (config.vocab <= 0 || config.layers <= 0 || config.heads <= 0 || config.width <= 0 ||
+        config.width % config.heads != 0)
+        throw std::invalid_argument("GPT width " + std::to_string(config.width) + " does not split into " +
+                                    std::to_string(config.heads) + " heads");
+    const int w = config.width;
+
+    GptWeights g;
+    g.config = config;
+    g.tokens = matrix(config.vocab, w);
+    g.tokens.fill_normal(gen, 0.0f, 0.02f);
+    for (int l = 0; l < config.layers; l++) {
+        // Streams 1 + 4l .. 4 + 4l, one per weight matrix of the layer
+        const std::uint64_t s = 1 + 4 * static_cast<std::uint64_t>(l);
+        LayerWeights layer;
+        layer.ln1_gain = gains(w);
+        layer.ln1_bias = matrix(1, w);
+        layer.wqkv = xavier(gen.split(s), w, 3 * w);
+        layer.bqkv = matrix(1, 3 * w);
+        layer.wo = xavier(gen.split(s + 1), w, w);
+        layer.bo = matrix(1, w);
+        layer.ln2_gain = gains(w);
+        layer.ln2_bias = matrix(1, w);
+        layer.w1 = xavier(gen.split(s + 2), w, 4 * w);
+        layer.b1 = matrix(1, 4 * w);
+        layer.w2 = xavier(gen.split(s + 3), 4 * w, w);
+        layer.b2 = matrix(1, w);
+        g.layers.push_back(layer);
+    }
+    g.lnf_gain = gains(w);
+    g.lnf_bias = matrix(1, w);
+    return g;
+}
+
+void add_position(int position, int width, float* out) {
+    // PE(p, 2i) = sin(p / 10000^(2i / width)), PE(p, 2i + 1) = cos(...)
+    for (int j = 0; j + 1 < width; j += 2) {
+        const double angle = position * std::pow(10000.0, -static_cast<double>(j) / width);
+        out[j] += static_cast<float>(std::sin(angle));
+        out[j + 1] += static_cast<float>(std::cos(angle));
+    }
+    if (width % 2) out[width - 1] += static_cast<float>(std::sin(position * std::pow(10000.0, -(width - 1.0) / width)));
+}
+
+void save_gpt(const GptWeights& weights, const std::string& filename) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot open " + filename + " for writing");
+    const GptConfig& c = weights.config;
+    const int header[4] = {c.vocab, c.layers, c.heads, c.width};
+    out.write("GPT1", 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for_each_matrix(weights, [&](const matrix& m) {
+        const int dims[2] = {m.size(), m.size() ? m[0].size() : 0};
+        out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+        for (int i = 0; i < dims[0]; i++) out.write(reinterpret_cast<const char*>(&m[i][0]), dims[1] * sizeof(float));
+    });
+    if (!out) throw std::runtime_error("Failed writing " + filename);
+}
+
+GptWeights load_gpt(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open " + filename + " for reading");
+    char magic[4];
+    int header[4];
+    in.read(magic, 4);
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || std::memcmp(magic, "GPT1", 4) != 0) throw std::runtime_error(filename + " is not a GPT checkpoint");
+
+    GptConfig config;
+    config.vocab = header[0];
+    config.layers = header[1];
+    config.heads = header[2];
+    config.width = header[3];
+    // Shapes come from the config; the stored dims must agree with them
+    GptWeights g = init_gpt(config, Philox(0));
+    for_each_matrix(g, [&](matrix& m) {
+        int dims[2];
+        in.read(reinterpret_cast<char*>(dims), sizeof(dims));
+        if (!in || dims[0] != m.size() || dims[1] != (m.size() ? m[0].size() : 0))
+            throw std::runtime_error(filename + ": matrix shape does not match its config");
+        for (int i = 0; i < dims[0]; i++) in.read(reinterpret_cast<char*>(&m[i][0]), dims[1] * sizeof(float));
+    });
+    if (!in) throw std::runtime_error(filename + " is truncated");
+    return g;
+}
@@ -0,0 +1,54 @@
+#ifndef MODEL_HPP
+#define MODEL_HPP
+
+#include <string>
+#include <vector>
+#include "../math_primitives/gemm.hpp"
+#include "../math_primitives/random.hpp"
+
+// ---------------- GPT CONFIG ----------------
+struct GptConfig {
+    int vocab = 2048;
+    int layers = 4;
+    int heads = 4;
+    int width = 256;   // heads * head_dim
+
+    int head_dim() const { return width / heads; }
+};
+
+// ---------------- GPT WEIGHTS ----------------
+// Decoder-only pre-LayerNorm transformer. Each layer computes
+//   x += attention(ln1(x)) * wo + bo
+//   x += gelu(ln2(x) * w1 + b1) * w2 + b2
+// with q | k | v from one width x 3*width projection. Logits are
+// lnf(x) * tokens^T (the unembedding is tied to the token embedding).
+// Positions are sinusoidal rather than a learned table, so no table bounds
+// how far a sequence can run.
+struct LayerWeights {
+    matrix ln1_gain, ln1_bias;   // 1 x width
+    matrix wqkv, bqkv;           // width x 3*width, 1 x 3*width
+    matrix wo, bo;               // width x width, 1 x width
+    matrix ln2_gain, ln2_bias;   // 1 x width
+    matrix w1, b1;               // width x 4*width, 1 x 4*width
+    matrix w2, b2;               // 4*width x width, 1 x width
+};
+
+struct GptWeights {
+    GptConfig config;
+    matrix tokens;               // vocab x width
+    std::vector<LayerWeights> layers;
+    matrix lnf_gain, lnf_bias;   // 1 x width
+};
+
+// Xavier-initialised weights, zero biases and unit LayerNorm gains
+GptWeights init_gpt(const GptConfig& config, const Philox& gen);
+
+// Single-file checkpoint: "GPT1", the four config ints, then every matrix
+// in declaration order as rows, cols and row-major floats (MatrixIO's layout)
+void save_gpt(const GptWeights& weights, const std::string& filename);
+GptWeights load_gpt(const std::string& filename);
+
+// out[0..width) += the sinusoidal encoding of position
+void add_position(int position, int width, float* out);
+
+#endif // MODEL_HPP
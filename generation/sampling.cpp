@@ -0,0 +1,162 @@
+#include "sampling.hpp"
+#include "../math_primitives/activations.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr int BUCKETS = 1024;
+constexpr float BUCKET_SCALE = 64.0f;   // buckets per logit below the max; past 16 all share the last
+constexpr int HEAP_MAX_K = 256;         // larger k goes through nth_element
+
+// Larger value first, lower id on ties, so selections are deterministic
+bool better(const std::pair<float, int>& a, const std::pair<float, int>& b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+int bucket_of(float distance) {
+    const float b = distance * BUCKET_SCALE;
+    return b < BUCKETS - 1 ? static_cast<int>(b) : BUCKETS - 1;
+}
+
+} // namespace
+
+int argmax(const float* logits, int n) {
+    int best = 0;
+    float value = logits[0];
+    for (int i = 1; i < n; i++)
+        if (logits[i] > value) {
+            value = logits[i];
+            best = i;
+        }
+    return best;
+}
+
+// ---------------- SAMPLER ----------------
+Sampler::Sampler(const SamplingParams& params, unsigned int seed)
+    : settings(params), rng(seed), bucket_mass(BUCKETS) {
+    if (params.top_k < 0) throw std::invalid_argument("top_k must be non-negative, got " + std::to_string(params.top_k));
+    if (!(params.top_p > 0.0f && params.top_p <= 1.0f))
+        throw std::invalid_argument("top_p must be in (0, 1], got " + std::to_string(params.top_p));
+}
+
+int Sampler::sample(const float* logits, int n) {
+    const std::vector<Candidate>& c = candidates(logits, n);
+    const float u = rng.uniform(0.0f, 1.0f);
+    float cumulative = 0.0f;
+    for (const Candidate& cand : c) {
+        cumulative += cand.prob;
+        if (u < cumulative) return cand.id;
+    }
+    return c.back().id;   // rounding left the sum just under u
+}
+
+const std::vector<Candidate>& Sampler::candidates(const float* logits, int n) {
+    if (n <= 0) throw std::invalid_argument("Sampling from an empty logits row");
+    kept.clear();
+    if (settings.temperature <= 0.0f || settings.top_k == 1) {
+        kept.push_back({argmax(logits, n), 1.0f});
+        return kept;
+    }
+    const float inv_temp = 1.0f / settings.temperature;
+    if (settings.top_k > 0 && settings.top_k < n) keep_top_k(logits, n, inv_temp);
+    else if (settings.top_p < 1.0f) keep_nucleus(logits, n, inv_temp);
+    else keep_all(logits, n, inv_temp);
+    return kept;
+}
+
+// Selection compares raw logits (a positive temperature keeps their order);
+// only the k survivors are scaled, exponentiated and sorted
+void Sampler::keep_top_k(const float* logits, int n, float inv_temp) {
+    const int k = settings.top_k;
+    pairs.clear();
+    if (k <= HEAP_MAX_K) {
+        // Heap ordered by better(), so the front is the worst entry kept
+        for (int i = 0; i < n; i++) {
+            const std::pair<float, int> entry(logits[i], i);
+            if (static_cast<int>(pairs.size()) < k) {
+                pairs.push_back(entry);
+                std::push_heap(pairs.begin(), pairs.end(), better);
+            } else if (better(entry, pairs.front())) {
+                std::pop_heap(pairs.begin(), pairs.end(), better);
+                pairs.back() = entry;
+                std::push_heap(pairs.begin(), pairs.end(), better);
+            }
+        }
+    } else {
+        pairs.resize(n);
+        for (int i = 0; i < n; i++) pairs[i] = {logits[i], i};
+        std::nth_element(pairs.begin(), pairs.begin() + k, pairs.end(), better);
+        pairs.resize(k);
+    }
+    std::sort(pairs.begin(), pairs.end(), better);
+
+    weights.resize(k);
+    double total = 0.0;
+    for (int j = 0; j < k; j++) weights[j] = pairs[j].first;
+    softmax_exp(weights.data(), weights.data(), k, pairs[0].first, inv_temp);
+    for (int j = 0; j < k; j++) total += weights[j];
+
+    // Nucleus cut on the sorted survivors
+    int count = k;
+    double mass = total;
+    if (settings.top_p < 1.0f) {
+        const double target = settings.top_p * total;
+        mass = 0.0;
+        for (count = 0; count < k && mass < target; count++) mass += weights[count];
+    }
+    for (int j = 0; j < count; j++) kept.push_back({pairs[j].second, static_cast<float>(weights[j] / mass)});
+}
+
+void Sampler::keep_nucleus(const float* logits, int n, float inv_temp) {
+    const float top = logits[argmax(logits, n)];
+    weights.resize(n);
+    softmax_exp(logits, weights.data(), n, top, inv_temp);
+
+    std::fill(bucket_mass.begin(), bucket_mass.end(), 0.0);
+    buckets.resize(n);
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        buckets[i] = static_cast<std::uint16_t>(bucket_of((top - logits[i]) * inv_temp));
+        bucket_mass[buckets[i]] += weights[i];
+        total += weights[i];
+    }
+
+    // First bucket from the top where the running mass reaches p
+    const double target = settings.top_p * total;
+    double mass = 0.0;
+    int edge = BUCKETS - 1;
+    for (int b = 0; b < BUCKETS; b++) {
+        if (mass + bucket_mass[b] >= target) {
+            edge = b;
+            break;
+        }
+        mass += bucket_mass[b];
+    }
+
+    // Buckets above the edge are kept whole; the edge bucket is sorted and
+    // taken until the mass reaches p
+    pairs.clear();
+    for (int i = 0; i < n; i++) {
+        const int b = buckets[i];
+        if (b < edge) kept.push_back({i, weights[i]});
+        else if (b == edge) pairs.push_back({weights[i], i});
+    }
+    std::sort(pairs.begin(), pairs.end(), better);
+    for (const auto& entry : pairs) {
+        if (mass >= target) break;
+        kept.push_back({entry.second, entry.first});
+        mass += entry.first;
+    }
+    for (Candidate& c : kept) c.prob = static_cast<float>(c.prob / mass);
+}
+
+void Sampler::keep_all(const float* logits, int n, float inv_temp) {
+    weights.resize(n);
+    softmax_exp(logits, weights.data(), n, logits[argmax(logits, n)], inv_temp);
+    double total = 0.0;
+    for (int i = 0; i < n; i++) total += weights[i];
+    kept.resize(n);
+    for (int i = 0; i < n; i++) kept[i] = {i, static_cast<float>(weights[i] / total)};
+}
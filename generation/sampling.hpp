@@ -0,0 +1,66 @@
+#ifndef SAMPLING_HPP
+#define SAMPLING_HPP
+
+#include <cstdint>
+#include <vector>
+#include "../math_primitives/random.hpp"
+
+// ---------------- SAMPLING ----------------
+// temperature <= 0 means greedy. top_k == 0 and top_p >= 1 switch those
+// filters off. Filters apply in the usual order: temperature, then top-k,
+// then top-p over what top-k kept.
+struct SamplingParams {
+    float temperature = 1.0f;
+    int top_k = 0;
+    float top_p = 1.0f;
+};
+
+struct Candidate {
+    int id;
+    float prob;
+};
+
+// Draws token ids from logits rows without sorting the vocabulary. Logits
+// are divided by the temperature as they are read, never rewritten.
+//   top-k  one pass keeping a k-entry min-heap of the best logits, or
+//          nth_element on a copy when k is large; only the k survivors are
+//          sorted
+//   top-p  one vectorised pass computes exp(z - max), a second adds each
+//          weight to a histogram over its distance below the max (1024
+//          buckets of 1/64 logit). Walking buckets from the top finds the
+//          one where the cumulative mass crosses p; everything above it is
+//          kept and only that bucket's tokens are sorted to place the
+//          exact cut.
+// Softmax runs over the survivors only, and one uniform draw from the
+// seeded Random walks their cumulative mass, so a seed fixes the sequence.
+class Sampler {
+public:
+    Sampler(const SamplingParams& params, unsigned int seed);
+
+    const SamplingParams& params() const { return settings; }
+
+    int sample(const float* logits, int n);
+
+    // The distribution sample() draws from: surviving ids with their
+    // probabilities normalised over the survivors. After top-k they are in
+    // descending order; otherwise the order is unspecified.
+    const std::vector<Candidate>& candidates(const float* logits, int n);
+
+private:
+    void keep_top_k(const float* logits, int n, float inv_temp);
+    void keep_nucleus(const float* logits, int n, float inv_temp);
+    void keep_all(const float* logits, int n, float inv_temp);
+
+    SamplingParams settings;
+    Random rng;
+    std::vector<Candidate> kept;
+    std::vector<float> weights;
+    std::vector<double> bucket_mass;
+    std::vector<std::uint16_t> buckets;
+    std::vector<std::pair<float, int>> pairs;
+};
+
+// Greedy choice: the first index of the largest logit
+int argmax(const float* logits, int n);
+
+#endif // SAMPLING_HPP
@@ -0,0 +1,114 @@
+#include "sampling.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// Per-token latency of Sampler against the obvious implementation that
+// scales and sorts the whole logits row, then applies top-k, softmax and
+// the top-p cut on the sorted list. Both are run on the same rows of
+// N(0, 3) logits, and their candidate sets and probabilities must agree.
+//
+// usage: sampling_bench [vocab] [rows] [repeats]
+
+namespace {
+
+std::vector<Candidate> full_sort(const float* logits, int n, const SamplingParams& p) {
+    std::vector<std::pair<float, int>> all(n);
+    for (int i = 0; i < n; i++) all[i] = {logits[i] / p.temperature, i};
+    std::sort(all.begin(), all.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+    if (p.top_k > 0 && p.top_k < n) all.resize(p.top_k);
+
+    std::vector<double> w(all.size());
+    double total = 0.0;
+    for (std::size_t j = 0; j < all.size(); j++) total += w[j] = std::exp(all[j].first - all[0].first);
+    std::size_t count = all.size();
+    double mass = total;
+    if (p.top_p < 1.0f) {
+        mass = 0.0;
+        for (count = 0; count < all.size() && mass < p.top_p * total; count++) mass += w[count];
+    }
+    std::vector<Candidate> out;
+    for (std::size_t j = 0; j < count; j++) out.push_back({all[j].second, static_cast<float>(w[j] / mass)});
+    return out;
+}
+
+// Largest probability difference over the union of ids, or -1 when the
+// sets differ
+double compare(std::vector<Candidate> a, std::vector<Candidate> b) {
+    auto by_id = [](const Candidate& x, const Candidate& y) { return x.id < y.id; };
+    std::sort(a.begin(), a.end(), by_id);
+    std::sort(b.begin(), b.end(), by_id);
+    if (a.size() != b.size()) return -1.0;
+    double diff = 0.0;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (a[i].id != b[i].id) return -1.0;
+        diff = std::max(diff, static_cast<double>(std::fabs(a[i].prob - b[i].prob)));
+    }
+    return diff;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int vocab = argc > 1 ? std::stoi(argv[1]) : 50257;
+    int rows = argc > 2 ? std::stoi(argv[2]) : 32;
+    int repeats = argc > 3 ? std::stoi(argv[3]) : 10;
+
+    try {
+        std::vector<float> logits(static_cast<std::size_t>(vocab) * rows);
+        Philox(81).fill(logits.data(), logits.size(), NormalDist{0.0f, 3.0f});
+
+        struct Config {
+            const char* name;
+            SamplingParams params;
+        };
+        const Config configs[] = {
+            {"greedy", {0.0f, 0, 1.0f}},
+            {"T=1", {1.0f, 0, 1.0f}},
+            {"T=0.8 k=50", {0.8f, 50, 1.0f}},
+            {"T=0.8 k=2000", {0.8f, 2000, 1.0f}},
+            {"T=0.9 p=0.9", {0.9f, 0, 0.9f}},
+            {"T=0.7 p=0.5", {0.7f, 0, 0.5f}},
+            {"T=0.8 k=50 p=0.95", {0.8f, 50, 0.95f}},
+        };
+
+        std::cout << "vocab " << vocab << std::endl;
+        std::cout << "config | sampler us/token | full sort us/token | speedup | candidates | max prob diff"
+                  << std::endl;
+        for (const Config& config : configs) {
+            Sampler sampler(config.params, 7);
+            auto start = Clock::now();
+            for (int r = 0; r < repeats; r++)
+                for (int row = 0; row < rows; row++) sampler.sample(&logits[static_cast<std::size_t>(row) * vocab], vocab);
+            const double sampler_us = elapsed_ms(start) * 1000.0 / (repeats * rows);
+
+            SamplingParams sort_params = config.params;
+            if (sort_params.temperature <= 0.0f) sort_params = {1.0f, 1, 1.0f};
+            start = Clock::now();
+            for (int r = 0; r < repeats; r++)
+                for (int row = 0; row < rows; row++) full_sort(&logits[static_cast<std::size_t>(row) * vocab], vocab, sort_params);
+            const double sort_us = elapsed_ms(start) * 1000.0 / (repeats * rows);
+
+            double diff = 0.0;
+            std::size_t count = 0;
+            for (int row = 0; row < rows && diff >= 0.0; row++) {
+                const float* l = &logits[static_cast<std::size_t>(row) * vocab];
+                const std::vector<Candidate>& mine = sampler.candidates(l, vocab);
+                count += mine.size();
+                const double d = compare(mine, full_sort(l, vocab, sort_params));
+                diff = d < 0.0 ? d : std::max(diff, d);
+            }
+            std::cout << config.name << " | " << sampler_us << " | " << sort_us << " | " << sort_us / sampler_us
+                      << "x | " << static_cast<double>(count) / rows << " | "
+                      << (diff < 0.0 ? "SETS DIFFER" : std::to_string(diff)) << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
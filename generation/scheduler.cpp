@@ -0,0 +1,143 @@
+#include "scheduler.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// ---------------- CONTINUOUS BATCHING ----------------
+Scheduler::Scheduler(const GptWeights& weights, const SchedulerConfig& config)
+    : weights(weights),
+      config(config),
+      generator(weights, KVCache::paged(weights.config.layers, config.max_batch, weights.config.heads,
+                                        weights.config.head_dim(), config.block_size, config.blocks)) {
+    if (config.max_step_tokens <= 0) throw std::invalid_argument("max_step_tokens must be positive");
+    for (int s = config.max_batch - 1; s >= 0; s--) free_slots.push_back(s);
+}
+
+int Scheduler::blocks_for(std::size_t positions) const {
+    return static_cast<int>((positions + config.block_size - 1) / config.block_size);
+}
+
+int Scheduler::submit(std::vector<int> prompt, int max_new, NextToken next) {
+    if (prompt.empty()) throw std::invalid_argument("Empty prompt");
+    if (max_new < 1) throw std::invalid_argument("A sequence needs at least one new token");
+    for (int token : prompt)
+        if (token < 0 || token >= weights.config.vocab)
+            throw std::out_of_range("Token id " + std::to_string(token) + " outside vocabulary of " +
+                                    std::to_string(weights.config.vocab));
+    // The last new token is never fed back, so it needs no position
+    const std::size_t positions = prompt.size() + max_new - 1;
+    if (blocks_for(positions) > config.blocks)
+        throw std::invalid_argument(std::to_string(positions) + " positions don't fit in a pool of " +
+                                    std::to_string(config.blocks) + " blocks of " +
+                                    std::to_string(config.block_size));
+
+    Sequence seq;
+    seq.id = next_id++;
+    seq.tokens = std::move(prompt);
+    seq.max_new = max_new;
+    seq.next = std::move(next);
+    queue.push_back(std::move(seq));
+    return queue.back().id;
+}
+
+// A waiting sequence is admitted while the blocks not yet promised cover its
+// tokens and leave one block of growth per running sequence. With nothing
+// running it always fits, since submit() refused anything larger than the pool.
+void Scheduler::admit() {
+    int unpromised = generator.cache().free_blocks();
+    while (!queue.empty() && !free_slots.empty()) {
+        const int needed = blocks_for(queue.front().tokens.size());
+        if (!active.empty() && needed + running() > unpromised) break;
+        unpromised -= needed;
+        Sequence seq = std::move(queue.front());
+        queue.pop_front();
+        seq.slot = free_slots.back();
+        free_slots.pop_back();
+        active.push_back(std::move(seq));
+    }
+}
+
+// Recompute rather than swap: the sequence keeps its tokens and its
+// NextToken (and so any sampler state) but none of its cache
+void Scheduler::preempt(std::size_t index) {
+    Sequence& seq = active[index];
+    generator.reset(seq.slot);
+    free_slots.push_back(seq.slot);
+    seq.slot = -1;
+    seq.fed = 0;
+    queue.push_front(std::move(seq));
+    active.erase(active.begin() + index);
+    counters.preemptions++;
+}
+
+bool Scheduler::step() {
+    admit();
+    if (active.empty()) return false;
+
+    std::vector<TokenInput> inputs;
+    std::vector<std::size_t> owners;   // active index of each logits row
+    int budget = config.max_step_tokens;
+    for (std::size_t i = 0; i < active.size(); i++) {
+        const int size = static_cast<int>(active[i].tokens.size());
+        const int pending = size - active[i].fed;
+        int chunk = pending;
+        if (pending > 1) {
+            chunk = std::min(pending, budget);
+            budget -= chunk;
+            if (chunk == 0) continue;
+        }
+        // The newest sequence gives way, even if that is this one
+        while (!generator.reserve(active[i].slot, active[i].fed + chunk)) {
+            const bool last = i + 1 == active.size();
+            preempt(active.size() - 1);
+            if (last) break;
+        }
+        if (i == active.size()) break;
+
+        Sequence& seq = active[i];
+        for (int t = seq.fed; t < seq.fed + chunk; t++) inputs.push_back({seq.slot, seq.tokens[t], t + 1 == size});
+        if (pending > 1 || seq.generated == 0) counters.prefilled += chunk;
+        if (seq.fed + chunk == size) owners.push_back(i);
+        seq.fed += chunk;
+        counters.step_rows++;
+    }
+    const KVCache& kv = generator.cache();
+    counters.peak_blocks = std::max(counters.peak_blocks, kv.blocks() - kv.free_blocks());
+    counters.steps++;
+
+    const matrix logits = generator.forward(inputs);
+    std::vector<bool> done(active.size(), false);
+    for (std::size_t r = 0; r < owners.size(); r++) {
+        Sequence& seq = active[owners[r]];
+        const int token = seq.next(&logits[r][0], logits[r].size());
+        if (token >= weights.config.vocab)
+            throw std::out_of_range("NextToken chose id " + std::to_string(token) + " outside vocabulary of " +
+                                    std::to_string(weights.config.vocab));
+        if (token >= 0) {
+            seq.generated++;
+            counters.generated++;
+            seq.tokens.push_back(token);
+        }
+        done[owners[r]] = token < 0 || seq.generated == seq.max_new;
+    }
+
+    // Finished sequences free their slot and blocks for the next step
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < active.size(); i++) {
+        if (done[i]) {
+            generator.reset(active[i].slot);
+            free_slots.push_back(active[i].slot);
+        } else {
+            if (kept != i) active[kept] = std::move(active[i]);
+            kept++;
+        }
+    }
+    active.erase(active.begin() + kept, active.end());
+    return true;
+}
+
+void Scheduler::run() {
+    while (step()) {
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "generator.hpp"
+
+// ---------------- CONTINUOUS BATCHING ----------------
+struct SchedulerConfig {
+    int max_batch = 8;          // sequences running at once (cache slots)
+    int block_size = 16;        // positions per KV block
+    int blocks = 256;           // KV blocks in the pool, shared by all sequences
+    int max_step_tokens = 256;  // prompt tokens prefilled per step, over all sequences
+};
+
+struct SchedulerStats {
+    std::uint64_t steps = 0;
+    std::uint64_t generated = 0;      // tokens handed to sequences
+    std::uint64_t prefilled = 0;      // prompt tokens run, recomputation included
+    std::uint64_t preemptions = 0;
+    std::uint64_t step_rows = 0;      // sequences in a forward, summed over steps
+    int peak_blocks = 0;
+};
+
+// Picks the next token from a sequence's logits row, or returns a negative
+// id to end the sequence there
+using NextToken = std::function<int(const float* logits, int vocab)>;
+
+// Iteration-level scheduling over a Generator with a paged KV cache. Every
+// step() is one forward pass:
+//   1. waiting sequences take free slots, oldest first, while the pool has
+//      blocks for their tokens plus a block of growth per running sequence
+//   2. each running sequence, oldest first, gets its next token to decode or
+//      its next prompt chunk (at most max_step_tokens of prompt per step in
+//      total, so a long prompt doesn't stall everyone's decoding) and
+//      reserves the blocks for it. When the pool is empty the newest running
+//      sequence is preempted: its blocks go back to the pool and it returns
+//      to the front of the queue with the tokens it has produced appended to
+//      its prompt, to be recomputed when there is room again
+//   3. one forward over all of it, and each sequence whose input reached
+//      its last token gets its logits row
+// A sequence leaves as soon as it has max_new tokens or its NextToken ends
+// it, and its slot and blocks are reused in the next step rather than when
+// the rest of its batch is done.
+class Scheduler {
+public:
+    // weights must outlive the scheduler
+    Scheduler(const GptWeights& weights, const SchedulerConfig& config);
+
+    // Queues a sequence and returns its id. next is called once per new
+    // token, at most max_new times. Throws if the prompt is empty, has a token
+    // outside the vocabulary, or could not fit in the whole pool.
+    int submit(std::vector<int> prompt, int max_new, NextToken next);
+
+    // Runs one iteration; false when there was nothing to run
+    bool step();
+    // Steps until every submitted sequence has finished
+    void run();
+
+    int running() const { return static_cast<int>(active.size()); }
+    int waiting() const { return static_cast<int>(queue.size()); }
+    const SchedulerStats& stats() const { return counters; }
+    const KVCache& cache() const { return generator.cache(); }
+
+private:
+    struct Sequence {
+        int id;
+        std::vector<int> tokens;   // prompt, then everything generated
+        int max_new;
+        int generated = 0;
+        int fed = 0;               // tokens in the cache
+        int slot = -1;
+        NextToken next;
+    };
+
+    int blocks_for(std::size_t positions) const;
+    void admit();
+    void preempt(std::size_t index);
+
+    const GptWeights& weights;
+    SchedulerConfig config;
+    Generator generator;
+    std::deque<Sequence> queue;
+    std::vector<Sequence> active;      // in admission order
+    std::vector<int> free_slots;
+    int next_id = 0;
+    SchedulerStats counters;
+};
+
+#endif // SCHEDULER_HPP
@@ -0,0 +1,51 @@
+#include "server.hpp"
+#include <csignal>
+#include <iostream>
+
+// Serves a model over a Unix socket until SIGINT or SIGTERM, then prints the
+// final counters. Without a checkpoint (written by save_gpt) it serves
+// randomly initialised weights of the default GptConfig, which is enough to
+// exercise batching and measure latency.
+//
+// usage: serve [socket path] [max batch] [max wait us] [checkpoint]
+
+namespace {
+
+InferenceServer* running = nullptr;
+
+void on_signal(int) {
+    if (running) running->stop();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    if (argc > 1) config.socket_path = argv[1];
+    if (argc > 2) config.max_batch = std::stoi(argv[2]);
+    if (argc > 3) config.max_wait_us = std::stoi(argv[3]);
+
+    try {
+        const GptWeights weights = argc > 4 ? load_gpt(argv[4]) : init_gpt(GptConfig(), Philox(71));
+        InferenceServer server(weights, config);
+        running = &server;
+        std::signal(SIGINT, on_signal);
+        std::signal(SIGTERM, on_signal);
+
+        std::cout << "serving " << weights.config.layers << " layers of width " << weights.config.width << " on "
+                  << config.socket_path << ", up to " << config.max_batch << " sequences at once, "
+                  << config.blocks << " KV blocks of " << config.block_size << std::endl;
+        server.run();
+        running = nullptr;
+
+        const ServerStats s = server.stats();
+        std::cout << s.requests << " requests, " << s.tokens << " tokens in " << s.steps << " steps (mean batch "
+                  << s.mean_batch << ", " << s.preemptions << " preemptions), latency p50 " << s.p50_ms
+                  << " ms p99 " << s.p99_ms << " ms, first token p50 " << s.ttft_p50_ms << " ms p99 " << s.ttft_p99_ms << " ms, "
+                  << s.tokens_per_s << " tok/s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
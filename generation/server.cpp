@@ -0,0 +1,363 @@
+#include "server.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t MAX_LINE = 1 << 20;   // longer request lines drop the connection
+constexpr int POLL_MS = 100;                // how often idle loops look at the stop flag
+
+SchedulerConfig scheduler_config(const ServerConfig& config) {
+    SchedulerConfig sched;
+    sched.max_batch = config.max_batch;
+    sched.block_size = config.block_size;
+    sched.blocks = config.blocks;
+    return sched;
+}
+
+double ms_between(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// Nearest-rank percentile of an unsorted sample, which it reorders
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) return 0.0;
+    const std::size_t rank = std::min(values.size() - 1, static_cast<std::size_t>(std::ceil(p * values.size())) - 1);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+} // namespace
+
+// ---------------- PROTOCOL ----------------
+bool send_all(int fd, const std::string& text) {
+    const char* p = text.data();
+    std::size_t left = text.size();
+    while (left > 0) {
+        const ssize_t sent = ::send(fd, p, left, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        p += sent;
+        left -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+bool LineReader::next(std::string& line) {
+    for (;;) {
+        const std::size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            line.assign(buffer, 0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            return true;
+        }
+        if (buffer.size() > MAX_LINE) return false;
+        char chunk[4096];
+        const ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        buffer.append(chunk, static_cast<std::size_t>(got));
+    }
+}
+
+// ---------------- INFERENCE SERVER ----------------
+struct InferenceServer::Connection {
+    int fd;
+    std::mutex write_mutex;          // engine and reader both write replies
+    std::atomic<bool> closed{false}; // reader has finished
+    std::atomic<bool> dead{false};   // a send failed or timed out
+
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { ::close(fd); }
+
+    // After one failure every later send fails at once, and shutting the
+    // socket down ends the reader too
+    bool send(const std::string& text) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (dead.load()) return false;
+        if (send_all(fd, text)) return true;
+        dead.store(true);
+        ::shutdown(fd, SHUT_RDWR);
+        return false;
+    }
+};
+
+struct InferenceServer::Request {
+    std::shared_ptr<Connection> conn;
+    bool predict = false;
+    std::vector<int> prompt;
+    int max_new = 1;
+    std::unique_ptr<Sampler> sampler;   // GEN only; each request has its own seed
+    Clock::time_point arrival, first_token;
+    int produced = 0;
+    bool done = false;   // answered, or its client is gone
+};
+
+InferenceServer::InferenceServer(const GptWeights& weights, const ServerConfig& config)
+    : weights(weights), config(config), scheduler(new Scheduler(weights, scheduler_config(config))) {
+    if (config.max_wait_us < 0) throw std::invalid_argument("max_wait_us must be non-negative");
+    if (config.send_timeout_ms <= 0) throw std::invalid_argument("send_timeout_ms must be positive");
+}
+
+InferenceServer::~InferenceServer() = default;
+
+void InferenceServer::run() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (config.socket_path.empty() || config.socket_path.size() >= sizeof(address.sun_path))
+        throw std::invalid_argument("Bad socket path '" + config.socket_path + "'");
+    std::memcpy(address.sun_path, config.socket_path.c_str(), config.socket_path.size() + 1);
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    ::unlink(config.socket_path.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listener, 128) < 0) {
+        const std::string reason = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Cannot listen on " + config.socket_path + ": " + reason);
+    }
+
+    started = Clock::now();
+    std::thread engine(&InferenceServer::engine_loop, this);
+
+    while (!stopping.load()) {
+        pollfd p{listener, POLLIN, 0};
+        if (::poll(&p, 1, POLL_MS) <= 0) continue;
+        const int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        timeval timeout{config.send_timeout_ms / 1000, (config.send_timeout_ms % 1000) * 1000};
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        auto conn = std::make_shared<Connection>(fd);
+        readers.push_back({std::thread(&InferenceServer::serve_connection, this, conn), conn});
+
+        // Reap readers whose clients have gone
+        for (std::size_t i = 0; i < readers.size();) {
+            if (readers[i].conn->closed.load()) {
+                readers[i].thread.join();
+                readers[i] = std::move(readers.back());
+                readers.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+
+    // Shutting the sockets down first wakes every reader blocked in recv and
+    // an engine blocked in send; the engine then abandons its sequences and
+    // fails whatever is queued
+    for (Reader& r : readers) ::shutdown(r.conn->fd, SHUT_RDWR);
+    queued.notify_all();
+    engine.join();
+    for (Reader& r : readers) r.thread.join();
+    readers.clear();
+    ::close(listener);
+    ::unlink(config.socket_path.c_str());
+}
+
+std::shared_ptr<InferenceServer::Request> InferenceServer::parse_request(const std::string& command,
+                                                                         std::istream& in) {
+    auto req = std::make_shared<Request>();
+    req->predict = command == "PREDICT";
+    if (!req->predict) {
+        SamplingParams params;
+        unsigned long seed = 0;
+        if (!(in >> req->max_new >> params.temperature >> params.top_k >> params.top_p >> seed))
+            throw std::invalid_argument("usage: GEN <new tokens> <temperature> <top_k> <top_p> <seed> <token>...");
+        if (req->max_new < 1) throw std::invalid_argument("GEN needs at least one new token");
+        req->sampler.reset(new Sampler(params, static_cast<unsigned int>(seed)));
+    }
+    int token;
+    while (in >> token) {
+        if (token < 0 || token >= weights.config.vocab)
+            throw std::out_of_range("Token id " + std::to_string(token) + " outside vocabulary of " +
+                                    std::to_string(weights.config.vocab));
+        req->prompt.push_back(token);
+    }
+    if (!in.eof()) throw std::invalid_argument("Token ids must be integers");
+    if (req->prompt.empty()) throw std::invalid_argument("Empty prompt");
+    // The scheduler's own limit, checked here so the reply comes from this thread
+    const std::size_t positions = req->prompt.size() + req->max_new - 1;
+    if (positions > static_cast<std::size_t>(config.block_size) * config.blocks)
+        throw std::invalid_argument(std::to_string(positions) + " positions exceed the KV pool of " +
+                                    std::to_string(config.block_size * config.blocks));
+    return req;
+}
+
+void InferenceServer::serve_connection(std::shared_ptr<Connection> conn) {
+    LineReader reader(conn->fd);
+    std::string line;
+    while (!stopping.load() && reader.next(line)) {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+        if (command.empty()) continue;
+        if (command == "STATS") {
+            conn->send(stats_line() + "\n");
+            continue;
+        }
+        if (command != "GEN" && command != "PREDICT") {
+            conn->send("ERR unknown command " + command + "\n");
+            continue;
+        }
+        std::shared_ptr<Request> req;
+        try {
+            req = parse_request(command, in);
+        } catch (const std::exception& e) {
+            conn->send(std::string("ERR ") + e.what() + "\n");
+            continue;
+        }
+        req->conn = conn;
+        req->arrival = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (stopping.load()) break;
+            queue.push_back(std::move(req));
+        }
+        queued.notify_one();
+    }
+    conn->closed.store(true);
+}
+
+void InferenceServer::engine_loop() {
+    std::vector<std::shared_ptr<Request>> in_flight;
+    while (!stopping.load()) {
+        std::deque<std::shared_ptr<Request>> arrived;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            if (in_flight.empty()) {
+                if (!queued.wait_for(lock, std::chrono::milliseconds(POLL_MS),
+                                     [&] { return stopping.load() || !queue.empty(); }))
+                    continue;
+                if (queue.empty()) continue;
+                // The latency budget runs from the oldest request's arrival
+                const Clock::time_point deadline =
+                    queue.front()->arrival + std::chrono::microseconds(config.max_wait_us);
+                queued.wait_until(lock, deadline, [&] {
+                    return stopping.load() || static_cast<int>(queue.size()) >= config.max_batch;
+                });
+            }
+            arrived.swap(queue);
+        }
+        if (stopping.load()) {
+            for (auto& req : arrived) req->conn->send("ERR server shutting down\n");
+            break;
+        }
+        for (auto& req : arrived) {
+            scheduler->submit(req->prompt, req->max_new,
+                              [this, req](const float* logits, int vocab) { return next_token(*req, logits, vocab); });
+            in_flight.push_back(std::move(req));
+        }
+
+        try {
+            scheduler->step();
+        } catch (const std::exception& e) {
+            // The scheduler's state is unknown; fail its sequences and start afresh
+            for (auto& req : in_flight)
+                if (!req->done) req->conn->send(std::string("ERR ") + e.what() + "\n");
+            in_flight.clear();
+            scheduler.reset(new Scheduler(weights, scheduler_config(config)));
+        }
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            engine = scheduler->stats();
+        }
+        in_flight.erase(std::remove_if(in_flight.begin(), in_flight.end(),
+                                       [](const std::shared_ptr<Request>& req) { return req->done; }),
+                        in_flight.end());
+    }
+
+    for (auto& req : in_flight)
+        if (!req->done) req->conn->send("ERR server shutting down\n");
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    for (auto& req : queue) req->conn->send("ERR server shutting down\n");
+    queue.clear();
+}
+
+// Called by the scheduler with each of the request's logits rows. Returns
+// the token to continue with, or -1 to end a sequence whose client is gone.
+int InferenceServer::next_token(Request& req, const float* logits, int vocab) {
+    if (req.predict) {
+        const int best = argmax(logits, vocab);
+        double total = 0.0;
+        for (int i = 0; i < vocab; i++) total += std::exp(static_cast<double>(logits[i]) - logits[best]);
+        req.first_token = Clock::now();
+        if (req.conn->send("PRED " + std::to_string(best) + " " + std::to_string(1.0 / total) + "\n")) finish(req);
+        req.done = true;
+        return best;
+    }
+    const int token = req.sampler->sample(logits, vocab);
+    if (req.produced++ == 0) req.first_token = Clock::now();
+    if (!req.conn->send("TOK " + std::to_string(token) + "\n")) {
+        req.done = true;
+        return -1;
+    }
+    if (req.produced == req.max_new) {
+        finish(req);
+        req.done = true;
+    }
+    return token;
+}
+
+void InferenceServer::finish(Request& req) {
+    const Clock::time_point now = Clock::now();
+    const double latency = ms_between(req.arrival, now);
+    {
+        // Counted before END goes out, so a client's next STATS includes it
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        const double ttft = ms_between(req.arrival, req.first_token);
+        if (latencies.size() < LATENCY_WINDOW) {
+            latencies.push_back(latency);
+            first_token.push_back(ttft);
+        } else {
+            latencies[next_sample] = latency;
+            first_token[next_sample] = ttft;
+            next_sample = (next_sample + 1) % LATENCY_WINDOW;
+        }
+        completed++;
+        generated += req.produced;
+    }
+    if (!req.predict)
+        req.conn->send("END " + std::to_string(req.produced) + " " +
+                       std::to_string(static_cast<long long>(latency * 1000.0)) + "\n");
+}
+
+ServerStats InferenceServer::stats() {
+    std::vector<double> latency, ttft;
+    ServerStats s;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        latency = latencies;
+        ttft = first_token;
+        s.requests = completed;
+        s.tokens = generated;
+        s.steps = engine.steps;
+        s.preemptions = engine.preemptions;
+        s.mean_batch = engine.steps ? static_cast<double>(engine.step_rows) / engine.steps : 0.0;
+    }
+    s.p50_ms = percentile(latency, 0.50);
+    s.p99_ms = percentile(latency, 0.99);
+    s.ttft_p50_ms = percentile(ttft, 0.50);
+    s.ttft_p99_ms = percentile(ttft, 0.99);
+    const double seconds = ms_between(started, Clock::now()) / 1000.0;
+    s.tokens_per_s = seconds > 0.0 ? s.tokens / seconds : 0.0;
+    return s;
+}
+
+std::string InferenceServer::stats_line() {
+    const ServerStats s = stats();
+    std::ostringstream out;
+    out << "STATS requests=" << s.requests << " tokens=" << s.tokens << " steps=" << s.steps
+        << " preemptions=" << s.preemptions << " mean_batch=" << s.mean_batch << " p50_ms=" << s.p50_ms << " p99_ms=" << s.p99_ms
+        << " ttft_p50_ms=" << s.ttft_p50_ms << " ttft_p99_ms=" << s.ttft_p99_ms << " tok_per_s=" << s.tokens_per_s;
+    return out.str();
+}
@@ -0,0 +1,131 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "scheduler.hpp"
+
+// ---------------- PROTOCOL ----------------
+// Newline-terminated text lines over a Unix stream socket. Requests:
+//   GEN <new tokens> <temperature> <top_k> <top_p> <seed> <token>...
+//   PREDICT <token>...
+//   STATS
+// Replies to GEN stream one "TOK <id>" line per token as it is decoded and
+// finish with "END <tokens> <latency us>". PREDICT answers
+// "PRED <id> <probability>" with the most likely next token. STATS answers
+// one "STATS key=value ..." line. A malformed request gets "ERR <reason>".
+// A client may pipeline requests on one connection; replies to different
+// requests can interleave only if it does.
+
+// Sends all of text, retrying short writes; false once the peer is gone or,
+// on a socket with SO_SNDTIMEO, has stopped reading for that long
+bool send_all(int fd, const std::string& text);
+
+// Buffered line reads from a socket
+class LineReader {
+public:
+    explicit LineReader(int fd) : fd(fd) {}
+    // Next line without its newline; false at end of stream or on error
+    bool next(std::string& line);
+
+private:
+    int fd;
+    std::string buffer;
+};
+
+// ---------------- INFERENCE SERVER ----------------
+struct ServerConfig {
+    std::string socket_path = "/tmp/llm-from-scratch.sock";
+    int max_batch = 8;        // sequences decoded together (and KV cache slots)
+    int max_wait_us = 2000;   // how long an idle server's first request waits for others
+    int send_timeout_ms = 1000;   // a client that blocks a reply this long is dropped
+    int block_size = 16;      // KV pool: a request must fit in block_size x blocks positions
+    int blocks = 256;
+};
+
+struct ServerStats {
+    std::uint64_t requests = 0;   // completed
+    std::uint64_t tokens = 0;     // generated
+    std::uint64_t steps = 0;      // forward passes
+    std::uint64_t preemptions = 0;
+    double mean_batch = 0.0;      // sequences per step
+    double p50_ms = 0.0, p99_ms = 0.0;            // arrival to END
+    double ttft_p50_ms = 0.0, ttft_p99_ms = 0.0;  // arrival to first token
+    double tokens_per_s = 0.0;                    // since the server started
+};
+
+// Dynamic batching: one thread per connection parses requests into a
+// queue, and the engine thread hands them to a Scheduler between its steps,
+// so new requests join the running batch as soon as there is a free slot
+// (continuous batching). When the server is idle the engine waits up to
+// max_wait_us from the first request's arrival, or until max_batch have
+// queued, so a burst starts in one step. Each token is written to its
+// client as soon as it is sampled. A client that stops reading would stall
+// the engine, and every other client with it, so a send that can't complete
+// within send_timeout_ms drops that connection and ends its sequences.
+class InferenceServer {
+public:
+    // weights must outlive the server
+    InferenceServer(const GptWeights& weights, const ServerConfig& config);
+    ~InferenceServer();
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // Binds the socket and serves until stop(); returns after every thread
+    // has finished
+    void run();
+    // Only sets a flag, so it is safe from a signal handler
+    void stop() { stopping.store(true); }
+
+    ServerStats stats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection;
+    struct Request;
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<Connection> conn;
+    };
+
+    void serve_connection(std::shared_ptr<Connection> conn);
+    std::shared_ptr<Request> parse_request(const std::string& command, std::istream& in);
+    void engine_loop();
+    int next_token(Request& req, const float* logits, int vocab);
+    void finish(Request& req);
+    std::string stats_line();
+
+    const GptWeights& weights;
+    ServerConfig config;
+    std::unique_ptr<Scheduler> scheduler;   // engine thread only
+    std::atomic<bool> stopping{false};
+    Clock::time_point started;
+
+    std::mutex queue_mutex;
+    std::condition_variable queued;
+    std::deque<std::shared_ptr<Request>> queue;
+
+    // Only touched by the thread in run()
+    std::vector<Reader> readers;
+
+    // Latencies of the most recent LATENCY_WINDOW requests, in ms
+    static constexpr std::size_t LATENCY_WINDOW = 1 << 16;
+    std::mutex stats_mutex;
+    std::vector<double> latencies, first_token;
+    std::size_t next_sample = 0;
+    std::uint64_t completed = 0, generated = 0;
+    SchedulerStats engine;   // copied from the scheduler after each step
+};
+
+#endif // SERVER_HPP
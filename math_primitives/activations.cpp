@@ -0,0 +1,177 @@
+#include "activations.hpp"
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr float GELU_C = 0.7978845608f;  // sqrt(2 / pi)
+constexpr float GELU_A = 0.044715f;
+
+#ifdef __SSE2__
+// e^x: x = n ln2 + r with |r| <= ln2 / 2, e^r by its degree-6 Taylor
+// polynomial (error below 2e-7), 2^n assembled in the exponent bits
+inline __m128 exp_ps(__m128 x) {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.0f)), _mm_set1_ps(87.0f));
+    const __m128i n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504f)));
+    const __m128 nf = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(nf, _mm_set1_ps(0.693359375f)));
+    r = _mm_add_ps(r, _mm_mul_ps(nf, _mm_set1_ps(2.12194440e-4f)));
+
+    __m128 p = _mm_set1_ps(1.0f / 720.0f);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 120.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 24.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f / 6.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(0.5f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.0f));
+
+    const __m128i bits = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(p, _mm_castsi128_ps(bits));
+}
+
+// tanh(sqrt(2 / pi) (x + 0.044715 x^3)) = 1 - 2 / (e^2u + 1)
+inline __m128 gelu_tanh_ps(__m128 x) {
+    const __m128 x3 = _mm_mul_ps(_mm_mul_ps(x, x), x);
+    const __m128 u = _mm_mul_ps(_mm_set1_ps(GELU_C), _mm_add_ps(x, _mm_mul_ps(_mm_set1_ps(GELU_A), x3)));
+    const __m128 e = exp_ps(_mm_add_ps(u, u));
+    return _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(_mm_set1_ps(2.0f), _mm_add_ps(e, _mm_set1_ps(1.0f))));
+}
+#endif
+
+struct Moments {
+    float count = 0.0f;
+    float mean = 0.0f;
+    float m2 = 0.0f;   // sum of squared deviations from the mean
+};
+
+// Chan et al.'s pairwise update for two partial Welford states
+Moments merge(const Moments& a, const Moments& b) {
+    if (a.count == 0.0f) return b;
+    if (b.count == 0.0f) return a;
+    Moments out;
+    out.count = a.count + b.count;
+    const float delta = b.mean - a.mean;
+    out.mean = a.mean + delta * (b.count / out.count);
+    out.m2 = a.m2 + b.m2 + delta * delta * (a.count * b.count / out.count);
+    return out;
+}
+
+// Welford over one row. With SSE2, four interleaved streams (element j in
+// lane j % 4) advance together and are merged at the end with the tail.
+Moments row_moments(const float* x, int d) {
+    Moments total;
+    int j = 0;
+#ifdef __SSE2__
+    const int steps = d / 4;
+    if (steps > 0) {
+        __m128 mean = _mm_setzero_ps(), m2 = _mm_setzero_ps();
+        for (int s = 0; s < steps; s++) {
+            const __m128 v = _mm_loadu_ps(x + 4 * s);
+            const __m128 delta = _mm_sub_ps(v, mean);
+            mean = _mm_add_ps(mean, _mm_mul_ps(delta, _mm_set1_ps(1.0f / (s + 1))));
+            m2 = _mm_add_ps(m2, _mm_mul_ps(delta, _mm_sub_ps(v, mean)));
+        }
+        alignas(16) float means[4], m2s[4];
+        _mm_store_ps(means, mean);
+        _mm_store_ps(m2s, m2);
+        for (int lane = 0; lane < 4; lane++)
+            total = merge(total, Moments{static_cast<float>(steps), means[lane], m2s[lane]});
+        j = 4 * steps;
+    }
+#endif
+    Moments tail;
+    for (; j < d; j++) {
+        tail.count += 1.0f;
+        const float delta = x[j] - tail.mean;
+        tail.mean += delta / tail.count;
+        tail.m2 += delta * (x[j] - tail.mean);
+    }
+    return merge(total, tail);
+}
+
+} // namespace
+
+float gelu(float x) {
+    return 0.5f * x * (1.0f + std::tanh(GELU_C * (x + GELU_A * x * x * x)));
+}
+
+float gelu_grad(float x) {
+    const float t = std::tanh(GELU_C * (x + GELU_A * x * x * x));
+    return 0.5f * (1.0f + t) + 0.5f * x * (1.0f - t * t) * GELU_C * (1.0f + 3.0f * GELU_A * x * x);
+}
+
+void gelu(const float* x, float* y, std::size_t n) {
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        const __m128 t = gelu_tanh_ps(v);
+        _mm_storeu_ps(y + i, _mm_mul_ps(_mm_mul_ps(half, v), _mm_add_ps(one, t)));
+    }
+#endif
+    for (; i < n; i++) y[i] = gelu(x[i]);
+}
+
+void gelu_backward(const float* x, const float* grad, float* dx, std::size_t n) {
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f);
+    const __m128 c = _mm_set1_ps(GELU_C), a3 = _mm_set1_ps(3.0f * GELU_A);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        const __m128 t = gelu_tanh_ps(v);
+        // 0.5 (1 + t) + 0.5 x (1 - t^2) c (1 + 3a x^2)
+        const __m128 sech2 = _mm_sub_ps(one, _mm_mul_ps(t, t));
+        const __m128 inner = _mm_mul_ps(c, _mm_add_ps(one, _mm_mul_ps(a3, _mm_mul_ps(v, v))));
+        const __m128 d = _mm_add_ps(_mm_mul_ps(half, _mm_add_ps(one, t)),
+                                    _mm_mul_ps(_mm_mul_ps(half, v), _mm_mul_ps(sech2, inner)));
+        _mm_storeu_ps(dx + i, _mm_add_ps(_mm_loadu_ps(dx + i), _mm_mul_ps(_mm_loadu_ps(grad + i), d)));
+    }
+#endif
+    for (; i < n; i++) dx[i] += grad[i] * gelu_grad(x[i]);
+}
+
+void softmax_exp(const float* x, float* y, std::size_t n, float shift, float scale) {
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128 s = _mm_set1_ps(shift), k = _mm_set1_ps(scale);
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(y + i, exp_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x + i), s), k)));
+#endif
+    for (; i < n; i++) y[i] = std::exp((x[i] - shift) * scale);
+}
+
+float dot(const float* a, const float* b, int n) {
+    int j = 0;
+    float sum = 0.0f;
+#ifdef __SSE2__
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    for (; j + 8 <= n; j += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + j), _mm_loadu_ps(b + j)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + j + 4), _mm_loadu_ps(b + j + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; j < n; j++) sum += a[j] * b[j];
+    return sum;
+}
+
+void axpy(float a, const float* x, float* y, int n) {
+    int j = 0;
+#ifdef __SSE2__
+    const __m128 av = _mm_set1_ps(a);
+    for (; j + 4 <= n; j += 4) _mm_storeu_ps(y + j, _mm_add_ps(_mm_loadu_ps(y + j), _mm_mul_ps(av, _mm_loadu_ps(x + j))));
+#endif
+    for (; j < n; j++) y[j] += a * x[j];
+}
+
+RowNorm layer_norm_row(const float* in, const float* gain, const float* bias, float* out, int d, float eps) {
+    const Moments m = row_moments(in, d);
+    const RowNorm norm{m.mean, 1.0f / std::sqrt(m.m2 / d + eps)};
+    for (int j = 0; j < d; j++) out[j] = (in[j] - norm.mean) * norm.rstd * gain[j] + bias[j];
+    return norm;
+}
@@ -0,0 +1,41 @@
+#ifndef ACTIVATIONS_HPP
+#define ACTIVATIONS_HPP
+
+#include <cstddef>
+
+// ---------------- GELU ----------------
+// tanh approximation: 0.5 x (1 + tanh(sqrt(2 / pi) (x + 0.044715 x^3)))
+float gelu(float x);
+float gelu_grad(float x);
+
+// Bulk forms, four lanes at a time with SSE2. tanh is evaluated as
+// 1 - 2 / (exp(2u) + 1) with a polynomial exp, accurate to a few ulp.
+void gelu(const float* x, float* y, std::size_t n);
+// dx[i] += grad[i] * gelu'(x[i])
+void gelu_backward(const float* x, const float* grad, float* dx, std::size_t n);
+
+// ---------------- EXP ----------------
+// y[i] = exp((x[i] - shift) * scale): softmax numerators at temperature
+// 1 / scale with the usual max subtracted. Uses the GELU kernels' polynomial
+// exp, whose input is clamped to [-87, 87].
+void softmax_exp(const float* x, float* y, std::size_t n, float shift, float scale);
+
+// ---------------- DOT / AXPY ----------------
+// sum of a[j] * b[j], in two four-lane accumulators with SSE2
+float dot(const float* a, const float* b, int n);
+// y += a * x
+void axpy(float a, const float* x, float* y, int n);
+
+// ---------------- LAYER NORM ----------------
+struct RowNorm {
+    float mean;
+    float rstd;   // 1 / sqrt(variance + eps)
+};
+
+// out = (in - mean) * rstd * gain + bias over one row of d. Mean and
+// variance come from one Welford pass (four interleaved streams with SSE2,
+// merged pairwise), then a second pass writes out. Returns the statistics a
+// backward pass needs.
+RowNorm layer_norm_row(const float* in, const float* gain, const float* bias, float* out, int d, float eps = 1e-5f);
+
+#endif // ACTIVATIONS_HPP
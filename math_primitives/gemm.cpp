@@ -0,0 +1,370 @@
+#include "gemm.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <string>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Register tile MR x NR; KC x NC block of B stays packed in L2 while every
+// MR-row panel of A streams past it
+constexpr int MR = 6;
+constexpr int NR = 8;
+constexpr int KC = 256;
+constexpr int NC = 256;
+
+// Products with this few rows (decode steps) spend more time packing B and
+// on the idle rows of partial MR tiles than multiplying, so they stream B
+// unpacked instead
+constexpr int SKINNY_M = 8;
+
+// Operand rows, either through one pointer per row (matrix storage) or as
+// a base pointer and leading dimension (contiguous storage)
+template <typename T>
+struct RowPointers {
+    T* const* rows;
+    T* row(int i) const { return rows[i]; }
+};
+
+template <typename T>
+struct Strided {
+    T* base;
+    std::ptrdiff_t ld;
+    T* row(int i) const { return base + i * ld; }
+};
+
+// Element (i, j) of op(X)
+template <typename View>
+inline float at(const View& x, bool trans, int i, int j) { return trans ? x.row(j)[i] : x.row(i)[j]; }
+
+// Packing buffer reused across the products one thread computes
+struct Workspace {
+    std::vector<float> b_pack;
+    bool b_ready = false;   // b_pack holds the whole of a B shared by every call
+    std::vector<float> a_rows;   // A and C of a skinny product
+    std::vector<float> rows;
+};
+
+// B block rows pc..pc+kc, columns jc..jc+nc as NR-wide panels, each kc x NR,
+// zero-padded past column n
+template <typename View>
+void pack_b(const View& b, bool trans_b, int pc, int kc, int jc, int nc, float* out) {
+    for (int j0 = 0; j0 < nc; j0 += NR) {
+        const int width = std::min(NR, nc - j0);
+        for (int p = 0; p < kc; p++, out += NR) {
+            if (!trans_b && width == NR) {
+                const float* src = b.row(pc + p) + jc + j0;
+                std::copy(src, src + NR, out);
+                continue;
+            }
+            for (int jj = 0; jj < NR; jj++) out[jj] = jj < width ? at(b, trans_b, pc + p, jc + j0 + jj) : 0.0f;
+        }
+    }
+}
+
+// A rows ic..ic+rows, columns pc..pc+kc as one kc x MR panel (column-major in
+// the tile), zero-padded past row m
+template <typename View>
+void pack_a(const View& a, bool trans_a, int ic, int rows, int pc, int kc, float* out) {
+    for (int p = 0; p < kc; p++, out += MR)
+        for (int ii = 0; ii < MR; ii++) out[ii] = ii < rows ? at(a, trans_a, ic + ii, pc + p) : 0.0f;
+}
+
+// tile = A panel * B panel over kc steps
+void kernel(int kc, const float* ap, const float* bp, float* tile) {
+#ifdef __SSE2__
+    __m128 c[MR][2];
+    for (int i = 0; i < MR; i++) c[i][0] = c[i][1] = _mm_setzero_ps();
+    for (int p = 0; p < kc; p++, ap += MR, bp += NR) {
+        const __m128 b0 = _mm_loadu_ps(bp);
+        const __m128 b1 = _mm_loadu_ps(bp + 4);
+        for (int i = 0; i < MR; i++) {
+            const __m128 a = _mm_set1_ps(ap[i]);
+            c[i][0] = _mm_add_ps(c[i][0], _mm_mul_ps(a, b0));
+            c[i][1] = _mm_add_ps(c[i][1], _mm_mul_ps(a, b1));
+        }
+    }
+    for (int i = 0; i < MR; i++) {
+        _mm_storeu_ps(tile + i * NR, c[i][0]);
+        _mm_storeu_ps(tile + i * NR + 4, c[i][1]);
+    }
+#else
+    std::fill(tile, tile + MR * NR, 0.0f);
+    for (int p = 0; p < kc; p++, ap += MR, bp += NR)
+        for (int i = 0; i < MR; i++)
+            for (int j = 0; j < NR; j++) tile[i * NR + j] += ap[i] * bp[j];
+#endif
+}
+
+inline float activate(float v, Activation act) {
+    switch (act) {
+    case Activation::ReLU: return v > 0.0f ? v : 0.0f;
+    case Activation::GELU: return gelu(v);
+    default: return v;
+    }
+}
+
+// Writes the valid rows x cols part of a tile to C at (ic, jc). Partial sums
+// from earlier K blocks (or the old C when accumulating) are added first;
+// bias, pre-activation capture and activation only after the last K block.
+template <typename View>
+void store_tile(const float* tile, int rows, int cols, const View& c, int ic, int jc,
+                bool load_c, bool last_k, const GemmEpilogue& ep) {
+    for (int i = 0; i < rows; i++) {
+        float* dst = c.row(ic + i) + jc;
+        const float* src = tile + i * NR;
+#ifdef __SSE2__
+        if (cols == NR) {
+            __m128 v0 = _mm_loadu_ps(src), v1 = _mm_loadu_ps(src + 4);
+            if (load_c) {
+                v0 = _mm_add_ps(v0, _mm_loadu_ps(dst));
+                v1 = _mm_add_ps(v1, _mm_loadu_ps(dst + 4));
+            }
+            if (last_k) {
+                if (ep.bias) {
+                    v0 = _mm_add_ps(v0, _mm_loadu_ps(ep.bias + jc));
+                    v1 = _mm_add_ps(v1, _mm_loadu_ps(ep.bias + jc + 4));
+                }
+                if (ep.preact) {
+                    _mm_storeu_ps(ep.preact[ic + i] + jc, v0);
+                    _mm_storeu_ps(ep.preact[ic + i] + jc + 4, v1);
+                }
+                if (ep.activation == Activation::ReLU) {
+                    v0 = _mm_max_ps(v0, _mm_setzero_ps());
+                    v1 = _mm_max_ps(v1, _mm_setzero_ps());
+                } else if (ep.activation == Activation::GELU) {
+                    alignas(16) float pre[NR];
+                    _mm_store_ps(pre, v0);
+                    _mm_store_ps(pre + 4, v1);
+                    gelu(pre, dst, NR);
+                    continue;
+                }
+            }
+            _mm_storeu_ps(dst, v0);
+            _mm_storeu_ps(dst + 4, v1);
+            continue;
+        }
+#endif
+        for (int j = 0; j < cols; j++) {
+            float v = src[j];
+            if (load_c) v += dst[j];
+            if (last_k) {
+                if (ep.bias) v += ep.bias[jc + j];
+                if (ep.preact) ep.preact[ic + i][jc + j] = v;
+                v = activate(v, ep.activation);
+            }
+            dst[j] = v;
+        }
+    }
+}
+
+std::vector<float*> row_pointers(matrix& m) {
+    std::vector<float*> rows(m.size());
+    for (int i = 0; i < m.size(); i++) rows[i] = m[i].size() ? &m[i][0] : nullptr;
+    return rows;
+}
+
+std::vector<const float*> row_pointers(const matrix& m) {
+    std::vector<const float*> rows(m.size());
+    for (int i = 0; i < m.size(); i++) rows[i] = m[i].size() ? &m[i][0] : nullptr;
+    return rows;
+}
+
+void check_arguments(int m, int n, int k, const GemmEpilogue& ep) {
+    if (m < 0 || n < 0 || k < 0) throw std::invalid_argument("Negative GEMM dimension");
+    if (ep.accumulate && ep.activation != Activation::None)
+        throw std::invalid_argument("Accumulating GEMM cannot apply an activation");
+}
+
+// Product with few rows, without packing: every row of B is read once and
+// applied to all m output rows while it is in L1. Without trans_b an output
+// row is a sum of B rows scaled by A's entries; with it, one dot product
+// per column. Rows are built in rows (m x n) and then stored through the
+// epilogue NR columns at a time.
+template <typename AView, typename BView, typename CView>
+void gemm_skinny(int m, int n, int k, const AView& a, bool trans_a, const BView& b, bool trans_b,
+                 const CView& c, const GemmEpilogue& ep, Workspace& ws) {
+    ws.a_rows.resize(static_cast<std::size_t>(m) * k);
+    ws.rows.assign(static_cast<std::size_t>(m) * n, 0.0f);
+    for (int i = 0; i < m; i++)
+        for (int p = 0; p < k; p++) ws.a_rows[static_cast<std::size_t>(i) * k + p] = at(a, trans_a, i, p);
+
+    if (trans_b) {
+        for (int j = 0; j < n; j++) {
+            const float* bj = b.row(j);
+            for (int i = 0; i < m; i++) {
+                const float* ai = ws.a_rows.data() + static_cast<std::size_t>(i) * k;
+                int p = 0;
+                float sum = 0.0f;
+#ifdef __SSE2__
+                __m128 acc = _mm_setzero_ps();
+                for (; p + 4 <= k; p += 4)
+                    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(ai + p), _mm_loadu_ps(bj + p)));
+                alignas(16) float lanes[4];
+                _mm_store_ps(lanes, acc);
+                sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+                for (; p < k; p++) sum += ai[p] * bj[p];
+                ws.rows[static_cast<std::size_t>(i) * n + j] = sum;
+            }
+        }
+    } else {
+        for (int p = 0; p < k; p++) {
+            const float* bp = b.row(p);
+            for (int i = 0; i < m; i++) {
+                const float aip = ws.a_rows[static_cast<std::size_t>(i) * k + p];
+                float* out = ws.rows.data() + static_cast<std::size_t>(i) * n;
+                int j = 0;
+#ifdef __SSE2__
+                const __m128 av = _mm_set1_ps(aip);
+                for (; j + 4 <= n; j += 4)
+                    _mm_storeu_ps(out + j, _mm_add_ps(_mm_loadu_ps(out + j), _mm_mul_ps(av, _mm_loadu_ps(bp + j))));
+#endif
+                for (; j < n; j++) out[j] += aip * bp[j];
+            }
+        }
+    }
+
+    for (int i = 0; i < m; i++) {
+        const float* out = ws.rows.data() + static_cast<std::size_t>(i) * n;
+        for (int jc = 0; jc < n; jc += NR)
+            store_tile(out + jc, 1, std::min(NR, n - jc), c, i, jc, ep.accumulate, true, ep);
+    }
+}
+
+// The blocked product for any operand layout. With b_shared every call on
+// this workspace multiplies by the same B, so when B fits in one KC x NC
+// block it is packed by the first call only.
+template <typename AView, typename BView, typename CView>
+void gemm_blocked(int m, int n, int k, const AView& a, bool trans_a, const BView& b, bool trans_b,
+                  const CView& c, const GemmEpilogue& ep, Workspace& ws, bool b_shared) {
+    if (m == 0 || n == 0) return;
+
+    if (k == 0) {
+        // Empty product: the epilogue alone defines C
+        alignas(16) float zero[MR * NR] = {};
+        for (int ic = 0; ic < m; ic += MR)
+            for (int jc = 0; jc < n; jc += NR)
+                store_tile(zero, std::min(MR, m - ic), std::min(NR, n - jc), c, ic, jc, ep.accumulate, true, ep);
+        return;
+    }
+    if (m <= SKINNY_M) {
+        gemm_skinny(m, n, k, a, trans_a, b, trans_b, c, ep, ws);
+        return;
+    }
+
+    // Sized for the largest block this product needs, not the KC x NC maximum
+    const std::size_t pack_size = static_cast<std::size_t>(std::min(KC, k)) * ((std::min(NC, n) + NR - 1) / NR * NR);
+    if (ws.b_pack.size() < pack_size) {
+        ws.b_pack.resize(pack_size);
+        ws.b_ready = false;
+    }
+    const bool single_block = n <= NC && k <= KC;
+    if (!b_shared || !single_block) ws.b_ready = false;
+    alignas(16) float a_pack[MR * KC];
+    alignas(16) float tile[MR * NR];
+
+    for (int jc = 0; jc < n; jc += NC) {
+        const int nc = std::min(NC, n - jc);
+        for (int pc = 0; pc < k; pc += KC) {
+            const int kc = std::min(KC, k - pc);
+            const bool load_c = pc > 0 || ep.accumulate;
+            const bool last_k = pc + kc == k;
+            if (!ws.b_ready) pack_b(b, trans_b, pc, kc, jc, nc, ws.b_pack.data());
+            ws.b_ready = b_shared && single_block;
+
+            for (int ic = 0; ic < m; ic += MR) {
+                const int rows = std::min(MR, m - ic);
+                pack_a(a, trans_a, ic, rows, pc, kc, a_pack);
+                for (int j0 = 0; j0 < nc; j0 += NR) {
+                    kernel(kc, a_pack, ws.b_pack.data() + static_cast<std::size_t>(j0) * kc, tile);
+                    store_tile(tile, rows, std::min(NR, nc - j0), c, ic, jc + j0, load_c, last_k, ep);
+                }
+            }
+        }
+    }
+}
+
+// Runs one(i, workspace) for i in [0, batch) across the pool. Each chunk of
+// the batch owns a workspace, so packing buffers are allocated once per
+// chunk rather than once per product.
+template <typename F>
+void for_each_batch(int batch, ThreadPool& pool, const F& one) {
+    pool.parallel_for(0, static_cast<std::size_t>(batch), [&](std::size_t lo, std::size_t hi) {
+        Workspace ws;
+        for (std::size_t i = lo; i < hi; i++) one(static_cast<int>(i), ws);
+    });
+}
+
+} // namespace
+
+void gemm(int m, int n, int k,
+          const float* const* a, bool trans_a,
+          const float* const* b, bool trans_b,
+          float* const* c, const GemmEpilogue& ep) {
+    check_arguments(m, n, k, ep);
+    Workspace ws;
+    gemm_blocked(m, n, k, RowPointers<const float>{a}, trans_a, RowPointers<const float>{b}, trans_b,
+                 RowPointers<float>{c}, ep, ws, false);
+}
+
+void gemm(const matrix& a, bool trans_a, const matrix& b, bool trans_b, matrix& c, const GemmEpilogue& ep) {
+    const int a_rows = a.size(), a_cols = a.size() ? a[0].size() : 0;
+    const int b_rows = b.size(), b_cols = b.size() ? b[0].size() : 0;
+    const int m = trans_a ? a_cols : a_rows;
+    const int k = trans_a ? a_rows : a_cols;
+    const int k2 = trans_b ? b_cols : b_rows;
+    const int n = trans_b ? b_rows : b_cols;
+    if (k != k2) {
+        throw std::invalid_argument("Incompatible shapes for gemm: (" + shape_of(a) + (trans_a ? ")^T" : ")") +
+                                    " * (" + shape_of(b) + (trans_b ? ")^T" : ")"));
+    }
+    if (c.size() != m || (m > 0 && c[0].size() != n))
+        throw std::invalid_argument("gemm output is " + shape_of(c) + ", expected " + std::to_string(m) + "x" +
+                                    std::to_string(n));
+
+    std::vector<const float*> a_rows_p = row_pointers(a);
+    std::vector<const float*> b_rows_p = row_pointers(b);
+    std::vector<float*> c_rows_p = row_pointers(c);
+    gemm(m, n, k, a_rows_p.data(), trans_a, b_rows_p.data(), trans_b, c_rows_p.data(), ep);
+}
+
+// ---------------- BATCHED GEMM ----------------
+void gemm_strided_batched(int batch, int m, int n, int k,
+                          const float* a, int lda, std::ptrdiff_t stride_a, bool trans_a,
+                          const float* b, int ldb, std::ptrdiff_t stride_b, bool trans_b,
+                          float* c, int ldc, std::ptrdiff_t stride_c,
+                          const GemmEpilogue& ep, ThreadPool& pool) {
+    check_arguments(m, n, k, ep);
+    if (batch < 0) throw std::invalid_argument("Negative GEMM batch");
+    if (ep.preact) throw std::invalid_argument("Batched GEMM cannot capture pre-activations");
+    if (lda < (trans_a ? m : k) || ldb < (trans_b ? k : n) || ldc < n)
+        throw std::invalid_argument("Leading dimension shorter than a row in strided batched gemm");
+
+    for_each_batch(batch, pool, [&](int i, Workspace& ws) {
+        gemm_blocked(m, n, k, Strided<const float>{a + i * stride_a, lda}, trans_a,
+                     Strided<const float>{b + i * stride_b, ldb}, trans_b, Strided<float>{c + i * stride_c, ldc}, ep,
+                     ws, stride_b == 0);
+    });
+}
+
+void gemm_batched(int batch, int m, int n, int k,
+                  const float* const* a, std::ptrdiff_t stride_a, bool trans_a,
+                  const float* const* b, std::ptrdiff_t stride_b, bool trans_b,
+                  float* const* c, std::ptrdiff_t stride_c,
+                  const GemmEpilogue& ep, ThreadPool& pool) {
+    check_arguments(m, n, k, ep);
+    if (batch < 0) throw std::invalid_argument("Negative GEMM batch");
+    if (ep.preact) throw std::invalid_argument("Batched GEMM cannot capture pre-activations");
+
+    for_each_batch(batch, pool, [&](int i, Workspace& ws) {
+        gemm_blocked(m, n, k, RowPointers<const float>{a + i * stride_a}, trans_a,
+                     RowPointers<const float>{b + i * stride_b}, trans_b, RowPointers<float>{c + i * stride_c}, ep,
+                     ws, stride_b == 0);
+    });
+}
@@ -0,0 +1,64 @@
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include <cstddef>
+#include "vector.hpp"
+#include "activations.hpp"
+#include "../utils/thread_pool.hpp"
+
+// ---------------- GEMM ----------------
+// Single-precision C = op(A) * op(B) for row-major operands given as one
+// pointer per row, which is how matrix stores its data. op(X) is X or X^T.
+// A and B are packed into contiguous panels (MR rows of A, NR columns of B,
+// KC deep) and multiplied by an MR x NR register-tile kernel; the epilogue
+// is applied to each tile right after its last K block, before it is stored.
+
+enum class Activation { None, ReLU, GELU };
+
+struct GemmEpilogue {
+    const float* bias = nullptr;       // length n, added to every row of C
+    Activation activation = Activation::None;
+    float* const* preact = nullptr;    // optional m rows receiving A*B + bias before activation
+    bool accumulate = false;           // C += A*B instead of C = ...; needs Activation::None
+};
+
+// m x n result, k the shared dimension. Row pointers of A are for the m x k
+// matrix (k x m if trans_a); likewise B is k x n (n x k if trans_b).
+void gemm(int m, int n, int k,
+          const float* const* a, bool trans_a,
+          const float* const* b, bool trans_b,
+          float* const* c, const GemmEpilogue& epilogue = GemmEpilogue());
+
+// Shape-checked form on matrices; c must already be m x n
+void gemm(const matrix& a, bool trans_a, const matrix& b, bool trans_b, matrix& c,
+          const GemmEpilogue& epilogue = GemmEpilogue());
+
+// ---------------- BATCHED GEMM ----------------
+// batch independent products C_i = op(A_i) * op(B_i), all m x n with shared
+// dimension k, for the many small GEMMs of multi-head attention and
+// per-sample ops. The batch is split across the pool; each chunk of it
+// reuses one packing buffer, and a B with stride 0 (one B for the whole
+// batch) that fits in a single block is packed once per chunk. The
+// epilogue applies to every product; pre-activation capture is not
+// supported.
+//
+// Strided form on contiguous row-major storage: X_i starts at
+// x + i * stride_x and its rows are ldx floats apart, so one head of a
+// seq x (heads * dh) buffer is x + h * dh with ldx = heads * dh.
+void gemm_strided_batched(int batch, int m, int n, int k,
+                          const float* a, int lda, std::ptrdiff_t stride_a, bool trans_a,
+                          const float* b, int ldb, std::ptrdiff_t stride_b, bool trans_b,
+                          float* c, int ldc, std::ptrdiff_t stride_c,
+                          const GemmEpilogue& epilogue = GemmEpilogue(),
+                          ThreadPool& pool = default_thread_pool());
+
+// Row-pointer form for matrix storage: the rows of X_i are
+// x[i * stride_x] onwards, stride counted in rows
+void gemm_batched(int batch, int m, int n, int k,
+                  const float* const* a, std::ptrdiff_t stride_a, bool trans_a,
+                  const float* const* b, std::ptrdiff_t stride_b, bool trans_b,
+                  float* const* c, std::ptrdiff_t stride_c,
+                  const GemmEpilogue& epilogue = GemmEpilogue(),
+                  ThreadPool& pool = default_thread_pool());
+
+#endif // GEMM_HPP
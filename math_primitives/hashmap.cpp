@@ -1,46 +1,153 @@
 #include "hashmap.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-int hash_code(MyList<char>& chars)  {
-  int hash = 0;
-  int a{33};
-  int p = 1;
-  for (int i = 0; i < chars.size(); i++) {
-    hash += static_cast<unsigned>(chars[i]) * p;
-    p *= a;
-  }
-  return hash;
+
+// ---------------- HASH FUNCTIONS ----------------
+namespace {
+
+constexpr std::uint64_t SECRET0 = 0xa0761d6478bd642full;
+constexpr std::uint64_t SECRET1 = 0xe7037ed1a0b428dbull;
+constexpr std::uint64_t SECRET2 = 0x8ebc6af09c88c6e3ull;
+constexpr std::uint64_t SECRET3 = 0x589965cc75374cc3ull;
+
+inline std::uint64_t mix(std::uint64_t a, std::uint64_t b) {
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
 }
 
+inline std::uint64_t read8(const unsigned char* p) {
+  std::uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+inline std::uint64_t read4(const unsigned char* p) {
+  std::uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
 
-mathVector sieve_of_eratosthenes(int limit) {
-  mathVector composites{ };
-  mathVector primes { };
-  for (int i = 2; i <= limit; i++) {
-    if (not composites.search(i)) {
-      primes.push(i);
+// 1 to 3 bytes, each byte read at least once
+inline std::uint64_t read_small(const unsigned char* p, std::size_t k) {
+  return (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // namespace
+
+std::uint64_t hash_bytes(const void* data, std::size_t len, std::uint64_t seed) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  std::uint64_t a, b;
+  seed ^= mix(seed ^ SECRET0, SECRET1);
+
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+      b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = read_small(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    std::size_t i = len;
+    if (i > 48) {
+      std::uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = mix(read8(p) ^ SECRET1, read8(p + 8) ^ seed);
+        see1 = mix(read8(p + 16) ^ SECRET2, read8(p + 24) ^ see1);
+        see2 = mix(read8(p + 32) ^ SECRET3, read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
     }
-    for (int j = 1; j <= limit/i; j++) {
-      composites.push(i*j);
+    while (i > 16) {
+      seed = mix(read8(p) ^ SECRET1, read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
     }
-    
+    a = read8(p + i - 16);
+    b = read8(p + i - 8);
   }
-  return primes;
+
+  a ^= SECRET1;
+  b ^= seed;
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  a = static_cast<std::uint64_t>(r);
+  b = static_cast<std::uint64_t>(r >> 64);
+  return mix(a ^ SECRET0 ^ len, b ^ SECRET1);
 }
 
-int compression_function(int hash_code, int N) {
-  return hash_code % N;
+std::uint64_t hash_code(const MyList<char>& chars) {
+  if (chars.size() == 0) return hash_bytes(nullptr, 0);
+  return hash_bytes(&chars[0], chars.size());
 }
 
 
-int main() {
-  MyList<char> string;
-  string.push('c');
-  string.push('b');
-  string.push('c');
-  mathVector platypus = sieve_of_eratosthenes(100);
-  int hashed;
-  hashed = hash_code(string);
-  std::cout << compression_function(hashed, platypus[(platypus.size()-1)]) << std::endl;
+// ---------------- PRIMES ----------------
+std::vector<std::uint32_t> sieve_of_eratosthenes(std::uint32_t limit) {
+  std::vector<std::uint32_t> primes;
+  if (limit < 2) return primes;
+  primes.reserve(limit < 100 ? 32 : static_cast<std::size_t>(limit / (std::log(limit) - 1.1)));
+  primes.push_back(2);
 
-  return 0;
-};
+  // Odd base primes up to sqrt(limit), from a small plain sieve
+  std::uint32_t root = static_cast<std::uint32_t>(std::sqrt(static_cast<double>(limit)));
+  while (static_cast<std::uint64_t>(root + 1) * (root + 1) <= limit) root++;
+  while (static_cast<std::uint64_t>(root) * root > limit) root--;
+  std::vector<char> small(root + 1, 1);
+  std::vector<std::uint32_t> base;
+  for (std::uint32_t i = 3; i <= root; i += 2) {
+    if (!small[i]) continue;
+    base.push_back(i);
+    for (std::uint64_t j = static_cast<std::uint64_t>(i) * i; j <= root; j += 2 * i)
+      small[j] = 0;
+  }
+
+  // One bit per odd number; a segment is 32 KiB of bits
+  constexpr std::uint64_t SEGMENT_WORDS = 4096;
+  constexpr std::uint64_t SEGMENT_ODDS = SEGMENT_WORDS * 64;
+  std::vector<std::uint64_t> bits(SEGMENT_WORDS);
+  std::vector<std::uint64_t> next_multiple;  // next odd multiple to strike, per base prime
+  next_multiple.reserve(base.size());
+
+  for (std::uint64_t low = 3; low <= limit; low += 2 * SEGMENT_ODDS) {
+    std::uint64_t high = std::min<std::uint64_t>(limit, low + 2 * SEGMENT_ODDS - 1);
+    std::uint64_t odds = (high - low) / 2 + 1;
+    std::fill(bits.begin(), bits.end(), ~0ull);
+
+    while (next_multiple.size() < base.size() &&
+           static_cast<std::uint64_t>(base[next_multiple.size()]) * base[next_multiple.size()] <= high) {
+      std::uint64_t p = base[next_multiple.size()];
+      next_multiple.push_back(p * p);
+    }
+
+    for (std::size_t k = 0; k < next_multiple.size(); k++) {
+      std::uint64_t step = 2ull * base[k];
+      std::uint64_t m = next_multiple[k];
+      for (; m <= high; m += step) {
+        std::uint64_t bit = (m - low) / 2;
+        bits[bit / 64] &= ~(1ull << (bit % 64));
+      }
+      next_multiple[k] = m;
+    }
+
+    std::uint64_t words = (odds + 63) / 64;
+    for (std::uint64_t w = 0; w < words; w++) {
+      std::uint64_t word = bits[w];
+      if (w == words - 1 && odds % 64 != 0) word &= (1ull << (odds % 64)) - 1;
+      while (word) {
+        std::uint64_t bit = w * 64 + __builtin_ctzll(word);
+        primes.push_back(static_cast<std::uint32_t>(low + 2 * bit));
+        word &= word - 1;
+      }
+    }
+  }
+  return primes;
+}
+
+std::uint64_t compression_function(std::uint64_t hash_code, std::uint64_t N) {
+  return hash_code % N;
+}
@@ -1,11 +1,433 @@
 #ifndef HASHMAP_HPP
 #define HASHMAP_HPP
 #include "vector.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // These earlier lines ensure that this file has not been included more than once in the same compilation
 
-int hash_code(MyList<char>& chars);
-mathVector sieve_of_eratosthenes(int limit) ;
-  
+// ---------------- HASH FUNCTIONS ----------------
+// wyhash-style byte hash: 64-bit multiply-mix, reads 8 bytes at a time
+std::uint64_t hash_bytes(const void* data, std::size_t len, std::uint64_t seed = 0);
+
+// Avalanche a 64-bit integer so low and high bits are both usable
+inline std::uint64_t hash_u64(std::uint64_t x) {
+  __uint128_t r = static_cast<__uint128_t>(x ^ 0xa0761d6478bd642full) * 0xe7037ed1a0b428dbull;
+  return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+}
+
+std::uint64_t hash_code(const MyList<char>& chars);
+std::uint64_t compression_function(std::uint64_t hash_code, std::uint64_t N);
+
+// ---------------- PRIMES ----------------
+// All primes <= limit. Segmented, odd-only bitset sieve: each segment fits in
+// L1, so the work is O(n log log n) with O(sqrt(n) + segment) extra memory.
+std::vector<std::uint32_t> sieve_of_eratosthenes(std::uint32_t limit);
+
+// Prime table sizes, each roughly double the previous one
+constexpr std::uint64_t PRIME_CAPACITIES[] = {
+  2ull, 3ull, 5ull, 11ull, 23ull, 53ull, 97ull, 193ull, 389ull, 769ull, 1543ull,
+  3079ull, 6151ull, 12289ull, 24593ull, 49157ull, 98317ull, 196613ull, 393241ull,
+  786433ull, 1572869ull, 3145739ull, 6291469ull, 12582917ull, 25165843ull,
+  50331653ull, 100663319ull, 201326611ull, 402653189ull, 805306457ull,
+  1610612741ull, 3221225473ull, 4294967291ull
+};
+constexpr std::size_t PRIME_CAPACITY_COUNT = sizeof(PRIME_CAPACITIES) / sizeof(PRIME_CAPACITIES[0]);
+
+// Index of the smallest table prime >= n, or PRIME_CAPACITY_COUNT if none
+constexpr std::size_t prime_capacity_index(std::uint64_t n) {
+  std::size_t i = 0;
+  while (i < PRIME_CAPACITY_COUNT && PRIME_CAPACITIES[i] < n) i++;
+  return i;
+}
+
+constexpr std::uint64_t next_prime_capacity(std::uint64_t n) {
+  return prime_capacity_index(n) < PRIME_CAPACITY_COUNT
+    ? PRIME_CAPACITIES[prime_capacity_index(n)]
+    : throw std::length_error("next_prime_capacity: no table prime that large");
+}
+
+// ---------------- GROWTH POLICIES ----------------
+// How a table maps hashes onto its groups and which group counts it allows.
+// round_up gives the smallest allowed count >= n; set_groups is called
+// whenever the table is (re)allocated.
+
+// Power-of-two group counts: index is a mask, probing is triangular
+struct PowerOfTwoGrowth {
+  std::size_t mask = 0;
+
+  static std::size_t round_up(std::size_t n) {
+    std::size_t groups = 1;
+    while (groups < n) groups *= 2;
+    return groups;
+  }
+  void set_groups(std::size_t groups) { mask = groups - 1; }
+  std::size_t index(std::uint64_t h) const { return static_cast<std::size_t>(h) & mask; }
+  std::size_t next(std::size_t group, std::size_t step) const { return (group + step) & mask; }
+};
+
+// Prime group counts from PRIME_CAPACITIES: tolerates weak hashes whose low
+// bits are patterned. The modulus is dispatched through a table of functions
+// with a constant divisor each, so it compiles to a multiply, not a divide.
+struct PrimeGrowth {
+  using ModFn = std::uint64_t (*)(std::uint64_t);
+
+  std::size_t groups = 1;
+  ModFn mod = &mod_by<0>;
+
+  static std::size_t round_up(std::size_t n) { return static_cast<std::size_t>(next_prime_capacity(n)); }
+  void set_groups(std::size_t g) {
+    groups = g;
+    mod = mod_table()[prime_capacity_index(g)];
+  }
+  std::size_t index(std::uint64_t h) const { return static_cast<std::size_t>(mod(h)); }
+  std::size_t next(std::size_t group, std::size_t) const { return group + 1 == groups ? 0 : group + 1; }
+
+private:
+  template <std::size_t I>
+  static std::uint64_t mod_by(std::uint64_t h) { return h % PRIME_CAPACITIES[I]; }
+
+  template <std::size_t... I>
+  static const ModFn* make_mod_table(std::index_sequence<I...>) {
+    static const ModFn table[] = {&mod_by<I>...};
+    return table;
+  }
+  static const ModFn* mod_table() {
+    return make_mod_table(std::make_index_sequence<PRIME_CAPACITY_COUNT>());
+  }
+};
+
+// Default hashers. The string ones are transparent, so a map keyed by
+// std::string can be probed with a std::string_view or a literal.
+template <typename Key, typename Enable = void>
+struct FlatHash;
+
+template <typename Key>
+struct FlatHash<Key, typename std::enable_if<std::is_integral<Key>::value || std::is_enum<Key>::value>::type> {
+  std::uint64_t operator()(Key key) const { return hash_u64(static_cast<std::uint64_t>(key)); }
+};
+
+template <>
+struct FlatHash<std::string> {
+  using is_transparent = void;
+  std::uint64_t operator()(std::string_view s) const { return hash_bytes(s.data(), s.size()); }
+};
+
+template <>
+struct FlatHash<std::string_view> : FlatHash<std::string> {};
+
+// ---------------- FLAT HASH MAP ----------------
+// Open addressing with SwissTable-style control bytes. Slots are split into
+// groups of 16; each slot has one control byte holding either EMPTY, DELETED
+// or the low 7 bits of its key's hash. A lookup compares all 16 control bytes
+// of a group at once (one SSE2 compare + movemask) and only touches slots
+// whose 7-bit tag matches, then moves to the next group chosen by the
+// growth policy.
+template <typename Key, typename Value,
+          typename Hash = FlatHash<Key>,
+          typename Equal = std::equal_to<>,
+          typename GrowthPolicy = PowerOfTwoGrowth>
+class FlatHashMap {
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+
+private:
+  static constexpr std::int8_t EMPTY = -128;
+  static constexpr std::int8_t DELETED = -2;
+  static constexpr int GROUP_WIDTH = 16;
+
+  // 16 control bytes and the bitmask queries a probe needs
+  struct Group {
+#ifdef __SSE2__
+    __m128i ctrl;
+    explicit Group(const std::int8_t* p)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+    std::uint32_t match(std::int8_t tag) const {
+      return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl)));
+    }
+    std::uint32_t match_empty_or_deleted() const {
+      return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl)));
+    }
+#else
+    const std::int8_t* ctrl;
+    explicit Group(const std::int8_t* p) : ctrl(p) {}
+    std::uint32_t match(std::int8_t tag) const {
+      std::uint32_t mask = 0;
+      for (int i = 0; i < GROUP_WIDTH; i++)
+        if (ctrl[i] == tag) mask |= 1u << i;
+      return mask;
+    }
+    std::uint32_t match_empty_or_deleted() const {
+      std::uint32_t mask = 0;
+      for (int i = 0; i < GROUP_WIDTH; i++)
+        if (ctrl[i] < -1) mask |= 1u << i;
+      return mask;
+    }
+#endif
+    std::uint32_t match_empty() const { return match(EMPTY); }
+  };
+
+  std::int8_t* ctrl_ = nullptr;
+  value_type* slots_ = nullptr;
+  std::size_t capacity_ = 0;     // slots, a multiple of GROUP_WIDTH
+  std::size_t size_ = 0;
+  std::size_t growth_left_ = 0;  // inserts into EMPTY slots before a rehash
+  Hash hasher_;
+  Equal equal_;
+  GrowthPolicy policy_;
+
+  static std::int8_t tag_of(std::uint64_t hash) { return static_cast<std::int8_t>(hash & 0x7F); }
+  static std::size_t max_load(std::size_t capacity) { return capacity - capacity / 8; }
+  std::size_t group_count() const { return capacity_ / GROUP_WIDTH; }
+
+  std::size_t probe_start(std::uint64_t hash) const { return policy_.index(hash >> 7); }
+  std::size_t probe_next(std::size_t group, std::size_t step) const { return policy_.next(group, step); }
+
+  template <typename K2>
+  std::size_t find_index(const K2& key, std::uint64_t hash) const {
+    if (capacity_ == 0) return capacity_;
+    const std::int8_t tag = tag_of(hash);
+    std::size_t group = probe_start(hash);
+    for (std::size_t step = 1; ; step++) {
+      Group g(ctrl_ + group * GROUP_WIDTH);
+      for (std::uint32_t m = g.match(tag); m != 0; m &= m - 1) {
+        std::size_t idx = group * GROUP_WIDTH + __builtin_ctz(m);
+        if (equal_(slots_[idx].first, key)) return idx;
+      }
+      if (g.match_empty() != 0) return capacity_;
+      group = probe_next(group, step);
+    }
+  }
+
+  // First EMPTY or DELETED slot on the probe sequence of `hash`
+  std::size_t find_insert_slot(std::uint64_t hash) const {
+    std::size_t group = probe_start(hash);
+    for (std::size_t step = 1; ; step++) {
+      Group g(ctrl_ + group * GROUP_WIDTH);
+      std::uint32_t m = g.match_empty_or_deleted();
+      if (m != 0) return group * GROUP_WIDTH + __builtin_ctz(m);
+      group = probe_next(group, step);
+    }
+  }
+
+  void allocate(std::size_t capacity) {
+    capacity_ = capacity;
+    policy_.set_groups(capacity / GROUP_WIDTH);
+    ctrl_ = static_cast<std::int8_t*>(::operator new(capacity));
+    std::memset(ctrl_, EMPTY, capacity);
+    slots_ = static_cast<value_type*>(::operator new(capacity * sizeof(value_type)));
+    growth_left_ = max_load(capacity);
+  }
+
+  void destroy_and_free() {
+    if (!ctrl_) return;
+    for (std::size_t i = 0; i < capacity_; i++)
+      if (ctrl_[i] >= 0) slots_[i].~value_type();
+    ::operator delete(ctrl_);
+    ::operator delete(slots_);
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = size_ = growth_left_ = 0;
+  }
+
+  void rehash(std::size_t new_capacity) {
+    std::int8_t* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    std::size_t old_capacity = capacity_;
+
+    allocate(new_capacity);
+    for (std::size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] < 0) continue;
+      std::uint64_t hash = hasher_(old_slots[i].first);
+      std::size_t idx = find_insert_slot(hash);
+      ctrl_[idx] = tag_of(hash);
+      new (&slots_[idx]) value_type(std::move(old_slots[i]));
+      old_slots[i].~value_type();
+    }
+    growth_left_ -= size_;
+
+    ::operator delete(old_ctrl);
+    ::operator delete(old_slots);
+  }
+
+  static std::size_t capacity_for(std::size_t n) {
+    std::size_t groups = GrowthPolicy::round_up(1);
+    while (max_load(groups * GROUP_WIDTH) < n) groups = GrowthPolicy::round_up(groups + 1);
+    return groups * GROUP_WIDTH;
+  }
+
+  // Make room for one more element; drops tombstones when they are the problem
+  void prepare_insert() {
+    if (capacity_ == 0) {
+      allocate(capacity_for(1));
+    } else if (growth_left_ == 0) {
+      std::size_t tombstones = max_load(capacity_) - size_;
+      rehash(tombstones > size_ / 2 ? capacity_ : GrowthPolicy::round_up(group_count() + 1) * GROUP_WIDTH);
+    }
+  }
+
+public:
+  // ---------------- ITERATOR ----------------
+  template <bool Const>
+  class Iter {
+    using Map = typename std::conditional<Const, const FlatHashMap, FlatHashMap>::type;
+    using Ref = typename std::conditional<Const, const value_type&, value_type&>::type;
+    using Ptr = typename std::conditional<Const, const value_type*, value_type*>::type;
+    Map* map;
+    std::size_t idx;
+
+    void skip_free() { while (idx < map->capacity_ && map->ctrl_[idx] < 0) idx++; }
+
+  public:
+    Iter(Map* m, std::size_t i) : map(m), idx(i) { skip_free(); }
+    operator Iter<true>() const { return Iter<true>(map, idx); }
+    Ref operator*() const { return map->slots_[idx]; }
+    Ptr operator->() const { return &map->slots_[idx]; }
+    Iter& operator++() { idx++; skip_free(); return *this; }
+    bool operator==(const Iter& other) const { return idx == other.idx; }
+    bool operator!=(const Iter& other) const { return idx != other.idx; }
+  };
+  using iterator = Iter<false>;
+  using const_iterator = Iter<true>;
+
+  FlatHashMap() = default;
+  explicit FlatHashMap(std::size_t expected) { reserve(expected); }
+  // Stateful hashers, e.g. ones that look keys up in an external pool
+  FlatHashMap(std::size_t expected, const Hash& hash, const Equal& equal = Equal())
+    : hasher_(hash), equal_(equal) { reserve(expected); }
+
+  FlatHashMap(const FlatHashMap& other) : hasher_(other.hasher_), equal_(other.equal_) {
+    reserve(other.size_);
+    for (const auto& kv : other) insert(kv);
+  }
+
+  FlatHashMap(FlatHashMap&& other) noexcept
+    : ctrl_(other.ctrl_), slots_(other.slots_), capacity_(other.capacity_),
+      size_(other.size_), growth_left_(other.growth_left_),
+      hasher_(std::move(other.hasher_)), equal_(std::move(other.equal_)), policy_(other.policy_) {
+    other.ctrl_ = nullptr;
+    other.slots_ = nullptr;
+    other.capacity_ = other.size_ = other.growth_left_ = 0;
+  }
+
+  FlatHashMap& operator=(FlatHashMap other) {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(hasher_, other.hasher_);
+    std::swap(equal_, other.equal_);
+    std::swap(policy_, other.policy_);
+    return *this;
+  }
+
+  ~FlatHashMap() { destroy_and_free(); }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  std::size_t capacity() const { return capacity_; }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  void reserve(std::size_t n) {
+    std::size_t cap = capacity_for(n);
+    if (cap > capacity_) {
+      if (capacity_ == 0) allocate(cap);
+      else rehash(cap);
+    }
+  }
+
+  void clear() {
+    for (std::size_t i = 0; i < capacity_; i++)
+      if (ctrl_[i] >= 0) slots_[i].~value_type();
+    if (ctrl_) std::memset(ctrl_, EMPTY, capacity_);
+    size_ = 0;
+    growth_left_ = max_load(capacity_);
+  }
+
+  template <typename K2>
+  iterator find(const K2& key) { return iterator(this, find_index(key, hasher_(key))); }
+  template <typename K2>
+  const_iterator find(const K2& key) const { return const_iterator(this, find_index(key, hasher_(key))); }
+
+  template <typename K2>
+  bool contains(const K2& key) const { return find_index(key, hasher_(key)) != capacity_; }
+  template <typename K2>
+  std::size_t count(const K2& key) const { return contains(key) ? 1 : 0; }
+
+  template <typename K2>
+  Value& at(const K2& key) {
+    std::size_t idx = find_index(key, hasher_(key));
+    if (idx == capacity_) throw std::out_of_range("FlatHashMap::at: key not found");
+    return slots_[idx].second;
+  }
+  template <typename K2>
+  const Value& at(const K2& key) const {
+    std::size_t idx = find_index(key, hasher_(key));
+    if (idx == capacity_) throw std::out_of_range("FlatHashMap::at: key not found");
+    return slots_[idx].second;
+  }
+
+  // Inserts Value(args...) under `key` unless the key is present. `key` may be
+  // any type the hasher and Equal accept; Key is only built on insertion.
+  template <typename K2, typename... Args>
+  std::pair<iterator, bool> try_emplace(K2&& key, Args&&... args) {
+    std::uint64_t hash = hasher_(key);
+    std::size_t idx = find_index(key, hash);
+    if (idx != capacity_) return {iterator(this, idx), false};
+
+    prepare_insert();
+    idx = find_insert_slot(hash);
+    if (ctrl_[idx] == EMPTY) growth_left_--;
+    new (&slots_[idx]) value_type(std::piecewise_construct,
+                                  std::forward_as_tuple(std::forward<K2>(key)),
+                                  std::forward_as_tuple(std::forward<Args>(args)...));
+    ctrl_[idx] = tag_of(hash);
+    size_++;
+    return {iterator(this, idx), true};
+  }
+
+  std::pair<iterator, bool> insert(const value_type& kv) { return try_emplace(kv.first, kv.second); }
+  std::pair<iterator, bool> insert(value_type&& kv) { return try_emplace(std::move(kv.first), std::move(kv.second)); }
+
+  template <typename K2>
+  Value& operator[](K2&& key) { return try_emplace(std::forward<K2>(key)).first->second; }
+
+  template <typename K2>
+  bool erase(const K2& key) {
+    std::size_t idx = find_index(key, hasher_(key));
+    if (idx == capacity_) return false;
+
+    slots_[idx].~value_type();
+    // A group that still has an EMPTY slot ends every probe passing through
+    // it, so the erased slot can go straight back to EMPTY.
+    std::size_t group_first = idx - idx % GROUP_WIDTH;
+    if (Group(ctrl_ + group_first).match_empty() != 0) {
+      ctrl_[idx] = EMPTY;
+      growth_left_++;
+    } else {
+      ctrl_[idx] = DELETED;
+    }
+    size_--;
+    return true;
+  }
+};
 
 #endif
@@ -0,0 +1,94 @@
+#include "hashmap.hpp"
+#include "../tokens/tokenizer.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Compares FlatHashMap against std::unordered_map on the corpus vocabulary:
+// counting token frequencies (insert-heavy) and probing with string_views
+// (lookup-heavy, no std::string built per probe for the flat map).
+//
+// usage: hashmap_bench [corpus] [repeats]
+
+template <typename F>
+double time_ms(F&& f) {
+  auto start = std::chrono::high_resolution_clock::now();
+  f();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+  std::string corpus = argc > 1 ? argv[1] : "../tokens/test.txt";
+  int repeats = argc > 2 ? std::stoi(argv[2]) : 200;
+
+  MyList<MyList<char>> tokens = tokenizeFile(corpus);
+  std::vector<std::string> words;
+  words.reserve(tokens.size());
+  for (int i = 0; i < tokens.size(); i++)
+    words.emplace_back(&tokens[i][0], tokens[i].size());
+
+  // Probes are views into one buffer, the way a zero-copy tokenizer emits them
+  std::string buffer;
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  for (const auto& w : words) {
+    ranges.push_back({buffer.size(), w.size()});
+    buffer += w;
+  }
+  std::vector<std::string_view> views;
+  for (const auto& r : ranges)
+    views.emplace_back(buffer.data() + r.first, r.second);
+
+  std::size_t ops = words.size() * static_cast<std::size_t>(repeats);
+  std::cout << "Corpus: " << corpus << " | tokens: " << words.size()
+            << " | repeats: " << repeats << std::endl;
+
+  FlatHashMap<std::string, int> flat;
+  std::unordered_map<std::string, int> unordered;
+
+  double flat_count = time_ms([&] {
+    for (int r = 0; r < repeats; r++) {
+      flat.clear();
+      for (const auto& w : words) flat[w]++;
+    }
+  });
+  double unordered_count = time_ms([&] {
+    for (int r = 0; r < repeats; r++) {
+      unordered.clear();
+      for (const auto& w : words) unordered[w]++;
+    }
+  });
+  std::cout << "Vocab size: " << flat.size() << " (unordered_map: " << unordered.size() << ")" << std::endl;
+
+  long long flat_sum = 0, unordered_sum = 0;
+  double flat_lookup = time_ms([&] {
+    for (int r = 0; r < repeats; r++)
+      for (std::string_view v : views) flat_sum += flat.find(v)->second;
+  });
+  double unordered_lookup = time_ms([&] {
+    for (int r = 0; r < repeats; r++)
+      for (std::string_view v : views) unordered_sum += unordered.find(std::string(v))->second;
+  });
+
+  auto report = [&](const char* name, double ms) {
+    std::cout << name << ": " << ms << " ms (" << ms * 1e6 / ops << " ns/op)" << std::endl;
+  };
+  report("FlatHashMap count        ", flat_count);
+  report("unordered_map count      ", unordered_count);
+  report("FlatHashMap string_view  ", flat_lookup);
+  report("unordered_map string_view", unordered_lookup);
+  std::cout << "Checksums: " << flat_sum << " / " << unordered_sum << std::endl;
+
+  // The original compression demo, now on 64-bit hashes
+  MyList<char> string;
+  string.push('c');
+  string.push('b');
+  string.push('c');
+  std::vector<std::uint32_t> platypus = sieve_of_eratosthenes(100);
+  std::cout << compression_function(hash_code(string), platypus.back()) << std::endl;
+
+  return 0;
+}
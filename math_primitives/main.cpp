@@ -72,6 +72,15 @@ int main() {
     cout << "Xavier-initialized matrix:" << endl;
     m_xavier.print();
     cout << endl;
+
+    // Counter-based He initialization: same values however the rows are split
+    Philox philox(42);
+    matrix m_he(2, 3);
+    m_he.fill_he(philox, 3);
+
+    cout << "He-initialized matrix (Philox):" << endl;
+    m_he.print();
+    cout << endl;
 		
 
 		MatrixIO::saveBinary(m1, "matrix1.bin");
@@ -2,17 +2,207 @@
 #include <cmath>
 #include <stdexcept>
 
-Random::Random(unsigned int seed) : gen(seed) {}
+Random::Random(unsigned int seed) : gen(seed), unit(0.0f, 1.0f) {}
 
 float Random::uniform(float min, float max) {
-    std::uniform_real_distribution<float> dist(min, max);
-    return dist(gen);
+    return min + (max - min) * unit(gen);
 }
 
 float Random::xavier_uniform(int fan_in, int fan_out) {
-		if (fan_in + fan_out == 0) {
-			  throw std::invalid_argument("fan_in + fan_out cannot be zero.");
-		}
-    float a = std::sqrt(6.0f / (fan_in + fan_out));
+    float a = xavier_bound(fan_in, fan_out);
     return uniform(-a, a);
 }
+
+// ---------------- DISTRIBUTIONS ----------------
+float xavier_bound(int fan_in, int fan_out) {
+    if (fan_in + fan_out == 0) {
+        throw std::invalid_argument("fan_in + fan_out cannot be zero.");
+    }
+    return std::sqrt(6.0f / (fan_in + fan_out));
+}
+
+float he_stddev(int fan_in) {
+    if (fan_in <= 0) {
+        throw std::invalid_argument("fan_in must be positive for He initialization.");
+    }
+    return std::sqrt(2.0f / fan_in);
+}
+
+// ---------------- PHILOX ----------------
+namespace {
+
+constexpr std::uint32_t PHILOX_M0 = 0xD2511F53u;
+constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57u;
+constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9u;
+constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85u;
+constexpr int PHILOX_ROUNDS = 10;
+
+// Blocks are generated this many at a time so the rounds vectorise
+constexpr int LANES = 8;
+
+// Words per scratch chunk used by the bulk fills
+constexpr std::size_t CHUNK_WORDS = 1024;
+
+// [0, 1) from the top 24 bits
+inline float to_unit(std::uint32_t x) {
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+// (0, 1], safe to take the log of
+inline float to_unit_open(std::uint32_t x) {
+    return ((x >> 8) + 1) * (1.0f / 16777216.0f);
+}
+
+// One Philox round on a 4-word counter
+inline void philox_round(std::uint32_t& c0, std::uint32_t& c1, std::uint32_t& c2, std::uint32_t& c3,
+                         std::uint32_t k0, std::uint32_t k1) {
+    std::uint64_t p0 = static_cast<std::uint64_t>(PHILOX_M0) * c0;
+    std::uint64_t p1 = static_cast<std::uint64_t>(PHILOX_M1) * c2;
+    std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    c1 = static_cast<std::uint32_t>(p1);
+    c3 = static_cast<std::uint32_t>(p0);
+    c0 = n0;
+    c2 = n2;
+}
+
+// Philox4x32-10 of a single counter, for the per-element paths
+void philox_one(std::uint64_t counter, std::uint64_t seed, std::uint64_t stream, std::uint32_t out[4]) {
+    std::uint32_t c0 = static_cast<std::uint32_t>(counter);
+    std::uint32_t c1 = static_cast<std::uint32_t>(counter >> 32);
+    std::uint32_t c2 = static_cast<std::uint32_t>(stream);
+    std::uint32_t c3 = static_cast<std::uint32_t>(stream >> 32);
+    std::uint32_t k0 = static_cast<std::uint32_t>(seed);
+    std::uint32_t k1 = static_cast<std::uint32_t>(seed >> 32);
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        philox_round(c0, c1, c2, c3, k0, k1);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// Philox4x32-10 over LANES consecutive counters
+void philox_lanes(std::uint64_t first_counter, std::uint64_t seed, std::uint64_t stream,
+                  std::uint32_t out[LANES][4]) {
+    std::uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+    for (int l = 0; l < LANES; l++) {
+        std::uint64_t ctr = first_counter + l;
+        c0[l] = static_cast<std::uint32_t>(ctr);
+        c1[l] = static_cast<std::uint32_t>(ctr >> 32);
+        c2[l] = static_cast<std::uint32_t>(stream);
+        c3[l] = static_cast<std::uint32_t>(stream >> 32);
+    }
+
+    std::uint32_t k0 = static_cast<std::uint32_t>(seed);
+    std::uint32_t k1 = static_cast<std::uint32_t>(seed >> 32);
+
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        for (int l = 0; l < LANES; l++) philox_round(c0[l], c1[l], c2[l], c3[l], k0, k1);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (int l = 0; l < LANES; l++) {
+        out[l][0] = c0[l];
+        out[l][1] = c1[l];
+        out[l][2] = c2[l];
+        out[l][3] = c3[l];
+    }
+}
+
+} // namespace
+
+Philox::Philox(std::uint64_t seed, std::uint64_t stream) : seed(seed), stream(stream) {}
+
+Philox Philox::split(std::uint64_t new_stream) const {
+    return Philox(seed, new_stream);
+}
+
+void Philox::block(std::uint64_t counter, std::uint32_t out[4]) const {
+    philox_one(counter, seed, stream, out);
+}
+
+float Philox::uniform(std::uint64_t k, float min, float max) const {
+    std::uint32_t words[4];
+    block(k / 4, words);
+    return min + (max - min) * to_unit(words[k % 4]);
+}
+
+void Philox::fill_bits(std::uint32_t* out, std::size_t n, std::uint64_t offset) const {
+    std::uint64_t k = offset;
+    std::uint64_t end = offset + n;
+    std::uint32_t lanes[LANES][4];
+
+    while (k < end) {
+        std::uint64_t first_block = k / 4;
+        philox_lanes(first_block, seed, stream, lanes);
+
+        // Copy the part of these LANES blocks that falls inside [k, end)
+        std::uint64_t span_end = (first_block + LANES) * 4;
+        if (span_end > end) span_end = end;
+        for (; k < span_end; k++) {
+            std::uint64_t rel = k - first_block * 4;
+            *out++ = lanes[rel / 4][rel % 4];
+        }
+    }
+}
+
+void Philox::fill(float* out, std::size_t n, const UniformDist& dist, std::uint64_t offset) const {
+    std::uint32_t bits[CHUNK_WORDS];
+    const float scale = dist.max - dist.min;
+
+    for (std::size_t done = 0; done < n; ) {
+        std::size_t count = n - done < CHUNK_WORDS ? n - done : CHUNK_WORDS;
+        fill_bits(bits, count, offset + done);
+        for (std::size_t i = 0; i < count; i++)
+            out[done + i] = dist.min + scale * to_unit(bits[i]);
+        done += count;
+    }
+}
+
+void Philox::fill(float* out, std::size_t n, const NormalDist& dist, std::uint64_t offset) const {
+    // Box-Muller pairs lanes (0, 1) and (2, 3): even elements take the cosine
+    // branch and odd ones the sine branch, so pairs start on even indices.
+    std::uint32_t bits[CHUNK_WORDS];
+    const float two_pi = 6.28318530717958647692f;
+
+    std::uint64_t k = offset & ~static_cast<std::uint64_t>(1);
+    const std::uint64_t end = offset + n;
+
+    while (k < end) {
+        std::uint64_t count = end - k;
+        if (count > CHUNK_WORDS) count = CHUNK_WORDS;
+        count = (count + 1) & ~static_cast<std::uint64_t>(1);
+        fill_bits(bits, count, k);
+
+        for (std::uint64_t i = 0; i < count; i += 2) {
+            float radius = dist.stddev * std::sqrt(-2.0f * std::log(to_unit_open(bits[i])));
+            float theta = two_pi * to_unit(bits[i + 1]);
+            std::uint64_t e = k + i;
+            if (e >= offset && e < end) out[e - offset] = dist.mean + radius * std::cos(theta);
+            if (e + 1 >= offset && e + 1 < end) out[e + 1 - offset] = dist.mean + radius * std::sin(theta);
+        }
+        k += count;
+    }
+}
+
+void Philox::fill_dropout_mask(float* out, std::size_t n, float p, std::uint64_t offset) const {
+    if (p < 0.0f || p >= 1.0f) {
+        throw std::invalid_argument("Dropout probability must be in [0, 1).");
+    }
+
+    std::uint32_t bits[CHUNK_WORDS];
+    const float keep_scale = 1.0f / (1.0f - p);
+
+    for (std::size_t done = 0; done < n; ) {
+        std::size_t count = n - done < CHUNK_WORDS ? n - done : CHUNK_WORDS;
+        fill_bits(bits, count, offset + done);
+        for (std::size_t i = 0; i < count; i++)
+            out[done + i] = to_unit(bits[i]) < p ? 0.0f : keep_scale;
+        done += count;
+    }
+}
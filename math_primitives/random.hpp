@@ -2,19 +2,71 @@
 #define RANDOM_HPP
 
 #include <random>
+#include <cstdint>
+#include <cstddef>
 
 class Random {
 private:
     std::mt19937 gen;  // Mersenne Twister RNG engine
+    std::uniform_real_distribution<float> unit;  // [0, 1), reused across calls
 
 public:
     explicit Random(unsigned int seed);
-    
+
     // Generate uniform random float in [min, max)
     float uniform(float min, float max);
-    
+
     // Xavier initialization: uniform random in [-a, a] with a = sqrt(6 / (fan_in + fan_out))
     float xavier_uniform(int fan_in, int fan_out);
 };
 
+// ---------------- DISTRIBUTIONS ----------------
+struct UniformDist {
+    float min;
+    float max;
+};
+
+struct NormalDist {
+    float mean;
+    float stddev;
+};
+
+// Bounds/scales for the usual initialisers, computed once per tensor
+float xavier_bound(int fan_in, int fan_out);  // sqrt(6 / (fan_in + fan_out))
+float he_stddev(int fan_in);                  // sqrt(2 / fan_in)
+
+// ---------------- PHILOX ----------------
+// Counter-based Philox4x32-10 generator. Every output is a pure function of
+// (seed, stream, element index), so a tensor filled in one call, in row
+// chunks, or by many threads over disjoint ranges gets the same bits.
+// Element k of a stream comes from lane k % 4 of block k / 4.
+class Philox {
+private:
+    std::uint64_t seed;
+    std::uint64_t stream;
+
+public:
+    explicit Philox(std::uint64_t seed, std::uint64_t stream = 0);
+
+    // Independent generator with the same seed on another stream
+    Philox split(std::uint64_t new_stream) const;
+
+    // Raw 4x32-bit block for a given counter
+    void block(std::uint64_t counter, std::uint32_t out[4]) const;
+
+    // Single element k of the stream, for scalar use
+    float uniform(std::uint64_t k, float min = 0.0f, float max = 1.0f) const;
+
+    // Bulk fills of out[0..n) with elements offset..offset+n of the stream
+    void fill(float* out, std::size_t n, const UniformDist& dist, std::uint64_t offset = 0) const;
+    void fill(float* out, std::size_t n, const NormalDist& dist, std::uint64_t offset = 0) const;
+
+    // Inverted-dropout mask: 0 with probability p, otherwise 1 / (1 - p)
+    void fill_dropout_mask(float* out, std::size_t n, float p, std::uint64_t offset = 0) const;
+
+private:
+    // Raw words for elements offset..offset+n, block-aligned internally
+    void fill_bits(std::uint32_t* out, std::size_t n, std::uint64_t offset) const;
+};
+
 #endif
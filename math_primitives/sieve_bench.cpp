@@ -0,0 +1,55 @@
+#include "hashmap.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Times the segmented sieve for limits 10^4 .. 10^max_exp, checks the prime
+// counts against pi(10^k), and verifies every entry of PRIME_CAPACITIES.
+//
+// usage: sieve_bench [max_exp]
+
+int main(int argc, char** argv) {
+  int max_exp = argc > 1 ? std::stoi(argv[1]) : 8;
+  const std::size_t expected[] = {0, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534};
+
+  std::uint32_t limit = 1000;
+  for (int e = 4; e <= max_exp && e <= 9; e++) {
+    limit *= 10;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::uint32_t> primes = sieve_of_eratosthenes(limit);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration_ms = end - start;
+
+    std::cout << "sieve(10^" << e << "): " << primes.size() << " primes"
+              << (primes.size() == expected[e] ? "" : " (WRONG)")
+              << " in " << duration_ms.count() << " ms" << std::endl;
+  }
+
+  // Trial division by primes up to 2^16 covers every 32-bit table entry
+  std::vector<std::uint32_t> small = sieve_of_eratosthenes(65536);
+  bool all_prime = true;
+  for (std::uint64_t n : PRIME_CAPACITIES) {
+    for (std::uint32_t p : small) {
+      if (static_cast<std::uint64_t>(p) * p > n) break;
+      if (n % p == 0) {
+        std::cout << "PRIME_CAPACITIES entry " << n << " is divisible by " << p << std::endl;
+        all_prime = false;
+        break;
+      }
+    }
+  }
+  std::cout << "PRIME_CAPACITIES: " << (all_prime ? "all prime" : "NOT all prime") << std::endl;
+
+  // Capacity growth under the prime policy
+  FlatHashMap<std::uint64_t, int, FlatHash<std::uint64_t>, std::equal_to<>, PrimeGrowth> table;
+  std::size_t last_capacity = 0;
+  for (std::uint64_t i = 0; i < 100000; i++) {
+    table[i * 1024] = static_cast<int>(i);
+    if (table.capacity() != last_capacity) {
+      last_capacity = table.capacity();
+      std::cout << "  size " << table.size() << " -> capacity " << last_capacity
+                << " (" << last_capacity / 16 << " groups)" << std::endl;
+    }
+  }
+  return all_prime ? 0 : 1;
+}
@@ -205,13 +205,35 @@ void matrix::fill_identity() {
 }
 
 void matrix::fill_xavier(Random& rng, int fan_in, int fan_out) {
+    float a = xavier_bound(fan_in, fan_out);
+    fill_uniform(rng, -a, a);
+}
+
+void matrix::fill_uniform(const Philox& rng, float min, float max, std::uint64_t offset) {
     for (int i = 0; i < size(); i++) {
         mathVector& row = (*this)[i];
-        for (int j = 0; j < row.size(); j++)
-            row[j] = rng.xavier_uniform(fan_in, fan_out);
+        if (row.size() == 0) continue;
+        rng.fill(&row[0], row.size(), UniformDist{min, max}, offset + static_cast<std::uint64_t>(i) * row.size());
+    }
+}
+
+void matrix::fill_normal(const Philox& rng, float mean, float stddev, std::uint64_t offset) {
+    for (int i = 0; i < size(); i++) {
+        mathVector& row = (*this)[i];
+        if (row.size() == 0) continue;
+        rng.fill(&row[0], row.size(), NormalDist{mean, stddev}, offset + static_cast<std::uint64_t>(i) * row.size());
     }
 }
 
+void matrix::fill_xavier(const Philox& rng, int fan_in, int fan_out, std::uint64_t offset) {
+    float a = xavier_bound(fan_in, fan_out);
+    fill_uniform(rng, -a, a, offset);
+}
+
+void matrix::fill_he(const Philox& rng, int fan_in, std::uint64_t offset) {
+    fill_normal(rng, 0.0f, he_stddev(fan_in), offset);
+}
+
 matrix matrix::scalarMultiply(float scalar) const {
     matrix result;
     result.reserve(size());
@@ -53,7 +53,7 @@ public:
     arr[current++] = data;
   }
 
-  void pop() { if(current > 0) {current--}; }
+  void pop() { if(current > 0) {current--;}; }
   void clear() { current = 0; }
   void reserve(int new_capacity) {
     if (new_capacity > capacity) {
@@ -71,13 +71,17 @@ public:
 
   bool search(const T key) const {
     for (int i = 0; i < size(); i++){
-      if ((*this)[i] == key) {return true};
+      if ((*this)[i] == key) {return true;}
     }
     return false;
   }
 
     
 
+  T& operator[](int index) {
+    if (index >= current || index < 0) throw std::out_of_range("Index out of range");
+    return arr[index];
+  }
   const T& operator[](int index) const {
     if (index >= current || index < 0) {
       throw std::out_of_range("Index out of range");}
@@ -159,6 +163,13 @@ public:
 
   void fill_uniform(Random& rng, float min, float max);
   void fill_xavier(Random& rng, int fan_in, int fan_out);
+
+  // Counter-based fills: element (i, j) is stream element offset + i * cols + j,
+  // so the result does not depend on how rows are split across threads.
+  void fill_uniform(const Philox& rng, float min, float max, std::uint64_t offset = 0);
+  void fill_normal(const Philox& rng, float mean, float stddev, std::uint64_t offset = 0);
+  void fill_xavier(const Philox& rng, int fan_in, int fan_out, std::uint64_t offset = 0);
+  void fill_he(const Philox& rng, int fan_in, std::uint64_t offset = 0);
   void fill_zeroes();
   void fill_identity();
 
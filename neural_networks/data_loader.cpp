@@ -0,0 +1,166 @@
+#include "data_loader.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+
+DataLoader::DataLoader(std::size_t samples, SampleFn fetch, const LoaderConfig& config)
+    : samples(samples), fetch(std::move(fetch)), config(config) {
+    if (config.batch_size <= 0 || config.features <= 0 || config.classes <= 0) {
+        throw std::invalid_argument("DataLoader needs positive batch size, features and classes");
+    }
+    if (config.workers == 0 || config.depth == 0) {
+        throw std::invalid_argument("DataLoader needs at least one worker and one buffer");
+    }
+    const std::size_t batch = static_cast<std::size_t>(config.batch_size);
+    per_epoch = config.drop_last ? samples / batch : (samples + batch - 1) / batch;
+    if (per_epoch == 0) {
+        throw std::invalid_argument("Dataset of " + std::to_string(samples) + " samples yields no batches");
+    }
+
+    // Buffers are allocated once here and refilled in place
+    slots.resize(config.depth);
+    for (Slot& slot : slots) {
+        slot.batch.inputs = matrix(config.batch_size, config.features);
+        slot.batch.targets = matrix(config.batch_size, config.classes);
+        slot.batch.labels.resize(batch);
+    }
+    for (std::size_t i = 0; i < config.workers; i++) workers.emplace_back(&DataLoader::worker_loop, this);
+}
+
+DataLoader::~DataLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    slot_free.notify_all();
+    slot_ready.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+std::shared_ptr<const std::vector<std::uint32_t>> DataLoader::order(std::uint64_t epoch) {
+    std::lock_guard<std::mutex> lock(order_mutex);
+    auto it = orders.find(epoch);
+    if (it != orders.end()) return it->second;
+
+    auto perm = std::make_shared<std::vector<std::uint32_t>>(samples);
+    std::iota(perm->begin(), perm->end(), 0u);
+    if (config.shuffle) {
+        // Fisher-Yates; swap i takes lane i % 4 of Philox block i / 4
+        Philox rng(config.seed, epoch);
+        std::uint32_t bits[4];
+        for (std::size_t i = samples; i-- > 1; ) {
+            if (i % 4 == 3 || i == samples - 1) rng.block(i / 4, bits);
+            std::swap((*perm)[i], (*perm)[bits[i % 4] % (i + 1)]);
+        }
+    }
+    // Keep the last two epochs; a pruned one is rebuilt identically if needed
+    while (!orders.empty() && orders.begin()->first + 1 < epoch) orders.erase(orders.begin());
+    orders.emplace(epoch, perm);
+    return perm;
+}
+
+void DataLoader::fill(std::uint64_t seq, Batch& batch) {
+    batch.epoch = seq / per_epoch;
+    batch.index = seq % per_epoch;
+    auto perm = order(batch.epoch);
+
+    const std::size_t first = batch.index * config.batch_size;
+    const int rows = static_cast<int>(std::min<std::size_t>(config.batch_size, samples - first));
+    if (batch.inputs.size() != rows) {
+        // Only a short final batch changes shape
+        batch.inputs = matrix(rows, config.features);
+        batch.targets = matrix(rows, config.classes);
+    }
+    batch.rows = rows;
+    batch.labels.resize(rows);
+
+    for (int r = 0; r < rows; r++) {
+        int label = fetch((*perm)[first + r], &batch.inputs[r][0]);
+        if (label < 0 || label >= config.classes) {
+            throw std::out_of_range("Sample label " + std::to_string(label) + " is not a valid class");
+        }
+        mathVector& target = batch.targets[r];
+        for (int c = 0; c < config.classes; c++) target[c] = 0.0f;
+        target[label] = 1.0f;
+        batch.labels[r] = label;
+    }
+}
+
+void DataLoader::worker_loop() {
+    while (true) {
+        std::uint64_t seq;
+        Slot* slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (stopping) return;
+            seq = claimed++;
+            // The ring holds batches released .. released + depth - 1
+            auto wait_start = Clock::now();
+            slot_free.wait(lock, [&] { return stopping || seq < released + slots.size(); });
+            counters.worker_wait_ms += elapsed_ms(wait_start);
+            if (stopping) return;
+            slot = &slots[seq % slots.size()];
+        }
+
+        auto fill_start = Clock::now();
+        std::exception_ptr failure;
+        try {
+            fill(seq, slot->batch);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            counters.fill_ms += elapsed_ms(fill_start);
+            if (failure && !error) error = failure;
+            slot->seq = seq;
+        }
+        slot_ready.notify_all();
+    }
+}
+
+const Batch& DataLoader::next() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (holding) {
+        released++;
+        holding = false;
+        slot_free.notify_all();
+    }
+
+    Slot& slot = slots[released % slots.size()];
+    auto is_ready = [&] { return slot.seq == released; };
+    counters.depth_sum += ready_locked();
+    if (!is_ready()) {
+        counters.stalls++;
+        auto wait_start = Clock::now();
+        slot_ready.wait(lock, [&] { return is_ready() || error; });
+        counters.stall_ms += elapsed_ms(wait_start);
+    }
+    if (error) std::rethrow_exception(error);
+
+    holding = true;
+    counters.batches++;
+    return slot.batch;
+}
+
+std::size_t DataLoader::ready_locked() const {
+    std::size_t n = 0;
+    for (std::uint64_t seq = released + (holding ? 1 : 0); seq < released + slots.size(); seq++) {
+        if (slots[seq % slots.size()].seq != seq) break;
+        n++;
+    }
+    return n;
+}
+
+std::size_t DataLoader::ready() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ready_locked();
+}
+
+LoaderStats DataLoader::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
@@ -0,0 +1,109 @@
+#ifndef DATA_LOADER_HPP
+#define DATA_LOADER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../math_primitives/vector.hpp"
+
+// Writes sample `index` into `features` (already flattened and normalised)
+// and returns its class label. Called concurrently from loader threads.
+using SampleFn = std::function<int(std::size_t index, float* features)>;
+
+struct LoaderConfig {
+    int batch_size = 32;
+    int features = 28 * 28;
+    int classes = 10;
+    std::size_t workers = 2;
+    std::size_t depth = 4;      // batch buffers in the ring
+    bool shuffle = true;
+    bool drop_last = true;      // otherwise the last batch of an epoch may be short
+    std::uint64_t seed = 42;
+};
+
+struct Batch {
+    matrix inputs;              // rows x features
+    matrix targets;             // rows x classes, one-hot
+    std::vector<int> labels;
+    int rows = 0;
+    std::uint64_t epoch = 0;
+    std::uint64_t index = 0;    // batch number within the epoch
+};
+
+struct LoaderStats {
+    std::uint64_t batches = 0;      // handed to the trainer
+    std::uint64_t stalls = 0;       // next() calls that found no batch ready
+    double stall_ms = 0.0;          // trainer time blocked in next()
+    double fill_ms = 0.0;           // worker time spent producing batches
+    double worker_wait_ms = 0.0;    // worker time blocked on a full ring
+    std::uint64_t depth_sum = 0;    // ready batches seen by each next()
+
+    double mean_depth() const { return batches == 0 ? 0.0 : static_cast<double>(depth_sum) / batches; }
+};
+
+// Produces shuffled, one-hot batches on background threads into a ring of
+// `depth` reusable buffers. Batches come out of next() in a fixed order:
+// epoch e uses a permutation drawn from Philox(seed, e), so the sequence does
+// not depend on how many workers there are or how they are scheduled.
+//
+// Reading stats: a high stall count and mean depth near zero mean the loader
+// cannot keep up; a full ring with workers mostly waiting means it can.
+class DataLoader {
+public:
+    DataLoader(std::size_t samples, SampleFn fetch, const LoaderConfig& config = LoaderConfig());
+    ~DataLoader();
+
+    DataLoader(const DataLoader&) = delete;
+    DataLoader& operator=(const DataLoader&) = delete;
+
+    std::size_t batches_per_epoch() const { return per_epoch; }
+
+    // Next batch in order, blocking until it is ready. The reference stays
+    // valid until the following call, which hands the buffer back to the
+    // workers. Rethrows an exception raised by the sample function.
+    const Batch& next();
+
+    // Batches filled and waiting
+    std::size_t ready() const;
+    LoaderStats stats() const;
+
+private:
+    struct Slot {
+        Batch batch;
+        std::uint64_t seq = ~0ull;  // batch currently held, ~0 when empty
+    };
+
+    void worker_loop();
+    std::size_t ready_locked() const;
+    void fill(std::uint64_t seq, Batch& batch);
+    std::shared_ptr<const std::vector<std::uint32_t>> order(std::uint64_t epoch);
+
+    std::size_t samples;
+    SampleFn fetch;
+    LoaderConfig config;
+    std::size_t per_epoch;
+
+    std::vector<Slot> slots;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex mutex;
+    std::condition_variable slot_free;
+    std::condition_variable slot_ready;
+    std::uint64_t claimed = 0;      // next sequence number a worker takes
+    std::uint64_t released = 0;     // batches whose buffer went back to the ring
+    bool holding = false;           // trainer is reading batch `released`
+    bool stopping = false;
+    std::exception_ptr error;
+    LoaderStats counters;
+
+    std::mutex order_mutex;
+    std::map<std::uint64_t, std::shared_ptr<const std::vector<std::uint32_t>>> orders;
+};
+
+#endif // DATA_LOADER_HPP
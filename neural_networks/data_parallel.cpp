@@ -0,0 +1,175 @@
+#include "data_parallel.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+int argmax(const mathVector& v) {
+    int best = 0;
+    for (int j = 1; j < v.size(); j++)
+        if (v[j] > v[best]) best = j;
+    return best;
+}
+
+} // namespace
+
+void free_graph(Node* root, const std::vector<Node*>& keep) {
+    std::set<Node*> seen(keep.begin(), keep.end());
+    std::vector<Node*> stack = {root};
+    std::vector<Node*> doomed;
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+        if (!node || !seen.insert(node).second) continue;
+        doomed.push_back(node);
+        for (int i = 0; i < node->children.size(); i++) stack.push_back(node->children[i]);
+    }
+    for (Node* node : doomed) delete node;
+}
+
+namespace {
+
+// Counts how often backward()'s recursion reaches each node as a child
+void count_visits(Node* node, std::map<Node*, int>& visits) {
+    if (!node->backward) return;
+    for (int i = 0; i < node->children.size(); i++) {
+        visits[node->children[i]]++;
+        count_visits(node->children[i], visits);
+    }
+}
+
+void backward_counted(Node* node, std::map<Node*, int>& visits, const std::function<void(Node*)>& leaf_done) {
+    if (!node->backward) return;
+    node->backward();
+    for (int i = 0; i < node->children.size(); i++) {
+        Node* child = node->children[i];
+        if (--visits[child] == 0 && !child->backward) leaf_done(child);
+    }
+    for (int i = 0; i < node->children.size(); i++) backward_counted(node->children[i], visits, leaf_done);
+}
+
+} // namespace
+
+void backward_with_hooks(Node* root, const std::function<void(Node*)>& leaf_done) {
+    std::map<Node*, int> visits;
+    count_visits(root, visits);
+    backward_counted(root, visits, leaf_done);
+}
+
+DataParallelTrainer::DataParallelTrainer(const MyList<Node*>& params, ForwardFn forward, std::size_t replicas)
+    : forward(std::move(forward)) {
+    if (replicas == 0) throw std::invalid_argument("DataParallelTrainer needs at least one replica");
+    for (int i = 0; i < params.size(); i++) masters.push_back(params[i]);
+
+    replica_params.resize(replicas);
+    for (auto& replica : replica_params) {
+        for (Node* master : masters) replica.push_back(new Node(master->value));
+    }
+    // The calling thread works too, so one fewer pool thread than replicas
+    if (replicas > 1) pool.reset(new ThreadPool(replicas - 1));
+}
+
+DataParallelTrainer::~DataParallelTrainer() {
+    for (auto& replica : replica_params)
+        for (Node* node : replica) delete node;
+}
+
+void DataParallelTrainer::broadcast() {
+    auto copy = [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t r = lo; r < hi; r++)
+            for (std::size_t p = 0; p < masters.size(); p++) replica_params[r][p]->value = masters[p]->value;
+    };
+    if (pool) pool->parallel_for(0, replicas(), copy);
+    else copy(0, replicas());
+}
+
+StepStats DataParallelTrainer::run_batch(const matrix& inputs, const matrix& targets) {
+    if (inputs.size() != targets.size()) throw std::invalid_argument("Inputs and targets differ in row count");
+    const std::size_t rows = inputs.size();
+    const std::size_t n = replicas();
+    std::vector<StepStats> partial(n);
+
+    auto compute_start = Clock::now();
+    auto work = [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t r = lo; r < hi; r++) {
+            const std::vector<Node*>& params = replica_params[r];
+            StepStats& stats = partial[r];
+            for (std::size_t row = rows * r / n; row < rows * (r + 1) / n; row++) {
+                Node* x = new Node(matrix{inputs[static_cast<int>(row)]});
+                Node* y = new Node(matrix{targets[static_cast<int>(row)]});
+                Node* y_pred = forward(params, x);
+                Node* loss = cross_entropy(y_pred, y);
+                loss->grad = {{1.0f}};
+                backward(loss);
+
+                if (argmax(y_pred->value[0]) == argmax(y->value[0])) stats.correct++;
+                stats.loss += loss->value[0][0];
+                stats.samples++;
+                free_graph(loss, params);
+                delete y;  // targets are not part of the loss graph
+            }
+        }
+    };
+    if (pool) pool->parallel_for(0, n, work);
+    else work(0, n);
+    last_compute_ms = elapsed_ms(compute_start);
+
+    auto reduce_start = Clock::now();
+    reduce();
+    last_reduce_ms = elapsed_ms(reduce_start);
+
+    // Summed in replica order, like the gradients
+    StepStats total;
+    for (const StepStats& s : partial) {
+        total.loss += s.loss;
+        total.correct += s.correct;
+        total.samples += s.samples;
+    }
+    return total;
+}
+
+void DataParallelTrainer::reduce() {
+    // Work items are (param, row) pairs so every level splits finely
+    std::vector<std::pair<std::size_t, int>> items;
+    for (std::size_t p = 0; p < masters.size(); p++)
+        for (int row = 0; row < masters[p]->grad.size(); row++) items.emplace_back(p, row);
+    const std::size_t m = items.size();
+    const std::size_t n = replicas();
+
+    auto add_row = [](mathVector& dst, const mathVector& src) {
+        float* d = &dst[0];
+        const float* s = &src[0];
+        for (int j = 0; j < dst.size(); j++) d[j] += s[j];
+    };
+    auto run = [&](std::size_t count, const std::function<void(std::size_t, std::size_t)>& fn) {
+        if (pool) pool->parallel_for(0, count, fn, 64);
+        else fn(0, count);
+    };
+
+    for (std::size_t stride = 1; stride < n; stride *= 2) {
+        const std::size_t pairs = (n - stride + 2 * stride - 1) / (2 * stride);
+        run(pairs * m, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t k = lo; k < hi; k++) {
+                std::size_t dst = (k / m) * 2 * stride;
+                auto [p, row] = items[k % m];
+                add_row(replica_params[dst][p]->grad[row], replica_params[dst + stride][p]->grad[row]);
+            }
+        });
+    }
+
+    // Replica 0 holds the sum; hand it to the masters and clear every replica
+    run(m, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t k = lo; k < hi; k++) {
+            auto [p, row] = items[k];
+            add_row(masters[p]->grad[row], replica_params[0][p]->grad[row]);
+            for (std::size_t r = 0; r < n; r++) {
+                mathVector& g = replica_params[r][p]->grad[row];
+                std::fill(&g[0], &g[0] + g.size(), 0.0f);
+            }
+        }
+    });
+}
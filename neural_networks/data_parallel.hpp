@@ -0,0 +1,71 @@
+#ifndef DATA_PARALLEL_HPP
+#define DATA_PARALLEL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "../autograd_mechanisms/autograd.hpp"
+#include "../utils/thread_pool.hpp"
+
+// Builds the prediction graph for one input row from a set of parameters
+using ForwardFn = std::function<Node*(const std::vector<Node*>& params, Node* x)>;
+
+struct StepStats {
+    float loss = 0.0f;      // summed over samples
+    int correct = 0;
+    int samples = 0;
+};
+
+// Synchronous data parallelism on one machine. Each replica owns a copy of
+// the parameters with private gradients; run_batch() splits a batch's rows
+// into contiguous slices, one per replica, runs forward/backward on them
+// concurrently, then sums the replica gradients with a binary tree
+// (replica i += replica i + stride, stride = 1, 2, 4, ...) and adds the
+// result to the master parameters' grad. The tree shape is fixed, so for a
+// given replica count the summation order, and the gradient bits, never
+// change between runs.
+//
+// Replica values are refreshed from the masters by broadcast(), which must
+// be called after every optimizer step.
+class DataParallelTrainer {
+public:
+    DataParallelTrainer(const MyList<Node*>& params, ForwardFn forward, std::size_t replicas);
+    ~DataParallelTrainer();
+
+    DataParallelTrainer(const DataParallelTrainer&) = delete;
+    DataParallelTrainer& operator=(const DataParallelTrainer&) = delete;
+
+    std::size_t replicas() const { return replica_params.size(); }
+
+    // Copies master parameter values into every replica
+    void broadcast();
+
+    // Forward/backward with cross-entropy over inputs (rows x features) and
+    // one-hot targets (rows x classes); gradients accumulate into the masters
+    StepStats run_batch(const matrix& inputs, const matrix& targets);
+
+    // Wall time of the last run_batch split into its two phases
+    double compute_ms() const { return last_compute_ms; }
+    double reduce_ms() const { return last_reduce_ms; }
+
+private:
+    void reduce();
+
+    std::vector<Node*> masters;
+    ForwardFn forward;
+    std::vector<std::vector<Node*>> replica_params;  // [replica][param]
+    std::unique_ptr<ThreadPool> pool;
+    double last_compute_ms = 0.0;
+    double last_reduce_ms = 0.0;
+};
+
+// Deletes every node reachable from root except those in keep
+void free_graph(Node* root, const std::vector<Node*>& keep);
+
+// Same traversal as backward(), also calling leaf_done(leaf) for each leaf
+// (a node without a backward function) as soon as its last gradient
+// contribution has been added
+void backward_with_hooks(Node* root, const std::function<void(Node*)>& leaf_done);
+
+#endif // DATA_PARALLEL_HPP
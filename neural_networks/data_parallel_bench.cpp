@@ -0,0 +1,102 @@
+#include "data_parallel.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// Scaling of DataParallelTrainer on the train_digits MLP (784-128-10) with
+// synthetic data: time per batch, speedup and parallel efficiency for 1..32
+// replicas, plus checks that gradients are bit-identical between runs at a
+// fixed replica count and agree with the single-replica sum.
+//
+// usage: data_parallel_bench [batch] [max threads] [repeats]
+
+namespace {
+
+Node* mlp(const std::vector<Node*>& p, Node* x) {
+    Node* a1 = relu(add(matmul(x, p[0]), p[2]));
+    return softmax(add(matmul(a1, p[1]), p[3]));
+}
+
+std::vector<float> flat_grads(const MyList<Node*>& params) {
+    std::vector<float> out;
+    for (int i = 0; i < params.size(); i++)
+        for (int r = 0; r < params[i]->grad.size(); r++)
+            for (int c = 0; c < params[i]->grad[r].size(); c++) out.push_back(params[i]->grad[r][c]);
+    return out;
+}
+
+void zero_grads(const MyList<Node*>& params) {
+    for (int i = 0; i < params.size(); i++) params[i]->grad.fill_zeroes();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int batch = argc > 1 ? std::stoi(argv[1]) : 256;
+    std::size_t max_threads = argc > 2 ? std::stoul(argv[2]) : 32;
+    int repeats = argc > 3 ? std::stoi(argv[3]) : 3;
+
+    try {
+        Philox init(1);
+        MyList<Node*> params;
+        params.push(new Node(matrix(784, 128)));
+        params.push(new Node(matrix(128, 10)));
+        params.push(new Node(matrix(1, 128)));
+        params.push(new Node(matrix(1, 10)));
+        params[0]->value.fill_xavier(init, 784, 128);
+        params[1]->value.fill_xavier(init.split(1), 128, 10);
+
+        matrix inputs(batch, 784), targets(batch, 10);
+        inputs.fill_uniform(init.split(2), 0.0f, 1.0f);
+        for (int r = 0; r < batch; r++) targets[r][r % 10] = 1.0f;
+
+        std::cout << "Batch " << batch << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+        std::cout << "threads | ms/batch | compute | reduce | samples/s | speedup | efficiency | deterministic | max rel diff"
+                  << std::endl;
+
+        double base_ms = 0.0;
+        std::vector<float> reference;
+        for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+            DataParallelTrainer trainer(params, mlp, threads);
+
+            zero_grads(params);
+            trainer.run_batch(inputs, targets);  // warm-up
+            std::vector<float> first = flat_grads(params);
+
+            double total = 0.0, compute = 0.0, reduce = 0.0;
+            bool deterministic = true;
+            for (int i = 0; i < repeats; i++) {
+                zero_grads(params);
+                auto start = std::chrono::steady_clock::now();
+                trainer.run_batch(inputs, targets);
+                total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                compute += trainer.compute_ms();
+                reduce += trainer.reduce_ms();
+                deterministic = deterministic && flat_grads(params) == first;
+            }
+            total /= repeats;
+            compute /= repeats;
+            reduce /= repeats;
+
+            if (threads == 1) {
+                base_ms = total;
+                reference = first;
+            }
+            double max_rel = 0.0;
+            for (std::size_t k = 0; k < first.size(); k++) {
+                double scale = std::max(1e-6, static_cast<double>(std::fabs(reference[k])));
+                max_rel = std::max(max_rel, std::fabs(first[k] - reference[k]) / scale);
+            }
+            double speedup = base_ms / total;
+            std::cout << threads << " | " << total << " | " << compute << " | " << reduce << " | "
+                      << batch * 1e3 / total << " | " << speedup << " | " << 100.0 * speedup / threads << "% | "
+                      << (deterministic ? "yes" : "NO") << " | " << max_rel << std::endl;
+        }
+
+        for (int i = 0; i < params.size(); i++) delete params[i];
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "mnist.hpp"
+#include "../utils/mapped_file.hpp"
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr std::uint32_t IDX_IMAGES_MAGIC = 0x00000803;  // uint8, 3 dimensions
+constexpr std::uint32_t IDX_LABELS_MAGIC = 0x00000801;  // uint8, 1 dimension
+
+std::uint32_t read_be32(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return (static_cast<std::uint32_t>(b[0]) << 24) | (static_cast<std::uint32_t>(b[1]) << 16) |
+           (static_cast<std::uint32_t>(b[2]) << 8) | b[3];
+}
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+} // namespace
+
+matrix MnistData::to_matrix(int first, int n) const {
+    if (first < 0 || n < 0 || first + n > count) throw std::out_of_range("Image range outside the data set");
+    matrix m(n, features());
+    for (int i = 0; i < n; i++) {
+        std::memcpy(&m[i][0], image(first + i), features() * sizeof(float));
+    }
+    return m;
+}
+
+void normalize_pixels(const std::uint8_t* in, float* out, std::size_t n) {
+    const float scale = 1.0f / 255.0f;
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        _mm_storeu_ps(out + i,      _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), vscale));
+        _mm_storeu_ps(out + i + 4,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), vscale));
+        _mm_storeu_ps(out + i + 8,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), vscale));
+        _mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), vscale));
+    }
+#endif
+    for (; i < n; i++) out[i] = in[i] * scale;
+}
+
+// ---------------- IDX ----------------
+MnistData load_mnist_idx(const std::string& images_file, const std::string& labels_file) {
+    MappedFile images(images_file);
+    MappedFile labels(labels_file);
+
+    if (images.size() < 16 || read_be32(images.data()) != IDX_IMAGES_MAGIC) {
+        throw std::runtime_error("Not an IDX image file: " + images_file);
+    }
+    if (labels.size() < 8 || read_be32(labels.data()) != IDX_LABELS_MAGIC) {
+        throw std::runtime_error("Not an IDX label file: " + labels_file);
+    }
+
+    MnistData data;
+    std::uint32_t count = read_be32(images.data() + 4);
+    data.rows = static_cast<int>(read_be32(images.data() + 8));
+    data.cols = static_cast<int>(read_be32(images.data() + 12));
+    if (read_be32(labels.data() + 4) != count) {
+        throw std::runtime_error("Image and label counts differ: " + images_file + ", " + labels_file);
+    }
+    const std::size_t pixel_count = static_cast<std::size_t>(count) * data.rows * data.cols;
+    if (images.size() - 16 != pixel_count || labels.size() - 8 != count) {
+        throw std::runtime_error("Truncated or corrupt IDX file: " + images_file);
+    }
+
+    data.count = static_cast<int>(count);
+    data.pixels.resize(pixel_count);
+    normalize_pixels(reinterpret_cast<const std::uint8_t*>(images.data() + 16), data.pixels.data(), pixel_count);
+    data.labels.assign(labels.data() + 8, labels.data() + 8 + count);
+    return data;
+}
+
+// ---------------- CSV ----------------
+MnistData load_mnist_csv(const std::string& filename, int rows, int cols, ThreadPool& pool) {
+    MappedFile file(filename);
+    const char* text = file.data();
+    const char* end = text + file.size();
+
+    const char* p = text;
+    if (p != end && !is_digit(*p)) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = eol ? eol + 1 : end;
+    }
+
+    // Line starts, skipping blank lines
+    std::vector<const char*> lines;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        if (eol > p && !(eol == p + 1 && *p == '\r')) lines.push_back(p);
+        p = eol + 1;
+    }
+
+    MnistData data;
+    data.count = static_cast<int>(lines.size());
+    data.rows = rows;
+    data.cols = cols;
+    const int features = data.features();
+    data.pixels.resize(static_cast<std::size_t>(data.count) * features);
+    data.labels.resize(data.count);
+
+    const float scale = 1.0f / 255.0f;
+    pool.parallel_for(0, lines.size(), [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t line = lo; line < hi; line++) {
+            const char* q = lines[line];
+            const char* eol = static_cast<const char*>(std::memchr(q, '\n', end - q));
+            if (!eol) eol = end;
+            float* out = data.pixels.data() + line * features;
+
+            auto fail = [&](const std::string& what) {
+                throw std::runtime_error(filename + ": " + what + " on data line " + std::to_string(line + 1));
+            };
+            int value;
+            for (int field = 0; field <= features; field++) {
+                if (field > 0) {
+                    if (q == eol || *q != ',') fail("expected " + std::to_string(features + 1) + " fields");
+                    q++;
+                }
+                auto [next, ec] = std::from_chars(q, eol, value);
+                if (ec != std::errc() || value < 0 || value > 255) fail("bad value");
+                q = next;
+                if (field == 0) data.labels[line] = static_cast<std::uint8_t>(value);
+                else out[field - 1] = value * scale;
+            }
+            if (q != eol && !(q + 1 == eol && *q == '\r')) fail("trailing data");
+        }
+    }, 256);
+    return data;
+}
@@ -0,0 +1,41 @@
+#ifndef MNIST_HPP
+#define MNIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../math_primitives/vector.hpp"
+#include "../utils/thread_pool.hpp"
+
+// A labelled image set held as one contiguous [count x rows*cols] float
+// buffer, pixels scaled to [0, 1], ready to be sliced into batches.
+struct MnistData {
+    int count = 0;
+    int rows = 0;
+    int cols = 0;
+    std::vector<float> pixels;
+    std::vector<std::uint8_t> labels;
+
+    int features() const { return rows * cols; }
+    const float* image(int i) const { return pixels.data() + static_cast<std::size_t>(i) * features(); }
+
+    // Images first .. first + n as an n x features matrix
+    matrix to_matrix(int first, int n) const;
+};
+
+// uint8 pixels to floats in [0, 1]; SSE2 when available
+void normalize_pixels(const std::uint8_t* in, float* out, std::size_t n);
+
+// IDX files as distributed with MNIST (train-images-idx3-ubyte,
+// train-labels-idx1-ubyte): big-endian magic and dimensions, raw uint8 data.
+// Both files are memory-mapped; the counts must agree.
+MnistData load_mnist_idx(const std::string& images_file, const std::string& labels_file);
+
+// Numeric CSV with one image per line: label,pixel0,...,pixelN (0-255). A
+// non-numeric first line is taken as a header. Lines are parsed in parallel
+// with std::from_chars straight out of the mapped file.
+MnistData load_mnist_csv(const std::string& filename, int rows = 28, int cols = 28,
+                         ThreadPool& pool = default_thread_pool());
+
+#endif // MNIST_HPP
@@ -0,0 +1,119 @@
+#include "mnist.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Load times for a 60k-image training set: IDX (mmap + SIMD normalise),
+// the from_chars CSV parser, and the getline/substr/stoi parse it replaces.
+// Without arguments a synthetic set is written to the working directory
+// first and removed afterwards.
+//
+// usage: mnist_bench [images.idx labels.idx data.csv]
+
+namespace {
+
+void write_be32(std::ofstream& out, std::uint32_t v) {
+    char b[4] = {char(v >> 24), char(v >> 16), char(v >> 8), char(v)};
+    out.write(b, 4);
+}
+
+void write_synthetic(const std::string& images, const std::string& labels, const std::string& csv, int count) {
+    const int side = 28, features = side * side;
+    std::ofstream img(images, std::ios::binary), lab(labels, std::ios::binary), txt(csv);
+    write_be32(img, 0x00000803);
+    write_be32(img, count);
+    write_be32(img, side);
+    write_be32(img, side);
+    write_be32(lab, 0x00000801);
+    write_be32(lab, count);
+    txt << "label";
+    for (int j = 0; j < features; j++) txt << ",pixel" << j;
+    txt << "\n";
+
+    Random rng(7);
+    std::vector<char> pixels(features);
+    for (int i = 0; i < count; i++) {
+        int label = i % 10;
+        lab.put(static_cast<char>(label));
+        txt << label;
+        for (int j = 0; j < features; j++) {
+            // Mostly background like real digits
+            int v = rng.uniform(0.0f, 1.0f) < 0.8f ? 0 : static_cast<int>(rng.uniform(1.0f, 255.99f));
+            pixels[j] = static_cast<char>(v);
+            txt << ',' << v;
+        }
+        txt << "\n";
+        img.write(pixels.data(), features);
+    }
+}
+
+// What train_digits used to do per line, extended to every pixel
+MnistData load_csv_getline(const std::string& filename) {
+    std::ifstream in(filename);
+    std::string line;
+    std::getline(in, line);  // header
+    MnistData data;
+    data.rows = data.cols = 28;
+    while (std::getline(in, line)) {
+        std::stringstream fields(line);
+        std::string field;
+        std::getline(fields, field, ',');
+        data.labels.push_back(static_cast<std::uint8_t>(std::stoi(field)));
+        while (std::getline(fields, field, ',')) data.pixels.push_back(std::stoi(field) * (1.0f / 255.0f));
+        data.count++;
+    }
+    return data;
+}
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool synthetic = argc < 4;
+    std::string images = synthetic ? "mnist_bench-images.idx" : argv[1];
+    std::string labels = synthetic ? "mnist_bench-labels.idx" : argv[2];
+    std::string csv = synthetic ? "mnist_bench.csv" : argv[3];
+
+    try {
+        if (synthetic) {
+            std::cout << "Writing synthetic 60000-image set..." << std::endl;
+            write_synthetic(images, labels, csv, 60000);
+        }
+
+        MnistData idx, fast, fast_serial, slow;
+        ThreadPool serial(1);
+        double idx_ms = time_ms([&] { idx = load_mnist_idx(images, labels); });
+        double fast_ms = time_ms([&] { fast = load_mnist_csv(csv); });
+        double serial_ms = time_ms([&] { fast_serial = load_mnist_csv(csv, 28, 28, serial); });
+        double slow_ms = time_ms([&] { slow = load_csv_getline(csv); });
+
+        bool same = idx.pixels == fast.pixels && idx.labels == fast.labels &&
+                    fast.pixels == fast_serial.pixels && fast.pixels == slow.pixels && fast.labels == slow.labels;
+
+        double mb = idx.pixels.size() * sizeof(float) / (1024.0 * 1024.0);
+        std::cout << "Images: " << idx.count << " x " << idx.features() << " (" << mb << " MB as float)" << std::endl;
+        std::cout << "IDX mmap + SIMD       : " << idx_ms << " ms" << std::endl;
+        std::cout << "CSV from_chars (" << default_thread_pool().size() << " thr) : " << fast_ms << " ms" << std::endl;
+        std::cout << "CSV from_chars (1 thr) : " << serial_ms << " ms" << std::endl;
+        std::cout << "CSV getline/stoi      : " << slow_ms << " ms (" << slow_ms / serial_ms << "x slower)" << std::endl;
+        std::cout << (same ? "All loaders agree" : "MISMATCH between loaders") << std::endl;
+
+        if (synthetic) {
+            std::remove(images.c_str());
+            std::remove(labels.c_str());
+            std::remove(csv.c_str());
+        }
+        return same ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
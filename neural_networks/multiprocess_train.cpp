@@ -0,0 +1,216 @@
+#include "shm_allreduce.hpp"
+#include "data_parallel.hpp"
+#include "mnist.hpp"
+#include "../utils/helpers.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Multi-process data parallelism on one machine. The launcher creates a
+// shared memory segment and forks one worker per rank; every worker builds
+// the same 784-128-10 MLP from the same seed, runs forward/backward on its
+// slice of each global batch and all-reduces gradient buckets through the
+// segment while the last sample's backward pass is still running. After the
+// reduction every rank holds the same summed gradient, so identical SGD
+// steps keep the replicas in sync without ever sending parameters.
+//
+// Trains on the MNIST IDX files when present, synthetic data otherwise.
+//
+// usage: multiprocess_train [workers] [steps] [batch] [bucket floats]
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    int workers = 4;
+    int steps = 50;
+    int batch = 64;
+    std::size_t bucket_floats = 32 * 1024;
+};
+
+Node* mlp(const std::vector<Node*>& p, Node* x) {
+    Node* a1 = relu(add(matmul(x, p[0]), p[1]));
+    return softmax(add(matmul(a1, p[2]), p[3]));
+}
+
+int argmax(const mathVector& v) {
+    int best = 0;
+    for (int j = 1; j < v.size(); j++)
+        if (v[j] > v[best]) best = j;
+    return best;
+}
+
+MnistData training_data() {
+    if (fs::exists("train-images-idx3-ubyte") && fs::exists("train-labels-idx1-ubyte"))
+        return load_mnist_idx("train-images-idx3-ubyte", "train-labels-idx1-ubyte");
+
+    MnistData data;
+    data.count = 2048;
+    data.rows = data.cols = 28;
+    data.pixels.resize(static_cast<std::size_t>(data.count) * data.features());
+    data.labels.resize(data.count);
+    Philox gen(7);
+    gen.fill(data.pixels.data(), data.pixels.size(), UniformDist{0.0f, 1.0f});
+    for (int i = 0; i < data.count; i++) data.labels[i] = static_cast<std::uint8_t>(i % 10);
+    return data;
+}
+
+void run_worker(ShmAllReduce& comm, const Options& opt) {
+    const int rank = comm.rank();
+    const int world = comm.world();
+    MnistData data = training_data();
+
+    // Same seed on every rank, so replicas start identical
+    Philox init(1);
+    MyList<Node*> params;  // forward order: w1, b1, w2, b2
+    params.push(new Node(matrix(784, 128)));
+    params.push(new Node(matrix(1, 128)));
+    params.push(new Node(matrix(128, 10)));
+    params.push(new Node(matrix(1, 10)));
+    params[0]->value.fill_xavier(init, 784, 128);
+    params[2]->value.fill_xavier(init.split(1), 128, 10);
+    std::vector<Node*> param_vec;
+    for (int i = 0; i < params.size(); i++) param_vec.push_back(params[i]);
+
+    GradientBuckets buckets(params, comm, opt.bucket_floats);
+    if (rank == 0) {
+        std::cout << world << " worker(s), global batch " << opt.batch << ", " << buckets.buckets()
+                  << " gradient bucket(s), " << data.count << " samples" << std::endl;
+        std::cout << "step | loss | acc | compute ms | reduce ms | exposed wait ms" << std::endl;
+    }
+
+    const float learning_rate = 0.1f;
+    for (int step = 0; step < opt.steps; step++) {
+        for (int i = 0; i < params.size(); i++) params[i]->grad.fill_zeroes();
+        buckets.begin();
+
+        // This rank's contiguous slice of the global batch
+        const int lo = opt.batch * rank / world;
+        const int hi = opt.batch * (rank + 1) / world;
+        float stats[3] = {0.0f, 0.0f, 0.0f};  // loss, correct, samples
+        auto compute_start = Clock::now();
+        for (int row = lo; row < hi; row++) {
+            int index = (step * opt.batch + row) % data.count;
+            Node* x = new Node(data.to_matrix(index, 1));
+            matrix target(1, 10);
+            target[0][data.labels[index]] = 1.0f;
+            Node* y = new Node(target);
+            Node* y_pred = mlp(param_vec, x);
+            Node* loss = cross_entropy(y_pred, y);
+            loss->grad = {{1.0f}};
+            // Gradients are final only after the slice's last sample, so that
+            // backward pass is the one that releases buckets as it goes
+            if (row + 1 == hi) backward_with_hooks(loss, [&](Node* leaf) { buckets.ready(leaf); });
+            else backward(loss);
+
+            stats[0] += loss->value[0][0];
+            stats[1] += argmax(y_pred->value[0]) == data.labels[index] ? 1.0f : 0.0f;
+            stats[2] += 1.0f;
+            free_graph(loss, param_vec);
+            delete y;
+        }
+        if (lo == hi)
+            for (int i = 0; i < params.size(); i++) buckets.ready(params[i]);
+        double compute_ms = elapsed_ms(compute_start);
+        buckets.wait();
+
+        std::copy(stats, stats + 3, comm.buffer());
+        comm.allreduce(3);
+        std::copy(comm.buffer(), comm.buffer() + 3, stats);
+
+        // Plain SGD on the mean gradient
+        const float scale = learning_rate / stats[2];
+        for (int i = 0; i < params.size(); i++) {
+            Node* p = params[i];
+            for (int r = 0; r < p->value.size(); r++) {
+                float* v = &p->value[r][0];
+                const float* g = &p->grad[r][0];
+                for (int c = 0; c < p->value[r].size(); c++) v[c] -= scale * g[c];
+            }
+        }
+
+        if (rank == 0 && (step % 10 == 0 || step + 1 == opt.steps)) {
+            std::cout << step << " | " << stats[0] / stats[2] << " | " << 100.0f * stats[1] / stats[2] << "% | "
+                      << compute_ms << " | " << buckets.reduce_ms() << " | " << buckets.wait_ms() << std::endl;
+        }
+    }
+
+    for (int i = 0; i < params.size(); i++) delete params[i];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        if (argc > 1) opt.workers = std::stoi(argv[1]);
+        if (argc > 2) opt.steps = std::stoi(argv[2]);
+        if (argc > 3) opt.batch = std::stoi(argv[3]);
+        if (argc > 4) opt.bucket_floats = std::stoul(argv[4]);
+        if (opt.workers < 1 || opt.steps < 0 || opt.batch < 1) throw std::invalid_argument("Bad argument");
+    } catch (const std::exception&) {
+        std::cerr << "usage: multiprocess_train [workers] [steps] [batch] [bucket floats]" << std::endl;
+        return 1;
+    }
+
+    // The largest bucket holds a whole parameter; w1 is the biggest
+    const std::size_t capacity = std::max<std::size_t>(opt.bucket_floats, 784 * 128);
+    ShmSegment segment = [&] {
+        try {
+            return ShmSegment::create("/llm_allreduce_" + std::to_string(::getpid()),
+                                      ShmAllReduce::bytes_needed(opt.workers, capacity));
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            std::exit(1);
+        }
+    }();
+    ShmAllReduce::initialize(segment.data(), opt.workers, capacity);
+
+    // Fork before any thread exists; each child only touches the mapping
+    std::vector<pid_t> children;
+    for (int rank = 0; rank < opt.workers; rank++) {
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            std::cerr << "Error: fork failed" << std::endl;
+            ShmAllReduce::abort_segment(segment.data());
+            break;
+        }
+        if (pid == 0) {
+            int status = 0;
+            try {
+                ShmAllReduce comm(segment.data(), rank);
+                try {
+                    run_worker(comm, opt);
+                } catch (...) {
+                    comm.abort();
+                    throw;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Worker " << rank << ": " << e.what() << std::endl;
+                status = 1;
+            }
+            std::cout.flush();
+            ::_exit(status);  // skip the parent's destructors, which would unlink the segment
+        }
+        children.push_back(pid);
+    }
+
+    int failures = children.size() == static_cast<std::size_t>(opt.workers) ? 0 : 1;
+    for (std::size_t i = 0; i < children.size(); i++) {
+        int status = 0;
+        pid_t pid = ::waitpid(-1, &status, 0);
+        if (pid < 0) break;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            // A crashed worker would leave its peers blocked in a collective
+            ShmAllReduce::abort_segment(segment.data());
+            if (WIFSIGNALED(status)) std::cerr << "Worker pid " << pid << " killed by signal " << WTERMSIG(status) << std::endl;
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+#include "shm_allreduce.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint32_t SHM_MAGIC = 0x52494e47;  // "RING"
+constexpr std::size_t LINE = 64;
+constexpr auto COLLECTIVE_TIMEOUT = std::chrono::seconds(120);
+
+std::size_t round_up(std::size_t n) { return (n + LINE - 1) / LINE * LINE; }
+
+// Shared (not FUTEX_PRIVATE) operations: the words live in memory mapped by
+// several processes
+void futex_wait(std::atomic<std::uint32_t>* word, std::uint32_t expected, long timeout_ns) {
+    timespec timeout{0, timeout_ns};
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void futex_wake_all(std::atomic<std::uint32_t>* word) {
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace
+
+// ---------------- SHARED SEGMENT ----------------
+ShmSegment ShmSegment::create(const std::string& name, std::size_t bytes) {
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) throw std::runtime_error("Could not create shared memory " + name + ": " + std::strerror(errno));
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        int err = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("Could not size shared memory " + name + ": " + std::strerror(err));
+    }
+
+    ShmSegment segment;
+    segment.shm_name = name;
+    segment.owner = true;
+    segment.length = bytes;
+    segment.addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (segment.addr == MAP_FAILED) {
+        segment.addr = nullptr;
+        throw std::runtime_error("Could not map shared memory " + name + ": " + std::strerror(errno));
+    }
+    return segment;
+}
+
+ShmSegment ShmSegment::open(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) throw std::runtime_error("Could not open shared memory " + name + ": " + std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Could not stat shared memory " + name + ": " + std::strerror(err));
+    }
+
+    ShmSegment segment;
+    segment.shm_name = name;
+    segment.length = static_cast<std::size_t>(st.st_size);
+    segment.addr = ::mmap(nullptr, segment.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (segment.addr == MAP_FAILED) {
+        segment.addr = nullptr;
+        throw std::runtime_error("Could not map shared memory " + name + ": " + std::strerror(errno));
+    }
+    return segment;
+}
+
+ShmSegment::~ShmSegment() {
+    if (addr) ::munmap(addr, length);
+    if (owner) ::shm_unlink(shm_name.c_str());
+}
+
+ShmSegment::ShmSegment(ShmSegment&& other) noexcept
+    : shm_name(std::move(other.shm_name)), addr(std::exchange(other.addr, nullptr)),
+      length(std::exchange(other.length, 0)), owner(std::exchange(other.owner, false)) {}
+
+ShmSegment& ShmSegment::operator=(ShmSegment&& other) noexcept {
+    if (this != &other) {
+        if (addr) ::munmap(addr, length);
+        if (owner) ::shm_unlink(shm_name.c_str());
+        shm_name = std::move(other.shm_name);
+        addr = std::exchange(other.addr, nullptr);
+        length = std::exchange(other.length, 0);
+        owner = std::exchange(other.owner, false);
+    }
+    return *this;
+}
+
+// ---------------- RING ALL-REDUCE ----------------
+// Segment layout: Control, one cache line of progress counter per rank, then
+// one line-aligned float buffer per rank
+struct alignas(64) ShmAllReduce::Control {
+    std::uint32_t magic;
+    std::uint32_t world;
+    std::uint64_t max_floats;
+    std::atomic<std::uint32_t> aborted;
+    std::atomic<std::uint32_t> barrier_count;
+    std::atomic<std::uint32_t> barrier_generation;
+};
+
+std::size_t ShmAllReduce::bytes_needed(int world, std::size_t max_floats) {
+    return round_up(sizeof(Control)) + world * LINE + world * round_up(max_floats * sizeof(float));
+}
+
+void ShmAllReduce::initialize(void* segment, int world, std::size_t max_floats) {
+    if (world < 1) throw std::invalid_argument("All-reduce needs at least one rank");
+    Control* control = new (segment) Control();
+    control->magic = SHM_MAGIC;
+    control->world = static_cast<std::uint32_t>(world);
+    control->max_floats = max_floats;
+    control->aborted.store(0);
+    control->barrier_count.store(0);
+    control->barrier_generation.store(0);
+    char* progress = static_cast<char*>(segment) + round_up(sizeof(Control));
+    for (int r = 0; r < world; r++) new (progress + r * LINE) std::atomic<std::uint32_t>(0);
+}
+
+ShmAllReduce::ShmAllReduce(void* segment, int rank)
+    : control(static_cast<Control*>(segment)), base(static_cast<char*>(segment)), my_rank(rank) {
+    if (control->magic != SHM_MAGIC) throw std::runtime_error("Shared segment was not initialised for all-reduce");
+    world_size = static_cast<int>(control->world);
+    max_floats = control->max_floats;
+    if (rank < 0 || rank >= world_size) throw std::out_of_range("Rank outside the all-reduce world");
+}
+
+std::atomic<std::uint32_t>& ShmAllReduce::progress_of(int rank) const {
+    return *reinterpret_cast<std::atomic<std::uint32_t>*>(base + round_up(sizeof(Control)) + rank * LINE);
+}
+
+float* ShmAllReduce::buffer_of(int rank) const {
+    std::size_t offset = round_up(sizeof(Control)) + world_size * LINE + rank * round_up(max_floats * sizeof(float));
+    return reinterpret_cast<float*>(base + offset);
+}
+
+bool ShmAllReduce::aborted() const { return control->aborted.load(std::memory_order_acquire) != 0; }
+
+void ShmAllReduce::abort() { abort_segment(base); }
+
+void ShmAllReduce::abort_segment(void* segment) {
+    Control* control = static_cast<Control*>(segment);
+    control->aborted.store(1, std::memory_order_release);
+    futex_wake_all(&control->barrier_generation);
+    char* progress = static_cast<char*>(segment) + round_up(sizeof(Control));
+    for (std::uint32_t r = 0; r < control->world; r++)
+        futex_wake_all(reinterpret_cast<std::atomic<std::uint32_t>*>(progress + r * LINE));
+}
+
+void ShmAllReduce::wait_for(std::atomic<std::uint32_t>& word, const std::function<bool(std::uint32_t)>& done) {
+    const auto deadline = Clock::now() + COLLECTIVE_TIMEOUT;
+    while (true) {
+        std::uint32_t value = word.load(std::memory_order_acquire);
+        if (done(value)) return;
+        if (aborted()) throw std::runtime_error("All-reduce aborted by another rank");
+        if (Clock::now() > deadline) {
+            abort();
+            throw std::runtime_error("All-reduce timed out waiting for a peer");
+        }
+        // Timed so a missed wake-up or an abort is noticed within 100 ms
+        futex_wait(&word, value, 100 * 1000 * 1000);
+    }
+}
+
+void ShmAllReduce::barrier() {
+    std::uint32_t generation = control->barrier_generation.load(std::memory_order_acquire);
+    if (control->barrier_count.fetch_add(1, std::memory_order_acq_rel) + 1 == control->world) {
+        control->barrier_count.store(0, std::memory_order_relaxed);
+        control->barrier_generation.fetch_add(1, std::memory_order_release);
+        futex_wake_all(&control->barrier_generation);
+    } else {
+        wait_for(control->barrier_generation, [&](std::uint32_t v) { return v != generation; });
+    }
+}
+
+void ShmAllReduce::allreduce(std::size_t n) {
+    if (n > max_floats) throw std::invalid_argument("All-reduce of " + std::to_string(n) + " floats exceeds buffer");
+    barrier();  // every rank has staged its input
+    if (world_size == 1) return;
+
+    const int w = world_size;
+    const int prev = (my_rank + w - 1) % w;
+    const std::uint32_t start = steps_done;  // every rank's counter is here now
+    std::atomic<std::uint32_t>& prev_progress = progress_of(prev);
+    std::atomic<std::uint32_t>& my_progress = progress_of(my_rank);
+    float* mine = buffer();
+    const float* theirs = buffer_of(prev);
+
+    auto chunk_begin = [&](int c) { return n * static_cast<std::size_t>(c) / w; };
+    auto finish_step = [&] {
+        my_progress.store(++steps_done, std::memory_order_release);
+        futex_wake_all(&my_progress);
+    };
+
+    // Reduce-scatter: afterwards rank r holds the full sum of chunk r + 1
+    for (int s = 0; s < w - 1; s++) {
+        wait_for(prev_progress, [&](std::uint32_t v) { return v >= start + s; });
+        int c = ((my_rank - 1 - s) % w + w) % w;
+        for (std::size_t i = chunk_begin(c); i < chunk_begin(c + 1); i++) mine[i] += theirs[i];
+        finish_step();
+    }
+    barrier();
+
+    // All-gather: pass finished chunks around the ring
+    for (int s = 0; s < w - 1; s++) {
+        wait_for(prev_progress, [&](std::uint32_t v) { return v >= start + (w - 1) + s; });
+        int c = ((my_rank - s) % w + w) % w;
+        std::copy(theirs + chunk_begin(c), theirs + chunk_begin(c + 1), mine + chunk_begin(c));
+        finish_step();
+    }
+    barrier();  // successor is done reading before this buffer is restaged
+}
+
+// ---------------- GRADIENT BUCKETS ----------------
+GradientBuckets::GradientBuckets(const MyList<Node*>& param_list, ShmAllReduce& comm, std::size_t bucket_floats)
+    : comm(comm) {
+    for (int i = 0; i < param_list.size(); i++) params.push_back(param_list[i]);
+    bucket_of_param.assign(params.size(), -1);
+
+    std::size_t filled = 0;
+    for (std::size_t i = params.size(); i-- > 0; ) {
+        std::size_t size = static_cast<std::size_t>(params[i]->grad.size()) * params[i]->grad[0].size();
+        if (bucket_params.empty() || (filled > 0 && filled + size > bucket_floats)) {
+            bucket_params.emplace_back();
+            bucket_floats_of.push_back(0);
+            filled = 0;
+        }
+        bucket_params.back().push_back(params[i]);
+        bucket_floats_of.back() += size;
+        bucket_of_param[i] = static_cast<int>(bucket_params.size() - 1);
+        filled += size;
+    }
+    for (std::size_t floats : bucket_floats_of) {
+        if (floats > comm.capacity()) {
+            throw std::invalid_argument("Gradient bucket of " + std::to_string(floats) +
+                                        " floats does not fit the shared buffer");
+        }
+    }
+    pending.assign(bucket_params.size(), 0);
+    worker = std::thread(&GradientBuckets::comm_loop, this);
+}
+
+GradientBuckets::~GradientBuckets() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+}
+
+void GradientBuckets::begin() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t b = 0; b < buckets(); b++) pending[b] = bucket_params[b].size();
+    reduced = 0;
+    armed = true;
+    last_reduce_ms = 0.0;
+    last_wait_ms = 0.0;
+}
+
+void GradientBuckets::ready(Node* param) {
+    auto it = std::find(params.begin(), params.end(), param);
+    if (it == params.end()) return;  // an input or other leaf
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending[bucket_of_param[it - params.begin()]]--;
+    }
+    changed.notify_all();
+}
+
+void GradientBuckets::wait() {
+    auto start = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return !armed; });
+    last_wait_ms = elapsed_ms(start);
+    if (error) std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+void GradientBuckets::comm_loop() {
+    while (true) {
+        std::size_t b;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // Buckets go out in index order so every rank reduces the same one
+            changed.wait(lock, [&] { return stopping || (armed && pending[reduced] == 0); });
+            if (stopping) return;
+            b = reduced;
+        }
+
+        auto start = Clock::now();
+        try {
+            float* staging = comm.buffer();
+            std::size_t offset = 0;
+            for (Node* p : bucket_params[b]) {
+                for (int r = 0; r < p->grad.size(); r++) {
+                    const mathVector& row = p->grad[r];
+                    std::copy(&row[0], &row[0] + row.size(), staging + offset);
+                    offset += row.size();
+                }
+            }
+            comm.allreduce(bucket_floats_of[b]);
+            offset = 0;
+            for (Node* p : bucket_params[b]) {
+                for (int r = 0; r < p->grad.size(); r++) {
+                    mathVector& row = p->grad[r];
+                    std::copy(staging + offset, staging + offset + row.size(), &row[0]);
+                    offset += row.size();
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            armed = false;
+            changed.notify_all();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last_reduce_ms += elapsed_ms(start);
+            if (++reduced == buckets()) armed = false;
+        }
+        changed.notify_all();
+    }
+}
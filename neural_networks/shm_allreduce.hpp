@@ -0,0 +1,143 @@
+#ifndef SHM_ALLREDUCE_HPP
+#define SHM_ALLREDUCE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../autograd_mechanisms/autograd.hpp"
+
+// ---------------- SHARED SEGMENT ----------------
+// POSIX shared memory object mapped read/write. The creator sizes it and
+// unlinks the name on destruction; mappings inherited through fork() or
+// opened by name stay valid until unmapped.
+class ShmSegment {
+public:
+    static ShmSegment create(const std::string& name, std::size_t bytes);
+    static ShmSegment open(const std::string& name);
+    ~ShmSegment();
+
+    ShmSegment(ShmSegment&& other) noexcept;
+    ShmSegment& operator=(ShmSegment&& other) noexcept;
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+
+    void* data() const { return addr; }
+    std::size_t size() const { return length; }
+    const std::string& name() const { return shm_name; }
+
+private:
+    ShmSegment() = default;
+
+    std::string shm_name;
+    void* addr = nullptr;
+    std::size_t length = 0;
+    bool owner = false;
+};
+
+// ---------------- RING ALL-REDUCE ----------------
+// Sum all-reduce between processes sharing one segment. Every rank owns a
+// float buffer in the segment; allreduce(n) sums the first n floats of all
+// buffers in place with the ring algorithm: n is cut into world chunks,
+// world - 1 reduce-scatter steps where rank r adds its predecessor's copy of
+// chunk (r - 1 - s) into its own, then world - 1 all-gather steps copying
+// finished chunks forward. A rank only reads its predecessor's buffer, and
+// only after the predecessor's step counter shows the chunk is done.
+// Waiting is on futexes in the segment; barriers separate the phases.
+//
+// Any rank (or the launcher) can abort(); every rank blocked in a collective
+// then throws instead of waiting for a peer that is never coming.
+class ShmAllReduce {
+public:
+    // Bytes of segment needed for `world` ranks of up to max_floats each
+    static std::size_t bytes_needed(int world, std::size_t max_floats);
+
+    // Lays out the control block; call once, before any rank attaches
+    static void initialize(void* segment, int world, std::size_t max_floats);
+
+    ShmAllReduce(void* segment, int rank);
+
+    int rank() const { return my_rank; }
+    int world() const { return world_size; }
+    std::size_t capacity() const { return max_floats; }
+
+    // This rank's buffer: stage input here, read the sum back from here
+    float* buffer() const { return buffer_of(my_rank); }
+
+    void allreduce(std::size_t n);
+    void barrier();
+
+    void abort();
+    bool aborted() const;
+
+    // Abort any segment laid out by initialize(), e.g. from the launcher
+    static void abort_segment(void* segment);
+
+private:
+    struct Control;
+
+    float* buffer_of(int rank) const;
+    std::atomic<std::uint32_t>& progress_of(int rank) const;
+    // Futex-waits on word until done(value) holds; throws on abort or timeout
+    void wait_for(std::atomic<std::uint32_t>& word, const std::function<bool(std::uint32_t)>& done);
+
+    Control* control;
+    char* base;
+    int my_rank;
+    int world_size;
+    std::size_t max_floats;
+    std::uint32_t steps_done = 0;   // this rank's progress counter value
+};
+
+// ---------------- GRADIENT BUCKETS ----------------
+// Groups parameter gradients into buckets of about bucket_floats, filled from
+// the last parameter backwards (the order backward() finishes them). A
+// background thread all-reduces bucket 0, 1, ... as soon as all of a
+// bucket's parameters are marked ready, so reduction of the late layers'
+// gradients overlaps the rest of the backward pass.
+class GradientBuckets {
+public:
+    // params in forward order
+    GradientBuckets(const MyList<Node*>& params, ShmAllReduce& comm, std::size_t bucket_floats);
+    ~GradientBuckets();
+
+    GradientBuckets(const GradientBuckets&) = delete;
+    GradientBuckets& operator=(const GradientBuckets&) = delete;
+
+    std::size_t buckets() const { return bucket_params.size(); }
+
+    void begin();             // arm every bucket for a new step
+    void ready(Node* param);  // param's gradient is final for this step
+    void wait();              // until every bucket is reduced; rethrows failures
+
+    double reduce_ms() const { return last_reduce_ms; }  // comm thread busy time
+    double wait_ms() const { return last_wait_ms; }      // time wait() blocked
+
+private:
+    void comm_loop();
+
+    ShmAllReduce& comm;
+    std::vector<std::vector<Node*>> bucket_params;
+    std::vector<std::size_t> bucket_floats_of;
+    std::vector<std::size_t> pending;       // params still outstanding per bucket
+    std::vector<int> bucket_of_param;       // bucket holding params[i]
+    std::vector<Node*> params;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t reduced = 0;                // buckets finished this step
+    bool armed = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    double last_reduce_ms = 0.0;
+    double last_wait_ms = 0.0;
+    std::thread worker;
+};
+
+#endif // SHM_ALLREDUCE_HPP
@@ -1,42 +1,31 @@
 #include <iostream>
 #include "tokenizer.hpp"
+#include "ngram.hpp"
 #include <iomanip>
 
 int main() {
 		std::string filename = "clean.txt";
-		auto tokens = tokenizeFile(filename);
+		Vocab vocab;
+		std::vector<std::uint32_t> ids = tokenizeFileToIds(filename, vocab);
 
-		if (tokens.size() < 2) {
+		if (ids.size() < 2) {
 				throw std::invalid_argument("Bi-gram requires at least 2 tokens");
 		}
-		MyList<MyList<MyList<char>>> pairs;
-		MyList<MyList<char>> pair;
-	  for (int i = 0; i < tokens.size()-1; i++) {
-				pair.push(tokens[i]);
-				pair.push(tokens[i+1]);
-				pairs.push(pair);
-				pair.clear();
-		}
 
-		for (int i = 0; i < pairs.size(); i++) {
-				for (int j = 0; j < 2; j++) {
-						for (int h = 0; h < pairs[i][j].size(); h++) {
-								std::cout << pairs[i][j][h];
-						}
-						std::cout << ' ';
+		// Pairs are counted as packed 64-bit keys, never as copied strings
+		NGramCounter bigrams(2, static_cast<std::uint32_t>(vocab.size()));
+		bigrams.add_parallel(ids);
+		BigramModel model = BigramModel::from_counts(bigrams);
+
+		std::cout << ids.size() << " tokens, " << vocab.size() << " distinct, "
+							<< model.nonzeros() << " distinct bigrams" << '\n';
+		for (std::uint32_t a = 0; a < model.vocab_size(); a++) {
+				for (std::size_t k = model.row_begin(a); k < model.row_end(a); k++) {
+						std::cout << vocab.token(a) << ' ' << vocab.token(model.next_id[k])
+											<< " | count " << model.count[k]
+											<< " | P = " << std::setprecision(3) << model.prob[k] << '\n';
 				}
-				std::cout << '\n';
-		}
-		MyList<int> counts;
-		for (int i = 0; i < pairs.size()-1; i++) {
-				counts.push(0);
-				for (int j = i+1; j < pairs.size(); j++) {
-						if (pairs[i][0] == pairs[j][0] && pairs[i][1] == pairs[j][1]) {
-								counts[i] = counts[i] + 1;
-						}
-				} 
 		}
-		
 
 		return 0;
 }
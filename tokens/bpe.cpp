@@ -0,0 +1,231 @@
+#include "bpe.hpp"
+#include "tokenizer.hpp"
+#include "parallel_tokenizer.hpp"
+#include "../utils/helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+constexpr char BPE_MAGIC[4] = {'B', 'P', 'E', 'M'};
+constexpr std::uint32_t BPE_VERSION = 1;
+
+inline std::uint64_t pair_key(std::uint32_t left, std::uint32_t right) {
+    return (static_cast<std::uint64_t>(left) << 32) | right;
+}
+
+// Max-heap order: higher count first, then the smaller pair for determinism
+struct HeapEntry {
+    std::int64_t count;
+    std::uint64_t pair;
+    bool operator<(const HeapEntry& other) const {
+        return count < other.count || (count == other.count && pair > other.pair);
+    }
+};
+
+} // namespace
+
+// ---------------- VOCAB ----------------
+BpeVocab::BpeVocab() {
+    symbols.reserve(BYTE_SYMBOLS);
+    for (std::uint32_t b = 0; b < BYTE_SYMBOLS; b++)
+        symbols.emplace_back(1, static_cast<char>(b));
+}
+
+void BpeVocab::add_merge(std::uint32_t left, std::uint32_t right) {
+    if (left >= symbols.size() || right >= symbols.size()) {
+        throw std::invalid_argument("BPE merge refers to an unknown symbol");
+    }
+    merges.push_back({left, right});
+    symbols.push_back(symbols[left] + symbols[right]);
+}
+
+void BpeVocab::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot open file for writing: " + filename);
+
+    std::uint32_t count = static_cast<std::uint32_t>(merges.size());
+    out.write(BPE_MAGIC, sizeof(BPE_MAGIC));
+    out.write(reinterpret_cast<const char*>(&BPE_VERSION), sizeof(BPE_VERSION));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& m : merges) {
+        out.write(reinterpret_cast<const char*>(&m.first), sizeof(m.first));
+        out.write(reinterpret_cast<const char*>(&m.second), sizeof(m.second));
+    }
+    if (!out) throw std::runtime_error("Failed writing BPE merges: " + filename);
+}
+
+BpeVocab BpeVocab::load(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open file for reading: " + filename);
+
+    char magic[4];
+    std::uint32_t version, count;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::string(magic, 4) != std::string(BPE_MAGIC, 4) || version != BPE_VERSION) {
+        throw std::runtime_error("Not a BPE merges file: " + filename);
+    }
+
+    BpeVocab vocab;
+    vocab.merges.reserve(count);
+    vocab.symbols.reserve(BYTE_SYMBOLS + count);
+    for (std::uint32_t i = 0; i < count; i++) {
+        std::uint32_t left, right;
+        in.read(reinterpret_cast<char*>(&left), sizeof(left));
+        in.read(reinterpret_cast<char*>(&right), sizeof(right));
+        if (!in) throw std::runtime_error("Truncated BPE merges file: " + filename);
+        vocab.add_merge(left, right);
+    }
+    return vocab;
+}
+
+// ---------------- TRAINER ----------------
+BpeTrainer::BpeTrainer(std::size_t target_merges, std::uint64_t min_frequency)
+    : target_merges(target_merges), min_frequency(min_frequency) {}
+
+void BpeTrainer::add_word(std::string_view word, std::uint64_t count) {
+    if (word.empty()) return;
+    word_counts[word] += count;
+    stats_.words += count;
+}
+
+void BpeTrainer::add_file(const std::string& filename, ThreadPool& pool) {
+    auto start = Clock::now();
+    MappedFile file(filename);
+    std::string_view text = file.view();
+
+    // Count per shard with views into the mapping, then fold in shard order
+    std::vector<std::size_t> cuts = shard_boundaries(text, 4 * pool.size());
+    std::vector<FlatHashMap<std::string_view, std::uint64_t>> local(cuts.size() - 1);
+    pool.parallel_for(0, local.size(), [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t s = lo; s < hi; s++) {
+            for_each_token(text.substr(cuts[s], cuts[s + 1] - cuts[s]), [&](std::string_view token) {
+                local[s][token]++;
+            });
+        }
+    });
+
+    for (auto& counts : local) {
+        for (const auto& kv : counts) add_word(kv.first, kv.second);
+        counts.clear();
+    }
+    stats_.count_ms += elapsed_ms(start);
+}
+
+BpeVocab BpeTrainer::train() {
+    auto start = Clock::now();
+    BpeVocab vocab;
+
+    // One symbol sequence per distinct word
+    std::vector<std::vector<std::uint32_t>> words;
+    std::vector<std::int64_t> counts;
+    words.reserve(word_counts.size());
+    counts.reserve(word_counts.size());
+    for (const auto& kv : word_counts) {
+        words.emplace_back(kv.first.begin(), kv.first.end());
+        for (std::uint32_t& s : words.back()) s &= 0xFF;
+        counts.push_back(static_cast<std::int64_t>(kv.second));
+    }
+    stats_.unique_words = words.size();
+
+    FlatHashMap<std::uint64_t, std::int64_t> pair_counts;
+    FlatHashMap<std::uint64_t, std::vector<std::uint32_t>> where;
+    for (std::uint32_t w = 0; w < words.size(); w++) {
+        const auto& sym = words[w];
+        for (std::size_t i = 0; i + 1 < sym.size(); i++) {
+            std::uint64_t key = pair_key(sym[i], sym[i + 1]);
+            pair_counts[key] += counts[w];
+            auto& list = where[key];
+            if (list.empty() || list.back() != w) list.push_back(w);
+        }
+    }
+
+    std::priority_queue<HeapEntry> heap;
+    for (const auto& kv : pair_counts) heap.push({kv.second, kv.first});
+    stats_.init_ms = elapsed_ms(start);
+
+    start = Clock::now();
+    std::vector<std::uint32_t> merged_at(words.size(), 0xFFFFFFFFu);
+    std::vector<std::uint64_t> increased;
+
+    while (vocab.merges.size() < target_merges && !heap.empty()) {
+        HeapEntry top = heap.top();
+        heap.pop();
+
+        auto found = pair_counts.find(top.pair);
+        std::int64_t actual = found == pair_counts.end() ? 0 : found->second;
+        if (actual != top.count) {
+            // Stale: the pair lost occurrences since this entry was pushed
+            if (actual > 0) heap.push({actual, top.pair});
+            continue;
+        }
+        if (actual < static_cast<std::int64_t>(min_frequency)) break;
+
+        const std::uint32_t a = static_cast<std::uint32_t>(top.pair >> 32);
+        const std::uint32_t b = static_cast<std::uint32_t>(top.pair);
+        const std::uint32_t merged = static_cast<std::uint32_t>(vocab.size());
+        const std::uint32_t stamp = static_cast<std::uint32_t>(vocab.merges.size());
+        vocab.add_merge(a, b);
+
+        std::vector<std::uint32_t> occurrences = std::move(where[top.pair]);
+        where.erase(top.pair);
+        pair_counts.erase(top.pair);
+        increased.clear();
+
+        for (std::uint32_t w : occurrences) {
+            if (merged_at[w] == stamp) continue;  // listed twice
+            merged_at[w] = stamp;
+
+            auto& sym = words[w];
+            const std::int64_t c = counts[w];
+            auto adjust = [&](std::uint64_t key, std::int64_t delta) {
+                if (key == top.pair) return;
+                std::int64_t& v = pair_counts[key];
+                v += delta;
+                if (delta > 0) {
+                    increased.push_back(key);
+                    auto& list = where[key];
+                    if (list.empty() || list.back() != w) list.push_back(w);
+                }
+            };
+
+            // In-place rewrite; the left neighbour is read from the rewritten
+            // prefix so back-to-back merges in one word are counted once.
+            std::size_t out = 0;
+            const std::size_t n = sym.size();
+            for (std::size_t i = 0; i < n; ) {
+                if (i + 1 < n && sym[i] == a && sym[i + 1] == b) {
+                    if (out > 0) {
+                        adjust(pair_key(sym[out - 1], a), -c);
+                        adjust(pair_key(sym[out - 1], merged), c);
+                    }
+                    if (i + 2 < n) {
+                        adjust(pair_key(b, sym[i + 2]), -c);
+                        adjust(pair_key(merged, sym[i + 2]), c);
+                    }
+                    sym[out++] = merged;
+                    i += 2;
+                } else {
+                    sym[out++] = sym[i++];
+                }
+            }
+            sym.resize(out);
+        }
+
+        std::sort(increased.begin(), increased.end());
+        increased.erase(std::unique(increased.begin(), increased.end()), increased.end());
+        for (std::uint64_t key : increased) {
+            std::int64_t c = pair_counts.at(key);
+            if (c > 0) heap.push({c, key});
+        }
+    }
+
+    stats_.merges = vocab.merges.size();
+    stats_.merge_ms = elapsed_ms(start);
+    return vocab;
+}
@@ -0,0 +1,71 @@
+#ifndef BPE_HPP
+#define BPE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../math_primitives/hashmap.hpp"
+#include "../utils/thread_pool.hpp"
+
+// Byte-level BPE vocabulary. Symbols 0..255 are single bytes; merge i joins
+// merges[i].first and merges[i].second into symbol 256 + i.
+struct BpeVocab {
+    static constexpr std::uint32_t BYTE_SYMBOLS = 256;
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> merges;
+    std::vector<std::string> symbols;  // bytes of every symbol, rebuilt from merges
+
+    BpeVocab();
+
+    std::size_t size() const { return symbols.size(); }
+    void add_merge(std::uint32_t left, std::uint32_t right);
+
+    // Binary format: "BPEM", version, merge count, (left, right) per merge
+    void save(const std::string& filename) const;
+    static BpeVocab load(const std::string& filename);
+};
+
+struct BpeTrainStats {
+    std::uint64_t words = 0;         // pre-tokens seen
+    std::uint64_t unique_words = 0;  // after frequency deduplication
+    std::uint64_t merges = 0;
+    double count_ms = 0.0;           // word counting
+    double init_ms = 0.0;            // initial pair counts and heap
+    double merge_ms = 0.0;           // merge loop
+
+    double merges_per_sec() const { return merge_ms > 0.0 ? merges / (merge_ms / 1e3) : 0.0; }
+};
+
+// Trains BPE merges over word-frequency-deduplicated input.
+//
+// Each distinct word is stored once as a symbol sequence with its count.
+// Pair counts live in a hash map keyed by (left << 32 | right), with a lazy
+// max-heap over them: increments push a fresh entry, decrements are noticed
+// when a stale entry reaches the top. Every pair keeps the list of words it
+// occurs in, so applying a merge only rewrites those words and adjusts the
+// counts of the pairs around each rewritten position, instead of rescanning
+// the corpus.
+class BpeTrainer {
+public:
+    explicit BpeTrainer(std::size_t target_merges, std::uint64_t min_frequency = 2);
+
+    void add_word(std::string_view word, std::uint64_t count = 1);
+
+    // Counts the pre-tokens of a file (tokenizer.hpp rules) across the pool
+    void add_file(const std::string& filename, ThreadPool& pool = default_thread_pool());
+
+    // Stops early if the best pair occurs fewer than min_frequency times
+    BpeVocab train();
+
+    const BpeTrainStats& stats() const { return stats_; }
+
+private:
+    std::size_t target_merges;
+    std::uint64_t min_frequency;
+    FlatHashMap<std::string, std::uint64_t> word_counts;
+    BpeTrainStats stats_;
+};
+
+#endif // BPE_HPP
@@ -0,0 +1,66 @@
+#include "bpe_encoder.hpp"
+#include "tokenizer.hpp"
+#include <chrono>
+#include <iostream>
+
+// Encode latency for trained merges: cold (empty cache), warm (cached words)
+// and batched over the thread pool. Each line of the corpus is one prompt.
+//
+// usage: bpe_encode_bench [merges] [corpus] [threads]
+
+int main(int argc, char** argv) {
+    std::string merges_file = argc > 1 ? argv[1] : "bpe.merges";
+    std::string corpus = argc > 2 ? argv[2] : "test.txt";
+    std::size_t threads = argc > 3 ? std::stoul(argv[3]) : 0;
+
+    try {
+        BpeVocab vocab = BpeVocab::load(merges_file);
+        MappedFile file(corpus);
+        std::string_view text = file.view();
+
+        std::vector<std::string_view> prompts;
+        for (std::size_t start = 0; start < text.size(); ) {
+            std::size_t end = text.find('\n', start);
+            if (end == std::string_view::npos) end = text.size();
+            if (end > start) prompts.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        std::cout << "Vocab: " << vocab.size() << " symbols | prompts: " << prompts.size()
+                  << " | bytes: " << text.size() << std::endl;
+
+        auto time_ms = [](auto&& f) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+        BpeEncoder uncached(vocab, 0);
+        BpeEncoder encoder(vocab);
+        std::size_t symbols = 0;
+
+        double cold = time_ms([&] { for (auto p : prompts) symbols += uncached.encode(p).size(); });
+        double fill = time_ms([&] { for (auto p : prompts) encoder.encode(p); });
+        double warm = time_ms([&] { for (auto p : prompts) encoder.encode(p); });
+
+        ThreadPool pool(threads);
+        std::vector<std::vector<std::uint32_t>> batch;
+        double batched = time_ms([&] { batch = encoder.encode_batch(prompts, pool); });
+
+        bool same = batch.size() == prompts.size();
+        for (std::size_t i = 0; same && i < prompts.size(); i++)
+            same = batch[i] == uncached.encode(prompts[i]);
+
+        auto per_prompt = [&](double ms) { return ms * 1e3 / std::max<std::size_t>(1, prompts.size()); };
+        std::cout << "Symbols out: " << symbols << " (" << static_cast<double>(text.size()) / symbols
+                  << " bytes/symbol)" << std::endl;
+        std::cout << "No cache   : " << cold << " ms, " << per_prompt(cold) << " us/prompt" << std::endl;
+        std::cout << "Cache fill : " << fill << " ms, " << per_prompt(fill) << " us/prompt" << std::endl;
+        std::cout << "Cache warm : " << warm << " ms, " << per_prompt(warm) << " us/prompt" << std::endl;
+        std::cout << "Batch (" << pool.size() << " threads): " << batched << " ms | "
+                  << (same ? "matches serial" : "MISMATCH") << std::endl;
+        return same ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,130 @@
+#include "bpe_encoder.hpp"
+#include "tokenizer.hpp"
+#include <queue>
+
+namespace {
+
+inline std::uint64_t pair_key(std::uint32_t left, std::uint32_t right) {
+    return (static_cast<std::uint64_t>(left) << 32) | right;
+}
+
+// Min-heap order on (rank, position)
+struct Candidate {
+    std::uint32_t rank;
+    std::uint32_t pos;
+    std::uint32_t left;
+    std::uint32_t right;
+    bool operator<(const Candidate& other) const {
+        return rank > other.rank || (rank == other.rank && pos > other.pos);
+    }
+};
+
+constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+} // namespace
+
+BpeEncoder::BpeEncoder(const BpeVocab& vocab, std::size_t cache_words)
+    : ranks(vocab.merges.size()), symbols(vocab.symbols),
+      shard_capacity(cache_words / CACHE_SHARDS) {
+    for (std::uint32_t r = 0; r < vocab.merges.size(); r++) {
+        const auto& m = vocab.merges[r];
+        ranks.try_emplace(pair_key(m.first, m.second), MergeRule{r, BpeVocab::BYTE_SYMBOLS + r});
+    }
+}
+
+void BpeEncoder::merge_word(std::string_view word, std::vector<std::uint32_t>& out) const {
+    const std::uint32_t n = static_cast<std::uint32_t>(word.size());
+    std::vector<std::uint32_t> sym(n), prev(n), next(n);
+    for (std::uint32_t i = 0; i < n; i++) {
+        sym[i] = static_cast<unsigned char>(word[i]);
+        prev[i] = i == 0 ? NONE : i - 1;
+        next[i] = i + 1 == n ? NONE : i + 1;
+    }
+
+    std::priority_queue<Candidate> heap;
+    auto consider = [&](std::uint32_t pos) {
+        if (pos == NONE || next[pos] == NONE) return;
+        auto it = ranks.find(pair_key(sym[pos], sym[next[pos]]));
+        if (it != ranks.end()) heap.push({it->second.rank, pos, sym[pos], sym[next[pos]]});
+    };
+    for (std::uint32_t i = 0; i + 1 < n; i++) consider(i);
+
+    while (!heap.empty()) {
+        Candidate c = heap.top();
+        heap.pop();
+        // Skip candidates whose symbols changed since they were pushed
+        std::uint32_t right = next[c.pos];
+        if (sym[c.pos] != c.left || right == NONE || sym[right] != c.right) continue;
+
+        sym[c.pos] = BpeVocab::BYTE_SYMBOLS + c.rank;
+        sym[right] = NONE;  // dead
+        next[c.pos] = next[right];
+        if (next[right] != NONE) prev[next[right]] = c.pos;
+
+        consider(prev[c.pos]);
+        consider(c.pos);
+    }
+
+    for (std::uint32_t i = 0; i != NONE && n > 0; i = next[i]) out.push_back(sym[i]);
+}
+
+void BpeEncoder::encode_word(std::string_view word, std::vector<std::uint32_t>& out) const {
+    if (word.empty()) return;
+    if (shard_capacity == 0) {
+        merge_word(word, out);
+        return;
+    }
+
+    CacheShard& shard = cache[hash_bytes(word.data(), word.size()) >> (64 - CACHE_SHARD_BITS)];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto hit = shard.index.find(word);
+        if (hit != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, hit->second);
+            const auto& ids = hit->second->second;
+            out.insert(out.end(), ids.begin(), ids.end());
+            return;
+        }
+    }
+
+    // Encode outside the lock; a racing thread may insert the same word first
+    std::vector<std::uint32_t> ids;
+    merge_word(word, ids);
+    out.insert(out.end(), ids.begin(), ids.end());
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.index.contains(word)) return;
+    shard.lru.emplace_front(std::string(word), std::move(ids));
+    shard.index.try_emplace(std::string_view(shard.lru.front().first), shard.lru.begin());
+    if (shard.lru.size() > shard_capacity) {
+        shard.index.erase(std::string_view(shard.lru.back().first));
+        shard.lru.pop_back();
+    }
+}
+
+std::vector<std::uint32_t> BpeEncoder::encode(std::string_view text) const {
+    std::vector<std::uint32_t> out;
+    out.reserve(text.size() / 3);
+    for_each_token(text, [&](std::string_view word) { encode_word(word, out); });
+    return out;
+}
+
+std::vector<std::vector<std::uint32_t>> BpeEncoder::encode_batch(const std::vector<std::string_view>& texts,
+                                                                 ThreadPool& pool) const {
+    std::vector<std::vector<std::uint32_t>> out(texts.size());
+    pool.parallel_for(0, texts.size(), [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; i++) out[i] = encode(texts[i]);
+    });
+    return out;
+}
+
+std::string BpeEncoder::decode(const std::vector<std::uint32_t>& ids) const {
+    std::string text;
+    for (std::uint32_t id : ids) {
+        if (id >= symbols.size()) {
+            throw std::out_of_range("BPE id " + std::to_string(id) + " is not in the vocab");
+        }
+        text += symbols[id];
+    }
+    return text;
+}
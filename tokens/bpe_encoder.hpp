@@ -0,0 +1,69 @@
+#ifndef BPE_ENCODER_HPP
+#define BPE_ENCODER_HPP
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bpe.hpp"
+#include "../math_primitives/hashmap.hpp"
+#include "../utils/thread_pool.hpp"
+
+// Encodes text with a trained BpeVocab.
+//
+// A word starts as its bytes in a doubly linked list. Candidate adjacent
+// pairs sit in a min-heap keyed by (merge rank, position); popping the best
+// one, checking it is still current, and splicing the right symbol out only
+// creates the two new neighbour pairs. That is O(n log n) per word rather
+// than one rescan per applied merge, and applies merges in exactly the order
+// the trainer did (lowest rank first, leftmost first).
+//
+// Encoded words go into a sharded LRU cache, so common words cost one hash
+// lookup. All encode calls are safe to make from several threads.
+class BpeEncoder {
+public:
+    explicit BpeEncoder(const BpeVocab& vocab, std::size_t cache_words = 1 << 16);
+
+    // Appends the symbols of one pre-token to out
+    void encode_word(std::string_view word, std::vector<std::uint32_t>& out) const;
+
+    // Pre-tokenizes text (tokenizer.hpp rules) and encodes every word
+    std::vector<std::uint32_t> encode(std::string_view text) const;
+
+    // One result per input text, texts spread over the pool
+    std::vector<std::vector<std::uint32_t>> encode_batch(const std::vector<std::string_view>& texts,
+                                                         ThreadPool& pool = default_thread_pool()) const;
+
+    std::string decode(const std::vector<std::uint32_t>& ids) const;
+
+    std::size_t vocab_size() const { return symbols.size(); }
+
+private:
+    struct MergeRule {
+        std::uint32_t rank;
+        std::uint32_t merged;
+    };
+
+    // Shard of the word cache: an LRU list plus an index of views into its keys
+    struct CacheShard {
+        using Entry = std::pair<std::string, std::vector<std::uint32_t>>;
+        std::mutex mutex;
+        std::list<Entry> lru;  // most recent first
+        FlatHashMap<std::string_view, std::list<Entry>::iterator> index;
+    };
+    // The shard comes from the hash's top bits: FlatHashMap takes its tag
+    // from the low 7 and its probe start from the bits above them
+    static constexpr int CACHE_SHARD_BITS = 4;
+    static constexpr std::size_t CACHE_SHARDS = std::size_t{1} << CACHE_SHARD_BITS;
+
+    void merge_word(std::string_view word, std::vector<std::uint32_t>& out) const;
+
+    FlatHashMap<std::uint64_t, MergeRule> ranks;  // (left << 32 | right) -> rule
+    std::vector<std::string> symbols;
+    std::size_t shard_capacity;
+    mutable CacheShard cache[CACHE_SHARDS];
+};
+
+#endif // BPE_ENCODER_HPP
@@ -0,0 +1,38 @@
+#include "bpe.hpp"
+#include <iostream>
+
+// Trains BPE merges on a corpus and writes them to disk, reporting where the
+// time goes and the merge rate.
+//
+// usage: bpe_train [corpus] [merges] [output]
+
+int main(int argc, char** argv) {
+    std::string corpus = argc > 1 ? argv[1] : "test.txt";
+    std::size_t merges = argc > 2 ? std::stoul(argv[2]) : 32000;
+    std::string output = argc > 3 ? argv[3] : "bpe.merges";
+
+    try {
+        BpeTrainer trainer(merges);
+        trainer.add_file(corpus);
+        BpeVocab vocab = trainer.train();
+        vocab.save(output);
+
+        const BpeTrainStats& stats = trainer.stats();
+        std::cout << "Words: " << stats.words << " (" << stats.unique_words << " unique)" << std::endl;
+        std::cout << "Merges: " << stats.merges << " of " << merges << " requested" << std::endl;
+        std::cout << "Word counting: " << stats.count_ms << " ms" << std::endl;
+        std::cout << "Pair init: " << stats.init_ms << " ms" << std::endl;
+        std::cout << "Merge loop: " << stats.merge_ms << " ms (" << stats.merges_per_sec() << " merges/sec)" << std::endl;
+        std::cout << "Total: " << stats.count_ms + stats.init_ms + stats.merge_ms << " ms" << std::endl;
+
+        std::size_t show = std::min<std::size_t>(10, vocab.merges.size());
+        std::cout << "First merges:";
+        for (std::size_t i = 0; i < show; i++)
+            std::cout << " '" << vocab.symbols[BpeVocab::BYTE_SYMBOLS + i] << "'";
+        std::cout << std::endl << "Saved to " << output << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
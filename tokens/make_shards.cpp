@@ -0,0 +1,83 @@
+#include "bpe_encoder.hpp"
+#include "parallel_tokenizer.hpp"
+#include "token_shard.hpp"
+#include <chrono>
+#include <iostream>
+
+// Tokenizes a corpus once and writes the IDs as binary shards, so training
+// runs map them instead of re-tokenizing text every epoch. Without a merges
+// file the word-level tokenizer is used and its vocab saved as <prefix>.vocab.
+// Ends with a sampling pass over the written shards.
+//
+// usage: make_shards [corpus] [prefix] [tokens per shard] [merges]
+
+int main(int argc, char** argv) {
+    std::string corpus = argc > 1 ? argv[1] : "test.txt";
+    std::string prefix = argc > 2 ? argv[2] : "corpus";
+    std::size_t per_shard = argc > 3 ? std::stoul(argv[3]) : 100000000;
+    std::string merges_file = argc > 4 ? argv[4] : "";
+
+    try {
+        if (per_shard == 0) throw std::invalid_argument("tokens per shard must be positive");
+        ThreadPool& pool = default_thread_pool();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::uint32_t> ids;
+        std::uint32_t vocab_size;
+        if (merges_file.empty()) {
+            Vocab vocab;
+            ids = tokenizeFileParallel(corpus, vocab, pool);
+            vocab.save(prefix + ".vocab");
+            vocab_size = static_cast<std::uint32_t>(vocab.size());
+        } else {
+            BpeEncoder encoder(BpeVocab::load(merges_file));
+            MappedFile file(corpus);
+            std::vector<std::size_t> cuts = shard_boundaries(file.view(), 4 * pool.size());
+            std::vector<std::string_view> pieces;
+            for (std::size_t i = 0; i + 1 < cuts.size(); i++)
+                pieces.push_back(file.view().substr(cuts[i], cuts[i + 1] - cuts[i]));
+            for (const auto& piece : encoder.encode_batch(pieces, pool))
+                ids.insert(ids.end(), piece.begin(), piece.end());
+            vocab_size = static_cast<std::uint32_t>(encoder.vocab_size());
+        }
+        auto tokenized = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::string> names;
+        for (std::size_t first = 0; first < ids.size(); first += per_shard) {
+            std::string name = prefix + "_" + std::to_string(names.size()) + ".bin";
+            ShardWriter writer(name, vocab_size);
+            writer.write(ids.data() + first, std::min(per_shard, ids.size() - first));
+            writer.close();
+            names.push_back(name);
+        }
+        auto written = std::chrono::high_resolution_clock::now();
+
+        auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+        std::cout << "Tokens: " << ids.size() << " | vocab: " << vocab_size << " | "
+                  << (vocab_size <= 65536 ? 2 : 4) << " bytes/ID" << std::endl;
+        std::cout << "Tokenize: " << ms(start, tokenized) << " ms | write " << names.size()
+                  << " shard(s): " << ms(tokenized, written) << " ms" << std::endl;
+
+        // Sampling straight from the mapped shards
+        TokenDataset dataset(names);
+        Philox rng(42);
+        TokenBatch batch;
+        const int batch_size = 32, seq_len = 256, steps = 1000;
+        // A window of seq_len + 1 tokens must fit in one shard
+        const std::size_t longest = std::min(per_shard, ids.size());
+        if (longest <= static_cast<std::size_t>(seq_len)) {
+            std::cout << "Shards hold at most " << longest << " tokens, too few for a window of " << seq_len + 1
+                      << "; not sampling" << std::endl;
+        } else {
+            auto sample_start = std::chrono::high_resolution_clock::now();
+            for (int step = 0; step < steps; step++) dataset.sample_batch(batch_size, seq_len, rng, step, batch);
+            double sample_ms = ms(sample_start, std::chrono::high_resolution_clock::now());
+            std::cout << "Sampled " << steps << " batches of " << batch_size << "x" << seq_len << ": "
+                      << sample_ms * 1e3 / steps << " us/batch" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
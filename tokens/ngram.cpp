@@ -0,0 +1,166 @@
+#include "ngram.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+inline NGramKey to_key(__uint128_t v) {
+    return NGramKey{static_cast<std::uint64_t>(v), static_cast<std::uint64_t>(v >> 64)};
+}
+
+inline __uint128_t from_key(const NGramKey& key) {
+    return (static_cast<__uint128_t>(key.hi) << 64) | key.lo;
+}
+
+} // namespace
+
+// ---------------- COUNTER ----------------
+NGramCounter::NGramCounter(int order, std::uint32_t vocab_size) : n(order), vocab(vocab_size) {
+    if (order < 1 || order > MAX_ORDER) {
+        throw std::invalid_argument("n-gram order must be between 1 and " + std::to_string(MAX_ORDER));
+    }
+    bits = 1;
+    while (bits < 32 && (1ull << bits) < vocab_size) bits++;
+    if (order * bits > 128) {
+        throw std::invalid_argument("A " + std::to_string(order) + "-gram over " + std::to_string(vocab_size) +
+                                    " IDs does not fit in a 128-bit key");
+    }
+}
+
+NGramKey NGramCounter::pack(const std::uint32_t* ids) const {
+    __uint128_t v = 0;
+    for (int i = 0; i < n; i++) {
+        if (ids[i] >= vocab) {
+            throw std::out_of_range("Token id " + std::to_string(ids[i]) + " is outside the n-gram vocab");
+        }
+        v = (v << bits) | ids[i];
+    }
+    return to_key(v);
+}
+
+void NGramCounter::unpack(const NGramKey& key, std::uint32_t* ids) const {
+    __uint128_t v = from_key(key);
+    const __uint128_t mask = (static_cast<__uint128_t>(1) << bits) - 1;
+    for (int i = n - 1; i >= 0; i--) {
+        ids[i] = static_cast<std::uint32_t>(v & mask);
+        v >>= bits;
+    }
+}
+
+void NGramCounter::add(const std::uint32_t* ids, std::size_t count) {
+    if (count < static_cast<std::size_t>(n)) return;
+
+    // Rolling key: shift in the newest ID, mask off the one that left
+    const __uint128_t window_mask = n * bits == 128
+        ? ~static_cast<__uint128_t>(0)
+        : (static_cast<__uint128_t>(1) << (n * bits)) - 1;
+    __uint128_t v = from_key(pack(ids));
+    table[to_key(v)]++;
+    for (std::size_t i = n; i < count; i++) {
+        if (ids[i] >= vocab) {
+            throw std::out_of_range("Token id " + std::to_string(ids[i]) + " is outside the n-gram vocab");
+        }
+        v = ((v << bits) | ids[i]) & window_mask;
+        table[to_key(v)]++;
+    }
+    total_count += count - n + 1;
+}
+
+void NGramCounter::add_parallel(const std::vector<std::uint32_t>& ids, ThreadPool& pool) {
+    if (ids.size() < static_cast<std::size_t>(n)) return;
+    const std::size_t windows = ids.size() - n + 1;
+    const std::size_t shards = std::min(windows, 4 * pool.size());
+
+    std::vector<NGramCounter> local(shards, NGramCounter(n, vocab));
+    pool.parallel_for(0, shards, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t s = lo; s < hi; s++) {
+            std::size_t first = windows * s / shards;
+            std::size_t last = windows * (s + 1) / shards;
+            local[s].add(ids.data() + first, last - first + n - 1);
+        }
+    });
+    for (const auto& shard : local) merge(shard);
+}
+
+void NGramCounter::merge(const NGramCounter& other) {
+    if (other.n != n || other.vocab != vocab) {
+        throw std::invalid_argument("Cannot merge n-gram counters of different order or vocab");
+    }
+    table.reserve(table.size() + other.table.size());
+    for (const auto& kv : other.table) table[kv.first] += kv.second;
+    total_count += other.total_count;
+}
+
+std::uint64_t NGramCounter::count(const std::uint32_t* gram) const {
+    auto it = table.find(pack(gram));
+    return it == table.end() ? 0 : it->second;
+}
+
+// ---------------- BIGRAM MODEL ----------------
+BigramModel BigramModel::from_counts(const NGramCounter& bigrams) {
+    if (bigrams.order() != 2) {
+        throw std::invalid_argument("BigramModel needs order-2 counts");
+    }
+    const std::uint32_t vocab = bigrams.vocab_size();
+    BigramModel model;
+    model.row_start.assign(static_cast<std::size_t>(vocab) + 1, 0);
+    model.totals.assign(vocab, 0);
+
+    // Counting sort by row, then sort each row by successor
+    std::uint32_t pair[2];
+    for (const auto& kv : bigrams.counts()) {
+        bigrams.unpack(kv.first, pair);
+        model.row_start[pair[0] + 1]++;
+        model.totals[pair[0]] += kv.second;
+    }
+    for (std::uint32_t a = 0; a < vocab; a++) model.row_start[a + 1] += model.row_start[a];
+
+    const std::size_t nnz = bigrams.distinct();
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> cells(nnz);
+    std::vector<std::uint64_t> fill(model.row_start.begin(), model.row_start.end() - 1);
+    for (const auto& kv : bigrams.counts()) {
+        bigrams.unpack(kv.first, pair);
+        cells[fill[pair[0]]++] = {pair[1], kv.second};
+    }
+
+    model.next_id.resize(nnz);
+    model.count.resize(nnz);
+    model.prob.resize(nnz);
+    for (std::uint32_t a = 0; a < vocab; a++) {
+        auto first = cells.begin() + model.row_start[a];
+        auto last = cells.begin() + model.row_start[a + 1];
+        std::sort(first, last);
+        for (std::size_t k = model.row_start[a]; k < model.row_start[a + 1]; k++) {
+            model.next_id[k] = cells[k].first;
+            model.count[k] = cells[k].second;
+            model.prob[k] = static_cast<float>(static_cast<double>(cells[k].second) / model.totals[a]);
+        }
+    }
+    return model;
+}
+
+float BigramModel::probability(std::uint32_t a, std::uint32_t b, float alpha) const {
+    if (a >= vocab_size() || b >= vocab_size()) {
+        throw std::out_of_range("Bigram lookup outside the vocab");
+    }
+    auto first = next_id.begin() + row_start[a];
+    auto last = next_id.begin() + row_start[a + 1];
+    auto it = std::lower_bound(first, last, b);
+    std::uint64_t c = (it != last && *it == b) ? count[it - next_id.begin()] : 0;
+
+    if (alpha > 0.0f) {
+        return static_cast<float>((c + alpha) / (static_cast<double>(totals[a]) + alpha * vocab_size()));
+    }
+    return totals[a] == 0 ? 0.0f : static_cast<float>(static_cast<double>(c) / totals[a]);
+}
+
+std::uint32_t BigramModel::sample(std::uint32_t a, float u) const {
+    if (a >= vocab_size() || row_start[a] == row_start[a + 1]) return vocab_size();
+    float cumulative = 0.0f;
+    for (std::size_t k = row_start[a]; k < row_start[a + 1]; k++) {
+        cumulative += prob[k];
+        if (u < cumulative) return next_id[k];
+    }
+    return next_id[row_start[a + 1] - 1];
+}
@@ -0,0 +1,90 @@
+#ifndef NGRAM_HPP
+#define NGRAM_HPP
+
+#include <cstdint>
+#include <vector>
+#include "../math_primitives/hashmap.hpp"
+#include "../utils/thread_pool.hpp"
+
+// An n-gram of token IDs bit-packed into 128 bits, first ID in the highest
+// position. Each ID takes ceil(log2(vocab_size)) bits, so bigrams over any
+// 32-bit vocab fit in `lo` alone as (a << bits | b), and 5-grams fit for
+// vocabularies up to 2^25.
+struct NGramKey {
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+    bool operator==(const NGramKey& other) const { return lo == other.lo && hi == other.hi; }
+};
+
+struct NGramKeyHash {
+    std::uint64_t operator()(const NGramKey& key) const { return hash_u64(key.lo ^ hash_u64(key.hi)); }
+};
+
+using NGramTable = FlatHashMap<NGramKey, std::uint64_t, NGramKeyHash>;
+
+// Counts every window of `order` consecutive IDs in open-addressing tables.
+class NGramCounter {
+public:
+    static constexpr int MAX_ORDER = 5;
+
+    NGramCounter(int order, std::uint32_t vocab_size);
+
+    int order() const { return n; }
+    std::uint32_t vocab_size() const { return vocab; }
+
+    NGramKey pack(const std::uint32_t* ids) const;
+    void unpack(const NGramKey& key, std::uint32_t* ids) const;
+
+    // Counts the windows of one contiguous ID sequence
+    void add(const std::uint32_t* ids, std::size_t count);
+
+    // Same result as add(), shards counted on the pool into private tables
+    // and summed. A shard owns the windows starting inside it and reads up to
+    // order - 1 IDs past its end, so no window is counted twice.
+    void add_parallel(const std::vector<std::uint32_t>& ids, ThreadPool& pool = default_thread_pool());
+
+    void merge(const NGramCounter& other);
+
+    std::uint64_t count(const std::uint32_t* gram) const;
+    std::size_t distinct() const { return table.size(); }
+    std::uint64_t total() const { return total_count; }
+    const NGramTable& counts() const { return table; }
+
+private:
+    int n;
+    std::uint32_t vocab;
+    int bits;
+    NGramTable table;
+    std::uint64_t total_count = 0;
+};
+
+// Bigram language model as a sparse count matrix in CSR form: row a lists
+// the observed successors of token a sorted by ID, with counts and
+// P(b | a) = count(a, b) / count(a, *).
+class BigramModel {
+public:
+    static BigramModel from_counts(const NGramCounter& bigrams);
+
+    std::uint32_t vocab_size() const { return static_cast<std::uint32_t>(row_start.size() - 1); }
+    std::size_t nonzeros() const { return next_id.size(); }
+
+    // Observed successors of a: next_id/count/prob over [row_begin, row_end)
+    std::size_t row_begin(std::uint32_t a) const { return row_start[a]; }
+    std::size_t row_end(std::uint32_t a) const { return row_start[a + 1]; }
+    std::uint64_t row_total(std::uint32_t a) const { return totals[a]; }
+
+    // P(b | a); alpha > 0 applies add-alpha smoothing over the whole vocab
+    float probability(std::uint32_t a, std::uint32_t b, float alpha = 0.0f) const;
+
+    // Successor of a drawn with P(b | a), given u uniform in [0, 1);
+    // returns vocab_size() if a was never followed by anything
+    std::uint32_t sample(std::uint32_t a, float u) const;
+
+    std::vector<std::uint64_t> row_start;
+    std::vector<std::uint32_t> next_id;
+    std::vector<std::uint64_t> count;
+    std::vector<float> prob;
+    std::vector<std::uint64_t> totals;
+};
+
+#endif // NGRAM_HPP
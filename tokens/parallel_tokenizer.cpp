@@ -0,0 +1,73 @@
+#include "parallel_tokenizer.hpp"
+#include "tokenizer.hpp"
+
+std::vector<std::size_t> shard_boundaries(std::string_view text, std::size_t shards) {
+    std::vector<std::size_t> cuts;
+    cuts.push_back(0);
+    if (shards == 0) shards = 1;
+    for (std::size_t i = 1; i < shards; i++) {
+        std::size_t target = text.size() / shards * i;
+        if (target <= cuts.back()) continue;
+        std::size_t cut = token_boundary_at_or_after(text, target);
+        if (cut > cuts.back() && cut < text.size()) cuts.push_back(cut);
+    }
+    cuts.push_back(text.size());
+    return cuts;
+}
+
+std::vector<std::uint32_t> tokenizeFileParallel(const std::string& filename, Vocab& vocab,
+                                                ThreadPool& pool, std::size_t shards) {
+    MappedFile file(filename);
+    std::string_view text = file.view();
+    if (text.empty()) return {};
+
+    if (shards == 0) shards = 4 * pool.size();
+    std::vector<std::size_t> cuts = shard_boundaries(text, shards);
+    const std::size_t count = cuts.size() - 1;
+
+    // Phase 1: tokenize every shard into a local vocab and local IDs
+    std::vector<Vocab> local_vocab(count);
+    std::vector<std::vector<std::uint32_t>> local_ids(count);
+    pool.parallel_for(0, count, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t s = lo; s < hi; s++) {
+            std::string_view shard = text.substr(cuts[s], cuts[s + 1] - cuts[s]);
+            local_ids[s].reserve(shard.size() / 5);
+            for_each_token(shard, [&](std::string_view token) {
+                local_ids[s].push_back(local_vocab[s].intern(token));
+            });
+        }
+    });
+
+    // Phase 2: look up tokens the global vocab already knows (read-only, parallel)
+    std::vector<std::vector<std::uint32_t>> remap(count);
+    pool.parallel_for(0, count, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t s = lo; s < hi; s++) {
+            remap[s].resize(local_vocab[s].size());
+            for (std::uint32_t id = 0; id < local_vocab[s].size(); id++)
+                remap[s][id] = vocab.find(local_vocab[s].token(id));
+        }
+    });
+
+    // Phase 3: intern the rest in shard order, which fixes the global IDs
+    for (std::size_t s = 0; s < count; s++) {
+        for (std::uint32_t id = 0; id < remap[s].size(); id++) {
+            if (remap[s][id] == Vocab::UNKNOWN)
+                remap[s][id] = vocab.intern(local_vocab[s].token(id));
+        }
+    }
+
+    // Phase 4: rewrite local IDs into their slice of the output
+    std::vector<std::size_t> offsets(count + 1, 0);
+    for (std::size_t s = 0; s < count; s++)
+        offsets[s + 1] = offsets[s] + local_ids[s].size();
+
+    std::vector<std::uint32_t> ids(offsets[count]);
+    pool.parallel_for(0, count, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t s = lo; s < hi; s++) {
+            std::uint32_t* out = ids.data() + offsets[s];
+            for (std::uint32_t local : local_ids[s]) *out++ = remap[s][local];
+            std::vector<std::uint32_t>().swap(local_ids[s]);
+        }
+    });
+    return ids;
+}
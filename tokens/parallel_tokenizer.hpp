@@ -0,0 +1,31 @@
+#ifndef PARALLEL_TOKENIZER_HPP
+#define PARALLEL_TOKENIZER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "vocab.hpp"
+#include "../utils/thread_pool.hpp"
+
+// Byte offsets splitting text into about `shards` ranges, each cut moved
+// forward onto a delimiter so no token straddles two shards. Starts with 0,
+// ends with text.size(), strictly increasing.
+std::vector<std::size_t> shard_boundaries(std::string_view text, std::size_t shards);
+
+// Parallel version of tokenizeFileToIds with identical output: the same IDs
+// in the same order, and the same vocab afterwards.
+//
+// Each shard is tokenized on the pool into its own local Vocab. Local vocabs
+// are then folded into `vocab` in shard order: a token new to the corpus is
+// first seen in the earliest shard containing it, at its first position
+// there, so interning shard by shard (each in local first-seen order)
+// reproduces the serial first-appearance IDs. Lookups of already-known tokens
+// run in parallel; only unseen tokens are interned serially. Finally each
+// shard's local IDs are remapped in parallel into one output array.
+//
+// shards == 0 picks four per pool thread.
+std::vector<std::uint32_t> tokenizeFileParallel(const std::string& filename, Vocab& vocab,
+                                                ThreadPool& pool, std::size_t shards = 0);
+
+#endif // PARALLEL_TOKENIZER_HPP
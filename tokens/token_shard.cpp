@@ -0,0 +1,144 @@
+#include "token_shard.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr char SHARD_MAGIC[8] = {'L', 'L', 'M', 'T', 'O', 'K', 'S', '\0'};
+constexpr std::uint32_t SHARD_VERSION = 1;
+
+} // namespace
+
+// ---------------- WRITER ----------------
+ShardWriter::ShardWriter(const std::string& filename, std::uint32_t vocab_size)
+    : out(filename, std::ios::binary), filename(filename) {
+    if (!out) throw std::runtime_error("Cannot open file for writing: " + filename);
+    std::memcpy(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC));
+    header.version = SHARD_VERSION;
+    header.id_bytes = vocab_size <= 65536 ? 2 : 4;
+    header.token_count = 0;
+    header.vocab_size = vocab_size;
+    header.reserved = 0;
+    // Placeholder, rewritten with the final count by close()
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+ShardWriter::~ShardWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void ShardWriter::write(const std::uint32_t* ids, std::size_t n) {
+    if (!out.is_open()) throw std::runtime_error("Shard already closed: " + filename);
+    for (std::size_t i = 0; i < n; i++) {
+        if (ids[i] >= header.vocab_size) {
+            throw std::out_of_range("Token id " + std::to_string(ids[i]) + " is outside the shard vocab");
+        }
+    }
+    if (header.id_bytes == 2) {
+        narrow.assign(ids, ids + n);
+        out.write(reinterpret_cast<const char*>(narrow.data()), n * sizeof(std::uint16_t));
+    } else {
+        out.write(reinterpret_cast<const char*>(ids), n * sizeof(std::uint32_t));
+    }
+    count += n;
+}
+
+void ShardWriter::close() {
+    if (!out.is_open()) return;
+    header.token_count = count;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) throw std::runtime_error("Failed writing shard: " + filename);
+}
+
+// ---------------- READER ----------------
+TokenShard::TokenShard(const std::string& filename) : file(filename) {
+    if (file.size() < sizeof(ShardHeader)) {
+        throw std::runtime_error("Not a token shard: " + filename);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC)) != 0 || header.version != SHARD_VERSION ||
+        (header.id_bytes != 2 && header.id_bytes != 4)) {
+        throw std::runtime_error("Not a token shard: " + filename);
+    }
+    if (file.size() - sizeof(ShardHeader) != header.token_count * header.id_bytes) {
+        throw std::runtime_error("Truncated or corrupt token shard: " + filename);
+    }
+    ids = file.data() + sizeof(ShardHeader);
+}
+
+TokenWindow TokenShard::window(std::uint64_t start, std::size_t length) const {
+    if (start > size() || length > size() - start) {
+        throw std::out_of_range("Token window runs past the end of the shard");
+    }
+    return TokenWindow{ids + start * header.id_bytes, header.id_bytes, length};
+}
+
+// ---------------- DATASET ----------------
+TokenDataset::TokenDataset(const std::vector<std::string>& shard_files) {
+    if (shard_files.empty()) throw std::invalid_argument("TokenDataset needs at least one shard");
+    shards.reserve(shard_files.size());
+    for (const auto& name : shard_files) {
+        shards.emplace_back(name);
+        if (shards.back().vocab_size() != shards.front().vocab_size()) {
+            throw std::runtime_error("Shard " + name + " was written with a different vocab");
+        }
+        total_tokens += shards.back().size();
+    }
+}
+
+std::vector<TokenWindow> TokenDataset::sample_windows(int batch, int seq_len, const Philox& rng,
+                                                      std::uint64_t step) const {
+    if (batch <= 0 || seq_len <= 0) throw std::invalid_argument("batch and seq_len must be positive");
+    const std::size_t span = static_cast<std::size_t>(seq_len) + 1;
+
+    // Window starts per shard; a window never crosses a shard boundary
+    std::vector<std::uint64_t> first_window(shards.size() + 1, 0);
+    for (std::size_t s = 0; s < shards.size(); s++) {
+        std::uint64_t starts = shards[s].size() >= span ? shards[s].size() - span + 1 : 0;
+        first_window[s + 1] = first_window[s] + starts;
+    }
+    const std::uint64_t windows = first_window.back();
+    if (windows == 0) throw std::runtime_error("No shard holds " + std::to_string(span) + " tokens");
+
+    std::vector<TokenWindow> out;
+    out.reserve(batch);
+    std::uint32_t bits[4];
+    for (int b = 0; b < batch; b++) {
+        rng.block(step * static_cast<std::uint64_t>(batch) + b, bits);
+        std::uint64_t r = (static_cast<std::uint64_t>(bits[0]) << 32) | bits[1];
+        std::uint64_t w = r % windows;  // modulo bias is < windows / 2^64
+        std::size_t s = std::upper_bound(first_window.begin(), first_window.end(), w) - first_window.begin() - 1;
+        out.push_back(shards[s].window(w - first_window[s], span));
+    }
+    return out;
+}
+
+void TokenDataset::sample_batch(int batch, int seq_len, const Philox& rng, std::uint64_t step,
+                                TokenBatch& out) const {
+    std::vector<TokenWindow> windows = sample_windows(batch, seq_len, rng, step);
+    out.batch = batch;
+    out.seq_len = seq_len;
+    out.inputs.resize(static_cast<std::size_t>(batch) * seq_len);
+    out.targets.resize(static_cast<std::size_t>(batch) * seq_len);
+
+    for (int b = 0; b < batch; b++) {
+        const TokenWindow& w = windows[b];
+        std::uint32_t* in = out.inputs.data() + static_cast<std::size_t>(b) * seq_len;
+        std::uint32_t* target = out.targets.data() + static_cast<std::size_t>(b) * seq_len;
+        if (w.id_bytes == 2) {
+            const std::uint16_t* ids = static_cast<const std::uint16_t*>(w.data);
+            std::copy(ids, ids + seq_len, in);
+            std::copy(ids + 1, ids + seq_len + 1, target);
+        } else {
+            const std::uint32_t* ids = static_cast<const std::uint32_t*>(w.data);
+            std::copy(ids, ids + seq_len, in);
+            std::copy(ids + 1, ids + seq_len + 1, target);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef TOKEN_SHARD_HPP
+#define TOKEN_SHARD_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../math_primitives/random.hpp"
+#include "../utils/mapped_file.hpp"
+
+// Shard file layout (little-endian):
+//   32-byte header: "LLMTOKS\0", version, bytes per ID (2 or 4), token count,
+//                   vocab size, reserved
+//   token IDs packed as uint16 (vocab <= 65536) or uint32
+struct ShardHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t id_bytes;
+    std::uint64_t token_count;
+    std::uint32_t vocab_size;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(ShardHeader) == 32, "ShardHeader must stay 32 bytes");
+
+// Streams IDs into one shard file; the header is finalised on close()
+class ShardWriter {
+public:
+    ShardWriter(const std::string& filename, std::uint32_t vocab_size);
+    ~ShardWriter();
+
+    void write(const std::uint32_t* ids, std::size_t count);
+    void close();
+    std::uint64_t written() const { return count; }
+
+private:
+    std::ofstream out;
+    std::string filename;
+    ShardHeader header;
+    std::uint64_t count = 0;
+    std::vector<std::uint16_t> narrow;  // scratch for uint16 shards
+};
+
+// Contiguous run of IDs inside a mapped shard; no copy is made
+struct TokenWindow {
+    const void* data;
+    std::uint32_t id_bytes;
+    std::size_t length;
+
+    std::uint32_t operator[](std::size_t i) const {
+        return id_bytes == 2 ? static_cast<const std::uint16_t*>(data)[i]
+                             : static_cast<const std::uint32_t*>(data)[i];
+    }
+};
+
+// Read-only, memory-mapped shard
+class TokenShard {
+public:
+    explicit TokenShard(const std::string& filename);
+
+    std::uint64_t size() const { return header.token_count; }
+    std::uint32_t vocab_size() const { return header.vocab_size; }
+    std::uint32_t id_bytes() const { return header.id_bytes; }
+
+    TokenWindow window(std::uint64_t start, std::size_t length) const;
+
+private:
+    MappedFile file;
+    ShardHeader header;
+    const char* ids;
+};
+
+// Next-token-prediction batch: inputs[b] = window[0, seq_len),
+// targets[b] = window[1, seq_len + 1), row-major [batch x seq_len]
+struct TokenBatch {
+    int batch = 0;
+    int seq_len = 0;
+    std::vector<std::uint32_t> inputs;
+    std::vector<std::uint32_t> targets;
+};
+
+// Samples random windows of seq_len + 1 tokens across a set of shards, each
+// shard weighted by how many windows it holds. Draws come from Philox keyed
+// by (step, row), so a given step always produces the same batch.
+class TokenDataset {
+public:
+    explicit TokenDataset(const std::vector<std::string>& shard_files);
+
+    std::uint64_t tokens() const { return total_tokens; }
+    std::uint32_t vocab_size() const { return shards.empty() ? 0 : shards[0].vocab_size(); }
+
+    // Views of `batch` random windows of length seq_len + 1
+    std::vector<TokenWindow> sample_windows(int batch, int seq_len, const Philox& rng, std::uint64_t step) const;
+
+    // Same windows, shifted into inputs/targets (reuses out's buffers)
+    void sample_batch(int batch, int seq_len, const Philox& rng, std::uint64_t step, TokenBatch& out) const;
+
+private:
+    std::vector<TokenShard> shards;
+    std::uint64_t total_tokens = 0;
+};
+
+#endif // TOKEN_SHARD_HPP
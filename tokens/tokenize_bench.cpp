@@ -0,0 +1,44 @@
+#include "tokenizer.hpp"
+#include "parallel_tokenizer.hpp"
+#include <chrono>
+#include <iostream>
+
+// Serial vs sharded tokenization of one file. Checks that every thread count
+// yields exactly the serial IDs and vocab, and prints speedup and MB/s.
+//
+// usage: tokenize_bench [corpus] [max_threads]
+
+int main(int argc, char** argv) {
+    std::string corpus = argc > 1 ? argv[1] : "test.txt";
+    std::size_t max_threads = argc > 2 ? std::stoul(argv[2]) : 16;
+    double megabytes = MappedFile(corpus).size() / 1e6;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    Vocab serial_vocab;
+    std::vector<std::uint32_t> serial = tokenizeFileToIds(corpus, serial_vocab);
+    auto end = std::chrono::high_resolution_clock::now();
+    double serial_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << corpus << ": " << megabytes << " MB, " << serial.size() << " tokens, "
+              << serial_vocab.size() << " distinct" << std::endl;
+    std::cout << "serial      : " << serial_ms << " ms (" << megabytes / serial_ms * 1e3 << " MB/s)" << std::endl;
+
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        ThreadPool pool(threads);
+        Vocab vocab;
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<std::uint32_t> ids = tokenizeFileParallel(corpus, vocab, pool);
+        end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+        bool same = ids == serial && vocab.size() == serial_vocab.size();
+        for (std::uint32_t id = 0; same && id < vocab.size(); id++)
+            same = vocab.token(id) == serial_vocab.token(id);
+
+        std::cout << threads << " thread(s): " << ms << " ms (" << megabytes / ms * 1e3 << " MB/s)"
+                  << " | speedup " << serial_ms / ms
+                  << " | " << (same ? "identical" : "MISMATCH") << std::endl;
+        if (!same) return 1;
+    }
+    return 0;
+}
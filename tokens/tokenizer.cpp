@@ -7,33 +7,22 @@
 #include <iterator>
 #include <algorithm>
 MyList<MyList<char>> tokenizeFile(const std::string& filename) {
-		std::ifstream in(filename, std::ios::binary);
-		if (!in) {
-				throw std::runtime_error("Could not open file " + filename);
-		}
-		std::istreambuf_iterator<char> it (in);
-		std::istreambuf_iterator<char> end;
-		MyList<char> word;
 		MyList<MyList<char>> tokens;
-		for (; it != end; it++) {
-				char c = *it;
-				if (c == '.' || c == ' ' || c == '\n' || c == '?' || c == '!' || c == ';' || c == ':' || c == ',') {
-						if (word.size() > 0) {
-								tokens.push(word);
-								word = MyList<char>();
-						}
-						
-				}
-				if (c != ' ' && c != '\n') {
+		for_each_token_in_file(filename, [&](std::string_view token) {
+				MyList<char> word;
+				word.reserve(static_cast<int>(token.size()));
+				for (char c : token) {
 						word.push(c);
 				}
-				
-
-			  
-				
-		}
-		if (word.size() > 0) {
 				tokens.push(word);
-		}
+		});
 		return tokens;
 }
+
+std::vector<std::uint32_t> tokenizeFileToIds(const std::string& filename, Vocab& vocab) {
+		std::vector<std::uint32_t> ids;
+		for_each_token_in_file(filename, [&](std::string_view token) {
+				ids.push_back(vocab.intern(token));
+		});
+		return ids;
+}
@@ -6,9 +6,113 @@
 #include <iterator>
 #include <iostream>
 #include <iomanip>
+#include <cstdint>
+#include <string_view>
+#include <vector>
 #include "../math_primitives/vector.hpp"  // Or better: a vector.hpp
+#include "vocab.hpp"
+#include "../utils/mapped_file.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Whitespace ends a token and is dropped; punctuation ends a token and
+// starts the next one.
+inline bool is_token_space(char c) {
+		return c == ' ' || c == '\n';
+}
+
+inline bool is_token_delimiter(char c) {
+		return c == '.' || c == ' ' || c == '\n' || c == '?' || c == '!' || c == ';' || c == ':' || c == ',';
+}
+
+// First delimiter in [p, end), or end. With SSE2 this tests 16 bytes per
+// step: one compare per delimiter byte, OR-ed into a single class mask.
+inline const char* find_token_delimiter(const char* p, const char* end) {
+#ifdef __SSE2__
+		const __m128i dot = _mm_set1_epi8('.');
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i newline = _mm_set1_epi8('\n');
+		const __m128i question = _mm_set1_epi8('?');
+		const __m128i bang = _mm_set1_epi8('!');
+		const __m128i semicolon = _mm_set1_epi8(';');
+		const __m128i colon = _mm_set1_epi8(':');
+		const __m128i comma = _mm_set1_epi8(',');
+		while (end - p >= 16) {
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				__m128i hit = _mm_or_si128(
+						_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, dot), _mm_cmpeq_epi8(v, space)),
+												 _mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, question))),
+						_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, bang), _mm_cmpeq_epi8(v, semicolon)),
+												 _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma))));
+				int mask = _mm_movemask_epi8(hit);
+				if (mask != 0) {
+						return p + __builtin_ctz(mask);
+				}
+				p += 16;
+		}
+#endif
+		while (p < end && !is_token_delimiter(*p)) {
+				p++;
+		}
+		return p;
+}
+
+// Calls emit(std::string_view) for every token in text, in order, using the
+// same splitting rules as tokenizeFile. The views point into text.
+template <typename F>
+void for_each_token(std::string_view text, F&& emit) {
+		const char* p = text.data();
+		const char* end = p + text.size();
+		const char* start = p;
+		while (true) {
+				const char* d = find_token_delimiter(p, end);
+				if (d == end) {
+						break;
+				}
+				if (d > start) {
+						emit(std::string_view(start, d - start));
+				}
+				start = is_token_space(*d) ? d + 1 : d;
+				p = d + 1;
+		}
+		if (end > start) {
+				emit(std::string_view(start, end - start));
+		}
+}
+
+// Start of the chunk following [.., limit): the first delimiter at or after
+// limit. Tokenizing [begin, cut) and [cut, ..) separately gives the same
+// tokens as one pass, because a token never spans a delimiter.
+inline std::size_t token_boundary_at_or_after(std::string_view text, std::size_t limit) {
+		if (limit >= text.size()) {
+				return text.size();
+		}
+		return find_token_delimiter(text.data() + limit, text.data() + text.size()) - text.data();
+}
+
+// Streams every token of a file through emit(std::string_view) without
+// copying. The file is memory-mapped and scanned chunk_bytes at a time; pages
+// of each finished chunk are released, so resident memory stays around one
+// chunk whatever the corpus size. Views are only valid during the emit call.
+template <typename F>
+void for_each_token_in_file(const std::string& filename, F&& emit, std::size_t chunk_bytes = 64 << 20) {
+		MappedFile file(filename);
+		std::string_view text = file.view();
+		std::size_t begin = 0;
+		while (begin < text.size()) {
+				std::size_t cut = token_boundary_at_or_after(text, begin + chunk_bytes);
+				for_each_token(text.substr(begin, cut - begin), emit);
+				file.release(begin, cut - begin);
+				begin = cut;
+		}
+}
 
 // A function that reads a file and returns tokens
+// (prefer for_each_token_in_file or tokenizeFileToIds: this allocates per token)
 MyList<MyList<char>> tokenizeFile(const std::string& filename);
 
+// Streams a file and returns one ID per token, interning new tokens into vocab
+std::vector<std::uint32_t> tokenizeFileToIds(const std::string& filename, Vocab& vocab);
+
 #endif // TOKENIZER_HPP
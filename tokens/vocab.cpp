@@ -0,0 +1,114 @@
+#include "vocab.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr char VOCAB_MAGIC[4] = {'V', 'O', 'C', 'B'};
+constexpr std::uint32_t VOCAB_VERSION = 1;
+
+} // namespace
+
+Vocab::Vocab()
+    : pool(new Pool()),
+      index(0, PoolHash{pool.get()}, PoolEqual{pool.get()}) {
+    pool->offsets.push_back(0);
+}
+
+Vocab::Vocab(Vocab&& other) : Vocab() { swap(other); }
+
+Vocab& Vocab::operator=(Vocab&& other) {
+    Vocab taken(std::move(other));
+    swap(taken);
+    return *this;
+}
+
+// The index functors point at their own pool, so pool and index travel together
+void Vocab::swap(Vocab& other) {
+    std::swap(pool, other.pool);
+    std::swap(index, other.index);
+}
+
+std::uint32_t Vocab::intern(std::string_view token) {
+    auto it = index.find(token);
+    if (it != index.end()) return it->first;
+
+    if (size() >= UNKNOWN) {
+        throw std::length_error("Vocab is full");
+    }
+    std::uint32_t id = static_cast<std::uint32_t>(size());
+    pool->bytes.append(token.data(), token.size());
+    pool->offsets.push_back(static_cast<std::uint32_t>(pool->bytes.size()));
+    index.try_emplace(id);
+    return id;
+}
+
+std::uint32_t Vocab::find(std::string_view token) const {
+    auto it = index.find(token);
+    return it == index.end() ? UNKNOWN : it->first;
+}
+
+std::string_view Vocab::token(std::uint32_t id) const {
+    if (id >= size()) {
+        throw std::out_of_range("Token id " + std::to_string(id) + " is not in the vocab");
+    }
+    return pool->get(id);
+}
+
+void Vocab::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot open file for writing: " + filename);
+
+    std::uint32_t count = static_cast<std::uint32_t>(size());
+    std::uint32_t bytes = static_cast<std::uint32_t>(pool->bytes.size());
+
+    out.write(VOCAB_MAGIC, sizeof(VOCAB_MAGIC));
+    out.write(reinterpret_cast<const char*>(&VOCAB_VERSION), sizeof(VOCAB_VERSION));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+    out.write(reinterpret_cast<const char*>(pool->offsets.data()), pool->offsets.size() * sizeof(std::uint32_t));
+    out.write(pool->bytes.data(), bytes);
+
+    if (!out) throw std::runtime_error("Failed writing vocab: " + filename);
+}
+
+Vocab Vocab::load(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open file for reading: " + filename);
+
+    char magic[4];
+    std::uint32_t version, count, bytes;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    in.read(reinterpret_cast<char*>(&bytes), sizeof(bytes));
+    if (!in || std::string(magic, 4) != std::string(VOCAB_MAGIC, 4) || version != VOCAB_VERSION) {
+        throw std::runtime_error("Not a vocab file: " + filename);
+    }
+
+    Vocab vocab;
+    Pool& pool = *vocab.pool;
+    pool.offsets.resize(static_cast<std::size_t>(count) + 1);
+    pool.bytes.resize(bytes);
+    in.read(reinterpret_cast<char*>(pool.offsets.data()), pool.offsets.size() * sizeof(std::uint32_t));
+    in.read(&pool.bytes[0], bytes);
+    if (!in || pool.offsets[0] != 0 || pool.offsets[count] != bytes) {
+        throw std::runtime_error("Truncated or corrupt vocab file: " + filename);
+    }
+
+    for (std::uint32_t id = 0; id < count; id++) {
+        if (pool.offsets[id] > pool.offsets[id + 1]) {
+            throw std::runtime_error("Corrupt vocab offsets in " + filename);
+        }
+    }
+
+    vocab.index.reserve(count);
+    for (std::uint32_t id = 0; id < count; id++) {
+        if (vocab.index.contains(pool.get(id))) {
+            throw std::runtime_error("Duplicate token in vocab file: " + filename);
+        }
+        vocab.index.try_emplace(id);
+    }
+    return vocab;
+}
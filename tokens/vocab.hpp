@@ -0,0 +1,70 @@
+#ifndef VOCAB_HPP
+#define VOCAB_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../math_primitives/hashmap.hpp"
+
+// Interns token strings into integer IDs. IDs are dense and assigned in order
+// of first appearance. All token text lives back to back in one pool; the
+// hash index only stores 4-byte IDs and hashes/compares through the pool.
+class Vocab {
+public:
+    static constexpr std::uint32_t UNKNOWN = 0xFFFFFFFFu;
+
+    Vocab();
+    // A moved-from Vocab is left empty, as if default-constructed
+    Vocab(Vocab&& other);
+    Vocab& operator=(Vocab&& other);
+    Vocab(const Vocab&) = delete;
+    Vocab& operator=(const Vocab&) = delete;
+
+    // ID of `token`, adding it if it has not been seen before
+    std::uint32_t intern(std::string_view token);
+
+    // ID of `token`, or UNKNOWN
+    std::uint32_t find(std::string_view token) const;
+
+    std::string_view token(std::uint32_t id) const;
+    std::size_t size() const { return pool->offsets.size() - 1; }
+    std::size_t pool_bytes() const { return pool->bytes.size(); }
+
+    // Binary format: "VOCB", version, count, pool size, offsets, pool bytes
+    void save(const std::string& filename) const;
+    static Vocab load(const std::string& filename);
+
+private:
+    // Heap-allocated so the index functors' pointer survives moves
+    struct Pool {
+        std::string bytes;
+        std::vector<std::uint32_t> offsets;  // token i is bytes[offsets[i], offsets[i + 1])
+
+        std::string_view get(std::uint32_t id) const {
+            return std::string_view(bytes.data() + offsets[id], offsets[id + 1] - offsets[id]);
+        }
+    };
+
+    struct PoolHash {
+        const Pool* pool;
+        std::uint64_t operator()(std::string_view s) const { return hash_bytes(s.data(), s.size()); }
+        std::uint64_t operator()(std::uint32_t id) const { return (*this)(pool->get(id)); }
+    };
+
+    struct PoolEqual {
+        const Pool* pool;
+        bool operator()(std::uint32_t a, std::uint32_t b) const { return a == b; }
+        bool operator()(std::uint32_t id, std::string_view s) const { return pool->get(id) == s; }
+    };
+
+    struct NoValue {};
+
+    void swap(Vocab& other);
+
+    std::unique_ptr<Pool> pool;
+    FlatHashMap<std::uint32_t, NoValue, PoolHash, PoolEqual> index;
+};
+
+#endif // VOCAB_HPP
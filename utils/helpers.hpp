@@ -0,0 +1,31 @@
+#ifndef HELPERS_HPP
+#define HELPERS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include "../math_primitives/vector.hpp"
+
+// Small helpers shared by timers, error messages and the benches
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// "rows x cols" for error messages
+inline std::string shape_of(const matrix& m) {
+    return std::to_string(m.size()) + "x" + std::to_string(m.size() ? m[0].size() : 0);
+}
+
+// Largest elementwise |a - b|; b must be at least a's shape
+inline float max_diff(const matrix& a, const matrix& b) {
+    float diff = 0.0f;
+    for (int i = 0; i < a.size(); i++)
+        for (int j = 0; j < a[i].size(); j++) diff = std::max(diff, std::fabs(a[i][j] - b[i][j]));
+    return diff;
+}
+
+#endif // HELPERS_HPP
@@ -0,0 +1,92 @@
+#include "images.hpp"
+#include "png.hpp"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool is_png(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".png";
+}
+
+bool all_digits(const std::string& s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+} // namespace
+
+matrix load_ascii_image(const std::string& filepath) {
+    if (is_png(filepath)) {
+        PngImage png = load_png(filepath);
+        matrix image(png.height, png.width);
+        std::vector<float> gray(static_cast<std::size_t>(png.width) * png.height);
+        png_to_gray(png, gray.data());
+        for (int y = 0; y < png.height; y++)
+            for (int x = 0; x < png.width; x++) image[y][x] = gray[static_cast<std::size_t>(y) * png.width + x];
+        return image;
+    }
+
+    std::ifstream in(filepath);
+    if (!in) throw std::runtime_error("Cannot open image file: " + filepath);
+    matrix image;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream values(line);
+        mathVector row;
+        float v;
+        while (values >> v) row.push(v / 255.0f);
+        if (!values.eof()) throw std::runtime_error("Non-numeric pixel in " + filepath);
+        if (row.size() > 0) image.push(row);  // push() rejects ragged rows
+    }
+    return image;
+}
+
+int extract_label(const std::string& filename) {
+    fs::path path(filename);
+    std::string parent = path.parent_path().filename().string();
+    if (all_digits(parent)) return std::stoi(parent);
+
+    std::string stem = path.stem().string();
+    auto last = std::find_if(stem.rbegin(), stem.rend(), [](unsigned char c) { return std::isdigit(c); });
+    if (last == stem.rend()) throw std::runtime_error("No label in image path: " + filename);
+    auto first = std::find_if(last, stem.rend(), [](unsigned char c) { return !std::isdigit(c); });
+    return std::stoi(std::string(first.base(), last.base()));
+}
+
+ImageFolder load_image_folder(const std::string& directory, ThreadPool& pool) {
+    ImageFolder folder;
+    for (const auto& entry : fs::recursive_directory_iterator(directory)) {
+        if (entry.is_regular_file() && is_png(entry.path())) folder.files.push_back(entry.path().string());
+    }
+    std::sort(folder.files.begin(), folder.files.end());
+    if (folder.files.empty()) return folder;
+
+    // The first image fixes the size every other one must match
+    PngImage first = load_png(folder.files[0]);
+    folder.count = static_cast<int>(folder.files.size());
+    folder.rows = first.height;
+    folder.cols = first.width;
+    const std::size_t features = static_cast<std::size_t>(folder.rows) * folder.cols;
+    folder.pixels.resize(folder.count * features);
+    folder.labels.resize(folder.count);
+
+    pool.parallel_for(0, folder.files.size(), [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; i++) {
+            PngImage png = i == 0 ? std::move(first) : load_png(folder.files[i]);
+            if (png.width != folder.cols || png.height != folder.rows) {
+                throw std::runtime_error(folder.files[i] + " is " + std::to_string(png.width) + "x" +
+                                         std::to_string(png.height) + ", expected " + std::to_string(folder.cols) +
+                                         "x" + std::to_string(folder.rows));
+            }
+            png_to_gray(png, folder.pixels.data() + i * features);
+            folder.labels[i] = extract_label(folder.files[i]);
+        }
+    }, 16);
+    return folder;
+}
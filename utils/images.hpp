@@ -5,9 +5,31 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include "../phase_1/vector.hpp"
-#include "autograd.hpp"
+#include "../math_primitives/vector.hpp"
+#include "../autograd_mechanisms/autograd.hpp"
+#include "thread_pool.hpp"
 
+// Grayscale image in [0, 1] as a height x width matrix. PNGs are decoded;
+// anything else is read as text, one row per line of whitespace-separated
+// 0-255 values.
 matrix load_ascii_image(const std::string& filepath);
+
+// Class label for an image file: the parent directory name when it is a
+// number (digits/7/00042.png), otherwise the last run of digits in the file
+// name (00042_7.png). Throws if neither exists.
 int extract_label(const std::string& filename);
+
+// Every PNG under a directory, decoded on the pool into one contiguous
+// [count x rows*cols] grayscale buffer. Files are sorted by path so the
+// order is stable; all images must share one size.
+struct ImageFolder {
+    int count = 0;
+    int rows = 0;
+    int cols = 0;
+    std::vector<float> pixels;
+    std::vector<int> labels;
+    std::vector<std::string> files;
+};
+
+ImageFolder load_image_folder(const std::string& directory, ThreadPool& pool = default_thread_pool());
 #endif
@@ -0,0 +1,63 @@
+#include "mapped_file.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file " + filename + ": " + std::strerror(errno));
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Could not stat file " + filename + ": " + std::strerror(err));
+    }
+    length = static_cast<std::size_t>(st.st_size);
+
+    // mmap rejects zero-length mappings; an empty file is just an empty view
+    if (length > 0) {
+        addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            int err = errno;
+            addr = nullptr;
+            ::close(fd);
+            throw std::runtime_error("Could not map file " + filename + ": " + std::strerror(err));
+        }
+        ::madvise(addr, length, MADV_SEQUENTIAL);
+    }
+    ::close(fd);  // the mapping keeps the file alive
+}
+
+MappedFile::~MappedFile() {
+    if (addr) ::munmap(addr, length);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : addr(std::exchange(other.addr, nullptr)), length(std::exchange(other.length, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        if (addr) ::munmap(addr, length);
+        addr = std::exchange(other.addr, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+void MappedFile::release(std::size_t offset, std::size_t bytes) const {
+    if (!addr || bytes == 0) return;
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t first = (offset + page - 1) / page * page;
+    std::size_t last = (offset + bytes) / page * page;
+    if (last > first) {
+        ::madvise(static_cast<char*>(addr) + first, last - first, MADV_DONTNEED);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first
+// touch and belong to the page cache, so mapping a multi-GB file costs
+// address space, not RAM; release() drops pages that are no longer needed.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return static_cast<const char*>(addr); }
+    std::size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(data(), length); }
+
+    // Hint that [offset, offset + bytes) is done with; whole pages inside the
+    // range are dropped from this process' resident set.
+    void release(std::size_t offset, std::size_t bytes) const;
+
+private:
+    void* addr = nullptr;
+    std::size_t length = 0;
+};
+
+#endif
@@ -1,25 +1,258 @@
-#include <sstream>
-#include <iostream>
-#include <fstream>
-#include <iomanip>
-#include <iterator>
+#include "png.hpp"
+#include "mapped_file.hpp"
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
 
 #include <zlib.h>
 
-int main () {
-		// Creates a file buffer
-		std::ifstream in("image.png", std::ios::binary);
+namespace {
 
-		
-		std::istreambuf_iterator<char> end;
+constexpr std::uint8_t PNG_SIGNATURE[8] = {137, 80, 78, 71, 13, 10, 26, 10};
 
-		// Outputs each byte and increments the iterator by 1 until the iterator is an end-of-stream iterator
-		for (; it != end; ++it) {
-				
-				std::cout << std::setw(2) << (static_cast<unsigned>(*it) & 0xFF) << " ";
+// Largest filtered or decoded image accepted. Keeps zlib's 32-bit
+// avail_out exact and stops a forged header from allocating without limit.
+constexpr std::size_t MAX_IMAGE_BYTES = std::size_t{1} << 30;
 
-				
-		}
-		return 0;
+std::uint32_t read_be32(const std::uint8_t* p) {
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+           (static_cast<std::uint32_t>(p[2]) << 8) | p[3];
+}
+
+bool chunk_is(const std::uint8_t* type, const char* name) { return std::memcmp(type, name, 4) == 0; }
+
+struct Header {
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    int depth = 0;
+    int color = 0;
+    int samples = 0;  // samples per pixel as stored
+};
+
+int samples_for(int color) {
+    switch (color) {
+        case 0: return 1;  // gray
+        case 2: return 3;  // RGB
+        case 3: return 1;  // palette index
+        case 4: return 2;  // gray + alpha
+        case 6: return 4;  // RGBA
+        default: throw std::runtime_error("PNG: unknown colour type " + std::to_string(color));
+    }
+}
+
+bool valid_depth(int color, int depth) {
+    switch (color) {
+        case 0: return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+        case 3: return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+        default: return depth == 8 || depth == 16;
+    }
+}
+
+inline std::uint8_t paeth(std::uint8_t a, std::uint8_t b, std::uint8_t c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+// Undoes the per-row filters in place. `raw` holds height rows of
+// 1 filter byte + stride bytes; bpp is the byte distance to the pixel on
+// the left (at least 1).
+void unfilter(std::uint8_t* raw, std::size_t stride, std::uint32_t height, std::size_t bpp) {
+    std::vector<std::uint8_t> zero(stride, 0);
+    const std::uint8_t* prior = zero.data();
+    for (std::uint32_t y = 0; y < height; y++) {
+        std::uint8_t* row = raw + static_cast<std::size_t>(y) * (stride + 1);
+        std::uint8_t filter = row[0];
+        std::uint8_t* cur = row + 1;
+        switch (filter) {
+            case 0:  // None
+                break;
+            case 1:  // Sub
+                for (std::size_t i = bpp; i < stride; i++) cur[i] += cur[i - bpp];
+                break;
+            case 2:  // Up
+                for (std::size_t i = 0; i < stride; i++) cur[i] += prior[i];
+                break;
+            case 3:  // Average
+                for (std::size_t i = 0; i < bpp && i < stride; i++) cur[i] += prior[i] >> 1;
+                for (std::size_t i = bpp; i < stride; i++) cur[i] += (cur[i - bpp] + prior[i]) >> 1;
+                break;
+            case 4:  // Paeth
+                for (std::size_t i = 0; i < bpp && i < stride; i++) cur[i] += prior[i];
+                for (std::size_t i = bpp; i < stride; i++) cur[i] += paeth(cur[i - bpp], prior[i], prior[i - bpp]);
+                break;
+            default:
+                throw std::runtime_error("PNG: bad filter type " + std::to_string(filter));
+        }
+        prior = cur;
+    }
+}
+
+} // namespace
+
+PngImage decode_png(const std::uint8_t* data, std::size_t size) {
+    if (size < 8 || std::memcmp(data, PNG_SIGNATURE, 8) != 0) throw std::runtime_error("Not a PNG file");
+
+    Header h;
+    std::vector<std::uint8_t> palette;       // RGB triples
+    std::vector<std::uint8_t> palette_alpha;  // from tRNS
+    std::vector<std::uint8_t> raw;
+    std::size_t stride = 0;
+    bool seen_header = false, seen_end = false, inflated = false;
+
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK) throw std::runtime_error("PNG: inflateInit failed");
+    struct ZGuard {
+        z_stream* zs;
+        ~ZGuard() { inflateEnd(zs); }
+    } guard{&zs};
+
+    std::size_t pos = 8;
+    while (!seen_end) {
+        if (size - pos < 12) {
+            // Image data complete but IEND missing or cut short: decoders
+            // accept this, and so does the repo's own sample image
+            if (inflated) break;
+            throw std::runtime_error("PNG: truncated chunk");
+        }
+        std::uint32_t length = read_be32(data + pos);
+        const std::uint8_t* type = data + pos + 4;
+        const std::uint8_t* body = data + pos + 8;
+        if (length > size - pos - 12) throw std::runtime_error("PNG: chunk runs past end of file");
+        std::uint32_t crc = read_be32(body + length);
+        if (crc32(crc32(0L, Z_NULL, 0), type, length + 4) != crc) {
+            throw std::runtime_error("PNG: CRC mismatch in " + std::string(reinterpret_cast<const char*>(type), 4));
+        }
+
+        if (chunk_is(type, "IHDR")) {
+            if (length != 13 || seen_header) throw std::runtime_error("PNG: bad IHDR");
+            h.width = read_be32(body);
+            h.height = read_be32(body + 4);
+            h.depth = body[8];
+            h.color = body[9];
+            if (body[10] != 0 || body[11] != 0) throw std::runtime_error("PNG: unknown compression or filter method");
+            if (body[12] != 0) throw std::runtime_error("PNG: interlaced images are not supported");
+            h.samples = samples_for(h.color);
+            if (!valid_depth(h.color, h.depth)) {
+                throw std::runtime_error("PNG: bit depth " + std::to_string(h.depth) + " invalid for colour type " +
+                                         std::to_string(h.color));
+            }
+            if (h.width == 0 || h.height == 0 || h.width > (1u << 24) || h.height > (1u << 24)) {
+                throw std::runtime_error("PNG: bad dimensions");
+            }
+            stride = (static_cast<std::size_t>(h.width) * h.samples * h.depth + 7) / 8;
+            // Decoded pixels are at most 4 bytes each (RGBA, or palette RGBA)
+            if ((stride + 1) * h.height > MAX_IMAGE_BYTES ||
+                static_cast<std::size_t>(h.width) * h.height * 4 > MAX_IMAGE_BYTES) {
+                throw std::runtime_error("PNG: image larger than " + std::to_string(MAX_IMAGE_BYTES >> 20) + " MiB");
+            }
+            raw.resize((stride + 1) * h.height);
+            zs.next_out = raw.data();
+            zs.avail_out = static_cast<uInt>(raw.size());
+            seen_header = true;
+        } else if (!seen_header) {
+            throw std::runtime_error("PNG: first chunk is not IHDR");
+        } else if (chunk_is(type, "PLTE")) {
+            if (length % 3 != 0 || length > 256 * 3) throw std::runtime_error("PNG: bad palette");
+            palette.assign(body, body + length);
+        } else if (chunk_is(type, "tRNS")) {
+            if (h.color == 3) palette_alpha.assign(body, body + length);
+        } else if (chunk_is(type, "IDAT")) {
+            // Inflate each IDAT as it comes; no concatenation copy
+            if (inflated) {
+                if (length > 0) throw std::runtime_error("PNG: data after end of image stream");
+            } else {
+                zs.next_in = const_cast<Bytef*>(body);
+                zs.avail_in = length;
+                while (zs.avail_in > 0 && !inflated) {
+                    int rc = inflate(&zs, Z_NO_FLUSH);
+                    if (rc == Z_STREAM_END) inflated = true;
+                    else if (rc == Z_BUF_ERROR) throw std::runtime_error("PNG: image data larger than the header says");
+                    else if (rc != Z_OK) throw std::runtime_error("PNG: corrupt image data");
+                }
+            }
+        } else if (chunk_is(type, "IEND")) {
+            seen_end = true;
+        } else if (!(type[0] & 0x20)) {
+            throw std::runtime_error("PNG: unknown critical chunk " + std::string(reinterpret_cast<const char*>(type), 4));
+        }
+        pos += 12 + length;
+    }
+    if (!inflated || zs.total_out != raw.size()) throw std::runtime_error("PNG: image data is incomplete");
+    if (h.color == 3 && palette.empty()) throw std::runtime_error("PNG: palette image without PLTE");
+
+    const std::size_t bpp = std::max<std::size_t>(1, static_cast<std::size_t>(h.samples) * h.depth / 8);
+    unfilter(raw.data(), stride, h.height, bpp);
+
+    PngImage image;
+    image.width = static_cast<int>(h.width);
+    image.height = static_cast<int>(h.height);
+    image.channels = h.color == 3 ? (palette_alpha.empty() ? 3 : 4) : h.samples;
+    image.pixels.resize(static_cast<std::size_t>(h.width) * h.height * image.channels);
+
+    const std::size_t row_samples = static_cast<std::size_t>(h.width) * h.samples;
+    const int palette_size = static_cast<int>(palette.size() / 3);
+    for (std::uint32_t y = 0; y < h.height; y++) {
+        const std::uint8_t* src = raw.data() + static_cast<std::size_t>(y) * (stride + 1) + 1;
+        std::uint8_t* dst = image.pixels.data() + static_cast<std::size_t>(y) * h.width * image.channels;
+
+        if (h.color != 3) {
+            if (h.depth == 8) {
+                std::memcpy(dst, src, row_samples);
+            } else if (h.depth == 16) {
+                for (std::size_t i = 0; i < row_samples; i++) dst[i] = src[2 * i];
+            } else {
+                // Sub-byte gray, most significant bits first
+                const int per_byte = 8 / h.depth;
+                const int max = (1 << h.depth) - 1;
+                for (std::size_t i = 0; i < row_samples; i++) {
+                    int shift = 8 - h.depth * (1 + static_cast<int>(i % per_byte));
+                    int v = (src[i / per_byte] >> shift) & max;
+                    dst[i] = static_cast<std::uint8_t>(v * 255 / max);
+                }
+            }
+            continue;
+        }
+
+        const int per_byte = 8 / h.depth;
+        const int mask = (1 << h.depth) - 1;
+        for (std::uint32_t x = 0; x < h.width; x++) {
+            int index = h.depth == 8 ? src[x]
+                                     : (src[x / per_byte] >> (8 - h.depth * (1 + static_cast<int>(x % per_byte)))) & mask;
+            if (index >= palette_size) throw std::runtime_error("PNG: palette index out of range");
+            std::uint8_t* px = dst + x * image.channels;
+            px[0] = palette[3 * index];
+            px[1] = palette[3 * index + 1];
+            px[2] = palette[3 * index + 2];
+            if (image.channels == 4) {
+                px[3] = index < static_cast<int>(palette_alpha.size()) ? palette_alpha[index] : 255;
+            }
+        }
+    }
+    return image;
+}
+
+PngImage load_png(const std::string& filename) {
+    MappedFile file(filename);
+    try {
+        return decode_png(reinterpret_cast<const std::uint8_t*>(file.data()), file.size());
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(filename + ": " + e.what());
+    }
+}
+
+void png_to_gray(const PngImage& image, float* out) {
+    const std::size_t n = static_cast<std::size_t>(image.width) * image.height;
+    const std::uint8_t* p = image.pixels.data();
+    const float scale = 1.0f / 255.0f;
+    if (image.channels <= 2) {
+        for (std::size_t i = 0; i < n; i++) out[i] = p[i * image.channels] * scale;
+    } else {
+        for (std::size_t i = 0; i < n; i++, p += image.channels) {
+            out[i] = (0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2]) * scale;
+        }
+    }
 }
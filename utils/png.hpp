@@ -0,0 +1,30 @@
+#ifndef PNG_HPP
+#define PNG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Decoded PNG as 8-bit samples, rows top to bottom, channels interleaved
+// (1 = gray, 2 = gray + alpha, 3 = RGB, 4 = RGBA). Palette images are
+// expanded to RGB(A), 16-bit samples keep their high byte and 1/2/4-bit
+// gray is scaled up to 0-255.
+struct PngImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<std::uint8_t> pixels;
+};
+
+// Non-interlaced PNGs of any colour type and bit depth. Chunk CRCs are
+// checked; malformed input, or an image over 1 GiB filtered or decoded,
+// throws std::runtime_error.
+PngImage decode_png(const std::uint8_t* data, std::size_t size);
+PngImage load_png(const std::string& filename);
+
+// Grayscale floats in [0, 1], width * height values: gray is scaled, RGB is
+// converted with Rec. 601 luma weights, alpha is ignored
+void png_to_gray(const PngImage& image, float* out);
+
+#endif // PNG_HPP
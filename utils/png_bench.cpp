@@ -0,0 +1,139 @@
+#include "images.hpp"
+#include "png.hpp"
+#include <chrono>
+#include <iostream>
+#include <zlib.h>
+
+// PNG decode throughput in images/sec, serial and through the parallel
+// folder loader. Without a directory argument it writes a synthetic set of
+// 28x28 digits (one subdirectory per label) using every filter type and
+// several colour types, checks that decoding round-trips, and removes it.
+//
+// usage: png_bench [directory] [threads]
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void put_be32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    for (int s = 24; s >= 0; s -= 8) out.push_back(static_cast<std::uint8_t>(v >> s));
+}
+
+void put_chunk(std::vector<std::uint8_t>& out, const char* type, const std::vector<std::uint8_t>& body) {
+    put_be32(out, static_cast<std::uint32_t>(body.size()));
+    std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), body.begin(), body.end());
+    put_be32(out, crc32(0L, out.data() + start, static_cast<uInt>(out.size() - start)));
+}
+
+std::uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return static_cast<std::uint8_t>(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+}
+
+// Minimal 8-bit encoder; row y uses filter y % 5 so all five are exercised
+std::vector<std::uint8_t> encode_png(const std::vector<std::uint8_t>& pixels, int width, int height, int color,
+                                     int channels) {
+    const std::size_t stride = static_cast<std::size_t>(width) * channels;
+    std::vector<std::uint8_t> filtered;
+    std::vector<std::uint8_t> zero(stride, 0);
+    for (int y = 0; y < height; y++) {
+        const std::uint8_t* cur = pixels.data() + y * stride;
+        const std::uint8_t* prior = y == 0 ? zero.data() : cur - stride;
+        int filter = y % 5;
+        filtered.push_back(static_cast<std::uint8_t>(filter));
+        for (std::size_t i = 0; i < stride; i++) {
+            int a = i >= static_cast<std::size_t>(channels) ? cur[i - channels] : 0;
+            int b = prior[i];
+            int c = i >= static_cast<std::size_t>(channels) ? prior[i - channels] : 0;
+            int predictor = filter == 0 ? 0 : filter == 1 ? a : filter == 2 ? b : filter == 3 ? (a + b) / 2 : paeth(a, b, c);
+            filtered.push_back(static_cast<std::uint8_t>(cur[i] - predictor));
+        }
+    }
+
+    uLongf bound = compressBound(static_cast<uLong>(filtered.size()));
+    std::vector<std::uint8_t> idat(bound);
+    compress(idat.data(), &bound, filtered.data(), static_cast<uLong>(filtered.size()));
+    idat.resize(bound);
+
+    std::vector<std::uint8_t> png = {137, 80, 78, 71, 13, 10, 26, 10};
+    std::vector<std::uint8_t> ihdr;
+    put_be32(ihdr, width);
+    put_be32(ihdr, height);
+    ihdr.insert(ihdr.end(), {8, static_cast<std::uint8_t>(color), 0, 0, 0});
+    put_chunk(png, "IHDR", ihdr);
+    // Split the stream over two IDAT chunks like real encoders do
+    std::size_t half = idat.size() / 2;
+    put_chunk(png, "IDAT", std::vector<std::uint8_t>(idat.begin(), idat.begin() + half));
+    put_chunk(png, "IDAT", std::vector<std::uint8_t>(idat.begin() + half, idat.end()));
+    put_chunk(png, "IEND", {});
+    return png;
+}
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool synthetic = argc < 2;
+    std::string directory = synthetic ? "png_bench_images" : argv[1];
+    std::size_t threads = argc > 2 ? std::stoul(argv[2]) : 0;
+
+    try {
+        bool round_trip = true;
+        if (synthetic) {
+            const int count = 10000, side = 28;
+            const int colors[3] = {0, 2, 6}, channel_counts[3] = {1, 3, 4};
+            Random rng(3);
+            std::cout << "Writing " << count << " synthetic PNGs to " << directory << "..." << std::endl;
+            for (int i = 0; i < count; i++) {
+                int kind = i % 3;
+                std::vector<std::uint8_t> pixels(side * side * channel_counts[kind]);
+                for (auto& p : pixels) p = rng.uniform(0.0f, 1.0f) < 0.8f ? 0 : static_cast<std::uint8_t>(rng.uniform(0.0f, 255.99f));
+                std::vector<std::uint8_t> png = encode_png(pixels, side, side, colors[kind], channel_counts[kind]);
+
+                fs::path dir = fs::path(directory) / std::to_string(i % 10);
+                fs::create_directories(dir);
+                std::string name = (dir / (std::to_string(i) + ".png")).string();
+                std::ofstream(name, std::ios::binary).write(reinterpret_cast<const char*>(png.data()), png.size());
+
+                PngImage decoded = decode_png(png.data(), png.size());
+                round_trip = round_trip && decoded.pixels == pixels && decoded.channels == channel_counts[kind];
+            }
+        }
+
+        std::vector<std::string> files;
+        for (const auto& entry : fs::recursive_directory_iterator(directory))
+            if (entry.path().extension() == ".png") files.push_back(entry.path().string());
+
+        std::size_t bytes = 0;
+        double serial_ms = time_ms([&] {
+            for (const auto& f : files) bytes += load_png(f).pixels.size();
+        });
+
+        ThreadPool pool(threads);
+        ImageFolder folder;
+        double parallel_ms = time_ms([&] { folder = load_image_folder(directory, pool); });
+
+        std::cout << "Images: " << files.size() << " (" << folder.cols << "x" << folder.rows << ", "
+                  << bytes / (1024.0 * 1024.0) << " MB decoded)" << std::endl;
+        std::cout << "Serial decode        : " << serial_ms << " ms, " << files.size() * 1e3 / serial_ms
+                  << " images/sec" << std::endl;
+        std::cout << "Folder load (" << pool.size() << " thr) : " << parallel_ms << " ms, "
+                  << folder.count * 1e3 / parallel_ms << " images/sec" << std::endl;
+        if (synthetic) {
+            std::cout << (round_trip ? "All filters round-trip" : "ROUND-TRIP MISMATCH") << std::endl;
+            fs::remove_all(directory);
+        }
+        return round_trip ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
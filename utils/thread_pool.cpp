@@ -0,0 +1,118 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++) {
+        workers.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void ThreadPool::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(std::move(job));
+    }
+    available.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
+
+namespace {
+
+// Shared between the caller of parallel_for and its helper jobs. Helpers may
+// start after the caller has returned; they then find no chunks left and
+// never touch fn.
+struct ParallelForState {
+    const std::function<void(std::size_t, std::size_t)>* fn;
+    std::size_t begin, end, chunk, chunks;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> finished{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+
+    void run_chunks() {
+        while (true) {
+            std::size_t c = next.fetch_add(1);
+            if (c >= chunks) return;
+            std::size_t lo = begin + c * chunk;
+            std::size_t hi = std::min(end, lo + chunk);
+            try {
+                (*fn)(lo, hi);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+            }
+            if (finished.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+void ThreadPool::parallel_for(std::size_t begin, std::size_t end,
+                              const std::function<void(std::size_t, std::size_t)>& fn,
+                              std::size_t grain) {
+    if (end <= begin) return;
+    const std::size_t n = end - begin;
+    grain = std::max<std::size_t>(grain, 1);
+
+    // A few chunks per thread evens out uneven work without tiny chunks
+    std::size_t chunks = std::min((n + grain - 1) / grain, 4 * (size() + 1));
+    if (chunks <= 1 || size() == 0) {
+        fn(begin, end);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->fn = &fn;
+    state->begin = begin;
+    state->end = end;
+    state->chunk = (n + chunks - 1) / chunks;
+    state->chunks = (n + state->chunk - 1) / state->chunk;
+
+    std::size_t helpers = std::min(size(), state->chunks - 1);
+    for (std::size_t i = 0; i < helpers; i++) {
+        enqueue([state]() { state->run_chunks(); });
+    }
+    state->run_chunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() { return state->finished.load() == state->chunks; });
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+ThreadPool& default_thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,58 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one FIFO queue.
+class ThreadPool {
+public:
+    // threads == 0 means one per hardware thread
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    // Runs f() on a worker; the future carries its result or exception
+    template <typename F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using Result = decltype(f());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    // Calls fn(lo, hi) over disjoint ranges covering [begin, end), each at
+    // least `grain` long except the last, and returns when all are done. The
+    // calling thread works on ranges too, so nested calls from inside a worker
+    // cannot deadlock. The first exception thrown by fn is rethrown here.
+    void parallel_for(std::size_t begin, std::size_t end,
+                      const std::function<void(std::size_t, std::size_t)>& fn,
+                      std::size_t grain = 1);
+
+private:
+    void enqueue(std::function<void()> job);
+    void worker_loop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+};
+
+// Process-wide pool sized to the hardware
+ThreadPool& default_thread_pool();
+
+#endif